@@ -0,0 +1,193 @@
+﻿// BufferedRNGClass.h - This header declares the BufferedRNGClass class, and (due to it being a class template) implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- BufferedRNGClass serves numbers from the OS's secure generator (through an RNGClass instance) out of a buffer that is refilled
+	with a single OS call, so small draws (single numbers, UUIDs, tokens, nonces) don't pay for one OS call each. Requests larger
+	than what is left in the buffer are written straight into the caller's buffer instead of being copied.
+
+- The buffer holds secret material, so every number is wiped from it as it is served, and the whole buffer is wiped with
+	SecureZeroMemory on destruction. The numbers served are as unpredictable as those of RNGClass.
+
+- Unlike RNGClass, an instance of BufferedRNGClass is NOT thread-safe, since locking on every number would cost more than the OS
+	calls saved. Give every thread its own instance (e.g. a thread_local one).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for the BufferedRNGClass instance, and result_type as the type specified at identifier
+	declaration. Everything available on an RNGClass instance (rng(), rng(floor, roof), GetRand, CustomRand, FloatingRand, Fill)
+	is available with the same parameters
+
+To create a buffered instance of the random number generation class
+  declare BufferedRNGClass<result_type> identifier(capacity)
+	result_type: An *UNSIGNED* integral type to generate numbers in (e.g. "unsigned int", "unsigned long long")
+	capacity: size_t, the number of numbers generated per OS call. If omitted, it becomes RNGBulkBlockSize (512)
+
+To get the counters of the RNGClass instance the buffer is filled from, with its refills (see RNGMetrics.h)
+ Call rng.GetMetrics()
+   RETURN: RNGMetrics&
+
+To get the latency histograms of the RNGClass instance the buffer is filled from, whose Fill calls are the refills (only if
+	RNG_LATENCY is defined, see RNGLatency.h)
+ Call rng.GetLatency()
+   RETURN: RNGLatency&
+*/
+
+// Include guard
+#ifndef BUFFEREDRNGCLASS_H
+#define BUFFEREDRNGCLASS_H
+
+// If necessary, include the header to allow vectors
+#ifndef _VECTOR_
+#include <vector>
+#endif
+// Include the header declaring RNGClass, which provides the secure numbers
+#include "RNGClass.h"
+
+// typename T; // The type of number to generate. Must be unsigned
+template <typename T>
+class BufferedRNGClass { // NOTE: Like RNGClass, this class is compliant with §29.6.1.3 of the C++17 standard draft
+public:
+	// Ensure that the provided type is numerical and unsigned
+	static_assert(RNGIsUnsigned<T>, "The type provided for BufferedRNGClass must be unsigned");
+
+	// Create result_type as an alias for T (the provided type)
+	typedef T result_type;
+
+	// Define the constructor to create an empty buffer of the provided capacity (filled on first use)
+	explicit BufferedRNGClass(size_t capacity = RNGBulkBlockSize) : buffer(capacity), next(capacity) {
+		assert(("The capacity of the buffer must be positive", capacity > 0));
+	}
+
+	// Define the destructor to wipe the buffer
+	~BufferedRNGClass() { SecureZeroMemory(this->buffer.data(), this->buffer.size() * sizeof(T)); }
+
+	// **** Define non-const methods ****
+
+	// Define the () operator to return a random number of the provided type in the set
+	//		{ number ∈ result_type | min() ≤ number ≤ max() }, as required by §29.6.1.3 of the C++17 standard draft
+	result_type operator()() {
+		result_type number; // The number to return
+
+		if (this->next == this->buffer.size()) { this->Refill(); }
+		number = this->buffer[this->next];
+		this->buffer[this->next++] = 0;
+		return number;
+	}
+	// End BufferedRNGClass<T>::operator() [overload: void] method
+
+	// Define an overload of the () operator to return a random number of in the set
+	//		{ number ∈ result_type | floor ≤ number ≤ roof }
+	result_type operator()(result_type floor, result_type roof) { return this->CustomRand<result_type>(floor, roof); }
+	// End BufferedRNGClass<T>::operator() [overload: result_type, result_type] method
+
+	// Define a method to fill a buffer with random numbers, using up the buffered numbers first
+	void Fill(result_type* numbers, size_t count) {
+		// result_type* numbers;	// The buffer to fill. Passed
+		// size_t count;			// The number of numbers to write to the buffer. Passed
+		size_t available = this->buffer.size() - this->next; // The number of numbers left in the buffer
+		size_t taken = (count < available) ? count : available; // The number of numbers taken from the buffer
+
+		std::memcpy(numbers, this->buffer.data() + this->next, taken * sizeof(T));
+		SecureZeroMemory(this->buffer.data() + this->next, taken * sizeof(T));
+		this->next += taken;
+		numbers += taken;
+		count -= taken;
+
+		// The buffer is now empty (or the request is complete). Generate anything at least as large as the buffer in place, and
+		//		serve the rest from a refilled buffer
+		if (count >= this->buffer.size()) { this->source.Fill(numbers, count); }
+		else if (count > 0) {
+			this->Refill();
+			std::memcpy(numbers, this->buffer.data(), count * sizeof(T));
+			SecureZeroMemory(this->buffer.data(), count * sizeof(T));
+			this->next = count;
+		} // End else if(count > 0)
+	}
+	// End BufferedRNGClass<T>::Fill method
+
+	// Define a method to return a random number (since pointers can't access the "()" operator in an easily readable way)
+	result_type GetRand() { return this->operator()(); }
+
+	// Define an overload of GetRand to return a random number of the specified type in the specified range
+	result_type GetRand(result_type floor, result_type roof) { return this->operator()(floor, roof); }
+
+	// Define a templated method to generate a random number of the specified type over the specified range
+	//		{ number ∈ cast_type | floor ≤ number ≤ roof }
+	template<typename cast_type> cast_type CustomRand(cast_type floor = RNGLowest<cast_type>(), cast_type roof = RNGHighest<cast_type>()) {
+		// cast_type floor; // The minimum number that can be returned. Passed. Minimum of the type if omitted
+		// cast_type roof;	// The maximum number that can be returned. Passed. Maximum of the type if omitted
+
+		// Ensure that the provided type is numerical, but not necessarily and unsigned
+		static_assert(RNGIsIntegral<cast_type>, "The type provided for BufferedRNGClass::CustomRand must be integral");
+
+		// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
+		assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
+
+		// Use a temporary integer distributer, unless the type is too wide for the std distributions
+		if constexpr (RNGIsWide<cast_type>) { return this->WideRand(floor, roof); }
+		else { return std::uniform_int_distribution<cast_type>(floor, roof)(*this); }
+	}
+	// End BufferedRNGClass<T>::CustomRand<cast_type> method
+
+	// Define a templated method to generate a random floating-point number of the specified type over the specified range
+	template<typename floating_type> floating_type FloatingRand(floating_type floor = 0, floating_type roof = 1) {
+		// floating_type floor;		// The minimum number that can be returned. Passed. 0 if omitted
+		// floating_type roof;		// The maximum number that can be returned. Passed. 1 if omitted
+
+		// Ensure that the provided type is floating-point
+		static_assert(std::is_floating_point_v<floating_type>, "The type provided for BufferedRNGClass::FloatingRand must be floating-point");
+
+		// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
+		assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
+
+		return std::uniform_real_distribution<floating_type>(floor, roof)(*this);
+	}
+	// End BufferedRNGClass<T>::FloatingRand<floating_type> method
+
+	// Define a method to return the counters of the RNGClass instance the buffer is filled from
+	RNGMetrics& GetMetrics() { return this->source.GetMetrics(); }
+
+#ifdef RNG_LATENCY
+	// Define a method to return the latency histograms of the RNGClass instance the buffer is filled from
+	RNGLatency& GetLatency() { return this->source.GetLatency(); }
+#endif
+
+	// **** Define const methods ****
+
+	// Define a method to return the number of numbers generated per OS call
+	size_t GetCapacity() const { return this->buffer.size(); }
+
+	// Define the method "max" to return the maximum number the provided type can contain. NOTE: Name is wrapped in "()" to
+	//		avoid the compiler trying to replace "max" with the macro defined in Windows.h
+	static constexpr T(max)() { return RNGHighest<T>(); }
+
+	// Define the method "min" to return the minimum number the provided type can contain (0 because the types must be unsigned)
+	static constexpr T(min)() { return 0; }
+
+protected:
+	// Define a method to refill the buffer with a single OS call
+	void Refill() {
+		this->source.Fill(this->buffer.data(), this->buffer.size());
+		this->source.GetMetrics().Add(RNG_METRIC_REFILLS);
+		this->next = 0;
+	}
+	// End BufferedRNGClass<T>::Refill method
+
+#ifdef RNG_HAS_INT128
+	// Define a templated method to generate a 128-bit number in the set { number ∈ cast_type | floor ≤ number ≤ roof }
+	template<typename cast_type> cast_type WideRand(cast_type floor, cast_type roof) {
+		// cast_type floor;		// The minimum number that can be returned. Passed
+		// cast_type roof;		// The maximum number that can be returned. Passed
+		static_assert(sizeof(T) == 8 || sizeof(T) == 16, "128-bit ranges need a BufferedRNGClass with a 64-bit or 128-bit result_type");
+
+		// NOTE: If the range covers the whole type, its size overflows to 0, which RNGBoundedRand128 treats as the full range
+		return (cast_type)((RNGUInt128)floor + RNGBoundedRand128(*this, (RNGUInt128)roof - (RNGUInt128)floor + 1));
+	}
+	// End BufferedRNGClass<T>::WideRand<cast_type> method
+#endif
+
+	RNGClass<T> source;			// The secure generator the buffer is filled from
+	std::vector<T> buffer;		// The numbers generated by the last OS call
+	size_t next;				// The position of the next number to serve from the buffer
+}; // End class BufferedRNGClass
+#endif
@@ -0,0 +1,276 @@
+﻿// EntropyPool.h - This header declares the EntropyPool class, and implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- An EntropyPool combines several independent entropy sources into the seeds of user-space engines (SeededRNGClass, SeedDeriver,
+	MersenneTwisterClass, std engines), so a seed stays unpredictable as long as any one source is sound: the OS generator
+	(through RNGClass), the CPU's entropy source (RDSEED, where the CPU has it) and CPU timing jitter (the varying duration of a
+	short loop, read with the time stamp counter).
+
+- Every source is absorbed into a 256-bit pool key, 12 bytes per ChaCha20 block, each block replacing the key with the first half
+	of ChaCha20(key, chunk), the same construction SeedDeriver uses for labels. The counter of every block holds the source and
+	the position of the chunk, so different inputs never collide. Seeds are ChaCha20 in counter mode under a copy of the key.
+
+- The sources are collected by a background thread every refresh interval, so neither seeding nor any draw ever waits for them.
+	The constructor collects one round itself so that the first seed already has every source. Seed only copies the key under a
+	lock (a few nanoseconds) and expands it outside of the lock.
+
+- Jitter is absorbed as raw timings without any entropy estimate, so it only ever adds to the other sources. RDSEED words are
+	checked like those of HardwareRNGClass, and dropped if they fail.
+
+- An instance is thread-safe.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "pool" as the identifier for the EntropyPool instance
+
+To create an entropy pool, collecting its sources in the background
+  declare EntropyPool identifier(interval)
+	interval: std::chrono::milliseconds, the time between two collections. If omitted, it becomes 1 second
+
+To fill a buffer with seed material
+ Call pool.Seed(words, count)
+	 words: unsigned long long*, the buffer to fill
+	 count: size_t, the number of words to write
+   RETURN: void
+
+To get a single 64-bit seed
+ Call pool.Seed()
+   RETURN: unsigned long long
+
+To get a seeded generator
+ Call pool.Stream()
+   RETURN: SeededRNGClass<unsigned long long>, seeded with one word of seed material and using another as its stream
+
+To get a seed deriver with a master key from the pool
+ Call pool.Deriver()
+   RETURN: SeedDeriver
+
+To collect the sources immediately (e.g. after a fork or a resume from hibernation)
+ Call pool.Collect()
+   RETURN: void
+
+To get the number of collections done so far
+ Call pool.GetCollectionCount()
+   RETURN: unsigned long long
+
+To get the counters of the pool's OS generator, with its collections counted as reseeds (see RNGMetrics.h)
+ Call pool.GetMetrics()
+   RETURN: RNGMetrics&
+*/
+
+// Include guard
+#ifndef ENTROPYPOOL_H
+#define ENTROPYPOOL_H
+
+// If necessary, include the header to allow the use of threads
+#ifndef _THREAD_
+#include <thread>
+#endif
+// Include the header declaring HardwareRNGClass, which defines the RDSEED helpers (and the ChaCha20 block function)
+#include "HardwareRNGClass.h"
+
+// Define the sources of an EntropyPool, which are part of the counter of every block absorbing them (at most 63)
+enum RNGEntropySource { RNG_SOURCE_OS = 1, RNG_SOURCE_RDSEED = 2, RNG_SOURCE_JITTER = 3 };
+
+// Define the number of 32-bit words collected from every source per collection, and the number of timings per word of jitter
+inline constexpr size_t RNGPoolSourceWords = 16;
+inline constexpr size_t RNGPoolJitterSamples = 4;
+
+class EntropyPool {
+public:
+	// Define the constructor to collect every source once, then start the background collection
+	explicit EntropyPool(std::chrono::milliseconds interval = std::chrono::milliseconds(1000)) : interval(interval), key{}, outputs(0), collections(0), stopping(false) {
+		this->Collect();
+		this->collector = std::thread([this]() { this->Run(); });
+	}
+
+	// Define the destructor to stop the background collection and wipe the key
+	~EntropyPool() {
+		{
+			std::lock_guard<std::mutex> lock(this->key_muter); // The lock of the key (and of the stop flag)
+			this->stopping = true;
+		}
+		this->wake.notify_all();
+		this->collector.join();
+		SecureZeroMemory(this->key, sizeof(this->key));
+	}
+
+	// Disallow copies, since the background thread refers to the instance
+	EntropyPool(const EntropyPool&) = delete;
+	EntropyPool& operator=(const EntropyPool&) = delete;
+
+	// **** Define non-const methods ****
+
+	// Define a method to collect every source and absorb them into the pool key. NOTE: Sources are collected without the lock, so
+	//		seeding never waits for them
+	void Collect() {
+		unsigned int os[RNGPoolSourceWords];		// The words of the OS generator
+		unsigned int hardware[RNGPoolSourceWords];	// The words of RDSEED, split in halves
+		unsigned int jitter[RNGPoolSourceWords];	// The timings of the jitter loop
+		size_t hardware_count = 0;					// The number of RDSEED words to absorb
+
+		// Collect the sources
+		this->os_source.Fill(os, RNGPoolSourceWords);
+		if (EntropyPool::HasRDSEED()) {
+			unsigned long long words[RNGPoolSourceWords / 2]; // The words read from RDSEED
+			if (RNGReadRDSEED(words, RNGPoolSourceWords / 2) == RNGPoolSourceWords / 2 && RNGHardwareHealthy(words, RNGPoolSourceWords / 2)) {
+				std::memcpy(hardware, words, sizeof(words));
+				hardware_count = RNGPoolSourceWords;
+			} // End if(RNGReadRDSEED(words, RNGPoolSourceWords / 2) == RNGPoolSourceWords / 2 && RNGHardwareHealthy(words, RNGPoolSourceWords / 2))
+			SecureZeroMemory(words, sizeof(words));
+		} // End if(EntropyPool::HasRDSEED())
+		EntropyPool::CollectJitter(jitter, RNGPoolSourceWords);
+
+		// Absorb them into the key
+		{
+			std::lock_guard<std::mutex> lock(this->key_muter); // The lock of the key
+			EntropyPool::Absorb(this->key, RNG_SOURCE_OS, os, RNGPoolSourceWords);
+			if (hardware_count > 0) { EntropyPool::Absorb(this->key, RNG_SOURCE_RDSEED, hardware, hardware_count); }
+			EntropyPool::Absorb(this->key, RNG_SOURCE_JITTER, jitter, RNGPoolSourceWords);
+			this->collections++;
+		}
+		this->os_source.GetMetrics().Add(RNG_METRIC_RESEEDS);
+
+		SecureZeroMemory(os, sizeof(os));
+		SecureZeroMemory(hardware, sizeof(hardware));
+	}
+	// End EntropyPool::Collect method
+
+	// Define a method to fill a buffer with seed material
+	void Seed(unsigned long long* words, size_t count) {
+		// unsigned long long* words;	// The buffer to fill. Passed
+		// size_t count;				// The number of words to write. Passed
+		unsigned int key[8];			// The copy of the pool key
+		unsigned int block[16];			// The current block of material
+		unsigned long long output;		// The index of this output, which makes it unique under the key
+		unsigned int counter = 0;		// The index of the current block
+
+		// Copy the key and reserve an output index, which is all that is done under the lock
+		{
+			std::lock_guard<std::mutex> lock(this->key_muter); // The lock of the key
+			for (int i = 0; i < 8; i++) { key[i] = this->key[i]; }
+			output = this->outputs++;
+		}
+
+		// Combine the 32-bit words of the blocks into 64-bit words, least significant first
+		const unsigned int nonce[3] = { (unsigned int)output, (unsigned int)(output >> 32), 0 }; // The nonce of this output
+		while (count > 0) {
+			RNGChaCha20Block(key, RNGSeedOutputBlock | counter++, nonce, block);
+			for (int i = 0; i < 8 && count > 0; i++, count--) { *words++ = (unsigned long long)block[2 * i] | ((unsigned long long)block[2 * i + 1] << 32); }
+		} // End while(count > 0)
+
+		SecureZeroMemory(key, sizeof(key));
+		SecureZeroMemory(block, sizeof(block));
+	}
+	// End EntropyPool::Seed [overload: unsigned long long*, size_t] method
+
+	// Define an overload of Seed to return a single 64-bit seed
+	unsigned long long Seed() {
+		unsigned long long seed; // The seed to return
+		this->Seed(&seed, 1);
+		return seed;
+	}
+	// End EntropyPool::Seed [overload: void] method
+
+	// Define a method to return a seeded generator
+	SeededRNGClass<unsigned long long> Stream() {
+		unsigned long long words[2]; // The seed and stream of the generator
+		this->Seed(words, 2);
+		return SeededRNGClass<unsigned long long>(words[0], words[1]);
+	}
+	// End EntropyPool::Stream method
+
+	// Define a method to return a seed deriver with a master key from the pool
+	SeedDeriver Deriver() {
+		unsigned long long key[4]; // The master key of the deriver
+		this->Seed(key, 4);
+		SeedDeriver deriver(key); // The deriver to return
+		SecureZeroMemory(key, sizeof(key));
+		return deriver;
+	}
+	// End EntropyPool::Deriver method
+
+	// Define a method to return the counters of the OS generator of the pool, which count its collections as reseeds
+	RNGMetrics& GetMetrics() { return this->os_source.GetMetrics(); }
+
+	// **** Define const methods ****
+
+	// Define a method to return the number of collections done so far
+	unsigned long long GetCollectionCount() const { return this->collections.load(std::memory_order_relaxed); }
+
+protected:
+	// Define the method run by the background thread, collecting the sources every interval until the pool is destroyed
+	void Run() {
+		std::unique_lock<std::mutex> lock(this->key_muter); // The lock of the stop flag
+
+		while (!this->wake.wait_for(lock, this->interval, [this]() { return this->stopping; })) {
+			lock.unlock();
+			this->Collect();
+			lock.lock();
+		} // End while(!this->wake.wait_for(lock, this->interval, [this]() { return this->stopping; }))
+	}
+	// End EntropyPool::Run method
+
+	// Define a static method to absorb the words of a source into a key, 12 bytes per ChaCha20 block. NOTE: The counter holds the
+	//		source (bits 24 to 29), whether the chunk is the last one (bit 31) and its index or, for the last one, the length of the
+	//		input, so it never matches the counters of seed material (bits 30 and 31 set)
+	static void Absorb(unsigned int* key, RNGEntropySource source, const unsigned int* data, size_t count) {
+		// unsigned int* key;			// The key to update. Passed
+		// RNGEntropySource source;		// The source of the words. Passed
+		// const unsigned int* data;	// The words to absorb. Passed
+		// size_t count;				// The number of words. Passed
+		unsigned int block[16];			// The output of the current ChaCha20 block
+
+		// Ensure that the counter can hold the length of the input
+		assert(("Too many words to absorb at once", count < (1u << 24)));
+
+		for (size_t chunk = 0; chunk == 0 || chunk * 3 < count; chunk++) {
+			unsigned int nonce[3] = { 0, 0, 0 }; // The current chunk, zero-padded
+			bool last = (chunk + 1) * 3 >= count; // Whether or not this is the last chunk
+			for (size_t w = chunk * 3; w < count && w < chunk * 3 + 3; w++) { nonce[w % 3] = data[w]; }
+			RNGChaCha20Block(key, ((unsigned int)source << 24) | (last ? (RNGSeedFinalChunk | (unsigned int)count) : (unsigned int)chunk), nonce, block);
+			for (int i = 0; i < 8; i++) { key[i] = block[i]; }
+		} // End for(chunk)
+		SecureZeroMemory(block, sizeof(block));
+	}
+	// End EntropyPool::Absorb method
+
+	// Define a static method to collect timings of a short loop, whose duration varies with caches, branch predictors, interrupts
+	//		and frequency changes. NOTE: The length of the loop depends on the previous timing, which makes the timings less regular
+	static void CollectJitter(unsigned int* words, size_t count) {
+		// unsigned int* words;		// The buffer to fill, 4 timings (their lower 8 bits) per word. Passed
+		// size_t count;			// The number of words to write. Passed
+		volatile unsigned int sink = 0;	// The result of the loop, kept so that the loop isn't optimized out
+		unsigned long long start;		// The timestamp at the start of the current timing
+		unsigned long long timing = 0;	// The current timing
+
+		for (size_t i = 0; i < count; i++) {
+			words[i] = 0;
+			for (size_t s = 0; s < RNGPoolJitterSamples; s++) {
+				start = RNGReadTimestamp();
+				for (unsigned int k = 0; k < 64 + (timing & 63); k++) { sink = sink * 31 + k; }
+				timing = RNGReadTimestamp() - start;
+				words[i] = (words[i] << 8) | (unsigned int)(timing & 0xFF);
+			} // End for(s)
+		} // End for(i)
+	}
+	// End EntropyPool::CollectJitter method
+
+	// Define a static method to check once whether or not the CPU has RDSEED
+	static bool HasRDSEED() {
+		static const bool present = RNGHasRDSEED(); // Whether or not the CPU has RDSEED
+		return present;
+	}
+	// End EntropyPool::HasRDSEED method
+
+	std::chrono::milliseconds interval;				// The time between two collections
+	unsigned int key[8];							// The pool key
+	unsigned long long outputs;						// The number of seeds generated
+	std::atomic<unsigned long long> collections;	// The number of collections done
+	bool stopping;									// Whether or not the pool is being destroyed
+	RNGClass<unsigned int> os_source;				// The OS generator
+	std::mutex key_muter;							// The mutex guarding the key, the output counter and the stop flag
+	std::condition_variable wake;					// The condition used to wake the background thread when the pool is destroyed
+	std::thread collector;							// The background thread collecting the sources
+}; // End class EntropyPool
+#endif
@@ -0,0 +1,372 @@
+﻿// HardwareRNGClass.h - This header declares the HardwareRNGClass class, and (due to it being a class template) implements it, as
+//		well as defining the functions reading the RDRAND and RDSEED instructions
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- HardwareRNGClass is a drop-in alternative to RNGClass that draws from the CPU's generator (RDRAND, 64 bits per instruction)
+	instead of making an OS call per draw. Support is detected at run time with CPUID, and if the CPU has no RDRAND (or it fails
+	its health checks), every number comes from the OS generator instead.
+
+- Whether it is faster than RNGClass depends on the CPU: RDRAND takes anywhere from about a hundred to several thousand cycles per
+	word (some microcode mitigations slow it down a lot, and so do hypervisors), while a draw of RNGClass costs an OS call. Every
+	block also costs one ChaCha20 block per 8 words. Measure both on the target hardware before switching, e.g. with
+	benchmarks/HardwareBenchmark.cpp.
+
+- Single draws (rng(), and the std distributions behind CustomRand and FloatingRand) are served from a buffer of
+	RNGHardwareBufferWords mixed words, refilled a block at a time like BufferedRNGClass, so the keystream, the atomic reservation
+	and the health tests are paid once per refill instead of once per draw. The buffer is guarded by a mutex to keep the instance
+	thread-safe, and every number is wiped from it as it is served.
+
+- The hardware output is never used on its own: it is XORed with a ChaCha20 keystream whose key is drawn from the OS generator
+	when the instance is created, so the numbers stay unpredictable if either source is sound. The keystream position is taken
+	with a single atomic increment, so like RNGClass an instance is thread-safe.
+
+- RDRAND can fail when the CPU's generator is drained, which it reports with the carry flag: every word is retried up to
+	RNGRDRANDRetries times, as Intel recommends, and whatever couldn't be read is taken from the OS generator (counted by
+	GetFallbackCount). Some CPUs have been shipped (or broken by firmware) with generators that report success while returning a
+	constant such as all zeros or all ones, so every block is also checked for stuck and repeated words and goes through the
+	continuous health tests of SP 800-90B (see HealthMonitor.h), and a failing block is replaced by OS output. A health check at
+	startup disables the hardware path altogether on such CPUs.
+
+- RDSEED draws from the CPU's entropy source directly (unlike RDRAND, which is a DRBG reseeded from it), so it is the right source
+	for seeding user-space engines, but it is slow and fails often under load. FillSeed retries it (pausing in between), checks
+	its output the same way, falls back on the OS generator, and XORs the result with OS output.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for the HardwareRNGClass instance, and result_type as the type specified at identifier
+	declaration. Everything available on an RNGClass instance (rng(), rng(floor, roof), GetRand, CustomRand, FloatingRand, Fill)
+	is available with the same parameters
+
+To create a hardware-backed instance of the random number generation class
+  declare HardwareRNGClass<result_type> identifier
+	result_type: An *UNSIGNED* integral type to generate numbers in (e.g. "unsigned int", "unsigned long long")
+
+To fill a buffer with seed material for user-space engines (e.g. SeededRNGClass, MersenneTwisterClass)
+ Call rng.FillSeed(words, count)
+	 words: unsigned long long*, the buffer to fill
+	 count: size_t, the number of words to write
+   RETURN: void
+
+To check whether or not the CPU's generator is used
+ Call rng.IsHardware()
+   RETURN: bool
+
+To get the number of blocks taken from the OS generator because the CPU's generator failed
+ Call rng.GetFallbackCount()
+   RETURN: unsigned long long
+
+To get the health monitor testing the blocks read from RDRAND (status, counters, reset)
+ Call rng.GetHealth()
+   RETURN: HealthMonitor&
+
+To check whether or not the CPU has RDRAND or RDSEED
+ call RNGHasRDRAND() or RNGHasRDSEED()
+   RETURN: bool
+*/
+
+// Include guard
+#ifndef HARDWARERNGCLASS_H
+#define HARDWARERNGCLASS_H
+
+// If necessary, include the header to allow atomic operations
+#ifndef _ATOMIC_
+#include <atomic>
+#endif
+// Include the header defining the ChaCha20 block function (and declaring RNGClass, which provides keys and fallback numbers)
+#include "SeedDeriver.h"
+
+// Define the number of attempts per word of RDRAND (Intel's recommendation) and RDSEED before falling back on the OS generator
+inline constexpr int RNGRDRANDRetries = 10;
+inline constexpr int RNGRDSEEDRetries = 1000;
+
+// Define the number of mixed words buffered for single draws (1KB, which is 16 blocks of the keystream and two health windows)
+inline constexpr size_t RNGHardwareBufferWords = 128;
+
+// Define a function to return whether or not the CPU has RDRAND
+inline bool RNGHasRDRAND() {
+#ifdef RNG_HAS_DISPATCH
+	unsigned int registers[4]; // EAX, EBX, ECX and EDX of CPUID leaf 1
+	RNGCPUID(1, 0, registers);
+	return (registers[2] & (1u << 30)) != 0;
+#else
+	return false;
+#endif
+}
+// End RNGHasRDRAND function
+
+// Define a function to return whether or not the CPU has RDSEED
+inline bool RNGHasRDSEED() {
+#ifdef RNG_HAS_DISPATCH
+	unsigned int registers[4]; // EAX, EBX, ECX and EDX of CPUID leaf 7
+	RNGCPUID(7, 0, registers);
+	return (registers[1] & (1u << 18)) != 0;
+#else
+	return false;
+#endif
+}
+// End RNGHasRDSEED function
+
+#ifdef RNG_HAS_DISPATCH
+// Define a function to read words from RDRAND, returning how many were read before the retries ran out. NOTE: Must only be called
+//		if RNGHasRDRAND returns true
+RNG_TARGET("rdrnd") inline size_t RNGReadRDRAND(unsigned long long* words, size_t count) {
+	// unsigned long long* words;	// The buffer to fill. Passed
+	// size_t count;				// The number of words to read. Passed
+	for (size_t i = 0; i < count; i++) {
+		int retries = RNGRDRANDRetries; // The attempts left for the current word
+		while (!_rdrand64_step(&words[i])) { if (--retries == 0) { return i; } }
+	} // End for(i)
+	return count;
+}
+// End RNGReadRDRAND function
+
+// Define a function to read words from RDSEED, returning how many were read before the retries ran out. NOTE: Must only be called
+//		if RNGHasRDSEED returns true
+RNG_TARGET("rdseed") inline size_t RNGReadRDSEED(unsigned long long* words, size_t count) {
+	// unsigned long long* words;	// The buffer to fill. Passed
+	// size_t count;				// The number of words to read. Passed
+	for (size_t i = 0; i < count; i++) {
+		int retries = RNGRDSEEDRetries; // The attempts left for the current word
+		while (!_rdseed64_step(&words[i])) {
+			if (--retries == 0) { return i; }
+			_mm_pause(); // NOTE: Gives the entropy source time to refill, as Intel recommends
+		} // End while(!_rdseed64_step(&words[i]))
+	} // End for(i)
+	return count;
+}
+// End RNGReadRDSEED function
+#else
+// Define stand-ins for other architectures, which have neither instruction
+inline size_t RNGReadRDRAND(unsigned long long*, size_t) { return 0; }
+inline size_t RNGReadRDSEED(unsigned long long*, size_t) { return 0; }
+#endif
+
+// Define a function to check words read from the CPU's generator, returning false if any is stuck at all zeros or all ones, or
+//		repeats the previous one (which a sound generator does with negligible probability)
+inline bool RNGHardwareHealthy(const unsigned long long* words, size_t count) {
+	// const unsigned long long* words;	// The words to check. Passed
+	// size_t count;					// The number of words. Passed
+	bool failed = false;				// Whether or not any word failed
+
+	for (size_t i = 0; i < count; i++) { failed |= (words[i] == 0) | (words[i] == ~0ULL) | (i > 0 && words[i] == words[i - 1]); }
+	return !failed;
+}
+// End RNGHardwareHealthy function
+
+// typename T; // The type of number to generate. Must be unsigned
+template <typename T>
+class HardwareRNGClass { // NOTE: Like RNGClass, this class is compliant with §29.6.1.3 of the C++17 standard draft
+public:
+	// Ensure that the provided type is numerical and unsigned
+	static_assert(RNGIsUnsigned<T>, "The type provided for HardwareRNGClass must be unsigned");
+
+	// Create result_type as an alias for T (the provided type)
+	typedef T result_type;
+
+	// Define the default constructor to draw the key of the keystream from the OS generator
+	HardwareRNGClass() : hardware(HardwareRNGClass::Usable()), next_block(0), fallbacks(0), next(sizeof(buffer)) {
+		static RNGClass<unsigned int> seeder; // Random number generator used to draw keys across lifetime of the program
+		seeder.Fill(this->key, 8);
+	}
+
+	// Define the destructor to wipe the key and the buffered words
+	~HardwareRNGClass() {
+		SecureZeroMemory(this->key, sizeof(this->key));
+		SecureZeroMemory(this->buffer, sizeof(this->buffer));
+	}
+
+	// **** Define non-const methods ****
+
+	// Define the () operator to return a random number of the provided type in the set
+	//		{ number ∈ result_type | min() ≤ number ≤ max() }, as required by §29.6.1.3 of the C++17 standard draft
+	result_type operator()() {
+		result_type number;											// The number to return
+		std::lock_guard<std::mutex> lock(this->buffer_muter);		// The lock of the buffer
+		unsigned char* bytes = (unsigned char*)this->buffer;		// The bytes of the buffer
+
+		if (this->next == sizeof(this->buffer)) {
+			this->Generate(this->buffer, RNGHardwareBufferWords);
+			this->next = 0;
+		} // End if(this->next == sizeof(this->buffer))
+		std::memcpy(&number, bytes + this->next, sizeof(number));
+		SecureZeroMemory(bytes + this->next, sizeof(number));
+		this->next += sizeof(number);
+		return number;
+	}
+	// End HardwareRNGClass<T>::operator() [overload: void] method
+
+	// Define an overload of the () operator to return a random number of in the set
+	//		{ number ∈ result_type | floor ≤ number ≤ roof }
+	result_type operator()(result_type floor, result_type roof) { return this->CustomRand<result_type>(floor, roof); }
+	// End HardwareRNGClass<T>::operator() [overload: result_type, result_type] method
+
+	// Define a method to fill a buffer with random numbers of the provided type
+	void Fill(result_type* numbers, size_t count) {
+		// result_type* numbers;	// The buffer to fill. Passed
+		// size_t count;			// The number of numbers to write to the buffer. Passed
+		unsigned long long words[RNGBulkBlockSize];			// The mixed words of the current block
+		unsigned char* bytes = (unsigned char*)numbers;		// The part of the buffer left to fill
+		size_t remaining = count * sizeof(result_type);		// The number of bytes left to fill
+		size_t used = (remaining < sizeof(words)) ? (remaining + 7) / 8 : RNGBulkBlockSize; // The number of words to wipe
+		size_t block;										// The number of bytes of the current block
+
+		while (remaining > 0) {
+			block = (remaining < sizeof(words)) ? remaining : sizeof(words);
+			this->Generate(words, (block + 7) / 8);
+			std::memcpy(bytes, words, block);
+			bytes += block;
+			remaining -= block;
+		} // End while(remaining > 0)
+		SecureZeroMemory(words, used * sizeof(unsigned long long));
+	}
+	// End HardwareRNGClass<T>::Fill method
+
+	// Define a method to fill a buffer with seed material from RDSEED, mixed with the OS generator
+	void FillSeed(unsigned long long* words, size_t count) {
+		// unsigned long long* words;	// The buffer to fill. Passed
+		// size_t count;				// The number of words to write. Passed
+		static const bool seeding = RNGHasRDSEED();	// Whether or not the CPU has RDSEED
+		unsigned long long mix[RNGBulkBlockSize];	// The OS words of the current block
+		size_t block;								// The number of words of the current block
+		size_t filled;								// The number of words read from RDSEED
+
+		while (count > 0) {
+			block = (count < RNGBulkBlockSize) ? count : RNGBulkBlockSize;
+			filled = seeding ? RNGReadRDSEED(words, block) : 0;
+			if (!RNGHardwareHealthy(words, filled)) { filled = 0; }
+			if (filled < block) {
+				std::memset(words, 0, block * sizeof(unsigned long long));
+				this->fallbacks.fetch_add(1, std::memory_order_relaxed);
+			} // End if(filled < block)
+
+			this->fallback.Fill(mix, block);
+			for (size_t i = 0; i < block; i++) { words[i] ^= mix[i]; }
+			words += block;
+			count -= block;
+		} // End while(count > 0)
+		SecureZeroMemory(mix, sizeof(mix));
+	}
+	// End HardwareRNGClass<T>::FillSeed method
+
+	// Define a method to return a random number (since pointers can't access the "()" operator in an easily readable way)
+	result_type GetRand() { return this->operator()(); }
+
+	// Define an overload of GetRand to return a random number of the specified type in the specified range
+	result_type GetRand(result_type floor, result_type roof) { return this->operator()(floor, roof); }
+
+	// Define a templated method to generate a random number of the specified type over the specified range
+	//		{ number ∈ cast_type | floor ≤ number ≤ roof }
+	template<typename cast_type> cast_type CustomRand(cast_type floor = RNGLowest<cast_type>(), cast_type roof = RNGHighest<cast_type>()) {
+		// cast_type floor; // The minimum number that can be returned. Passed. Minimum of the type if omitted
+		// cast_type roof;	// The maximum number that can be returned. Passed. Maximum of the type if omitted
+
+		// Ensure that the provided type is numerical, but not necessarily and unsigned
+		static_assert(RNGIsIntegral<cast_type>, "The type provided for HardwareRNGClass::CustomRand must be integral");
+
+		// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
+		assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
+
+		// Use a temporary integer distributer, unless the type is too wide for the std distributions
+		if constexpr (RNGIsWide<cast_type>) { return this->WideRand(floor, roof); }
+		else { return std::uniform_int_distribution<cast_type>(floor, roof)(*this); }
+	}
+	// End HardwareRNGClass<T>::CustomRand<cast_type> method
+
+	// Define a templated method to generate a random floating-point number of the specified type over the specified range
+	template<typename floating_type> floating_type FloatingRand(floating_type floor = 0, floating_type roof = 1) {
+		// floating_type floor;		// The minimum number that can be returned. Passed. 0 if omitted
+		// floating_type roof;		// The maximum number that can be returned. Passed. 1 if omitted
+
+		// Ensure that the provided type is floating-point
+		static_assert(std::is_floating_point_v<floating_type>, "The type provided for HardwareRNGClass::FloatingRand must be floating-point");
+
+		// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
+		assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
+
+		return std::uniform_real_distribution<floating_type>(floor, roof)(*this);
+	}
+	// End HardwareRNGClass<T>::FloatingRand<floating_type> method
+
+	// Define a method to return the health monitor testing the blocks read from RDRAND
+	HealthMonitor& GetHealth() { return this->health; }
+
+	// **** Define const methods ****
+
+	// Define a method to return whether or not the CPU's generator is used
+	bool IsHardware() const { return this->hardware; }
+
+	// Define a method to return the number of blocks taken from the OS generator because the CPU's generator failed
+	unsigned long long GetFallbackCount() const { return this->fallbacks.load(std::memory_order_relaxed); }
+
+	// Define the method "max" to return the maximum number the provided type can contain. NOTE: Name is wrapped in "()" to
+	//		avoid the compiler trying to replace "max" with the macro defined in Windows.h
+	static constexpr T(max)() { return RNGHighest<T>(); }
+
+	// Define the method "min" to return the minimum number the provided type can contain (0 because the types must be unsigned)
+	static constexpr T(min)() { return 0; }
+
+protected:
+	// Define a method to generate a block of words: RDRAND (or the OS generator where it failed) XORed with the keystream
+	void Generate(unsigned long long* words, size_t count) {
+		// unsigned long long* words;	// The buffer to fill. Passed
+		// size_t count;				// The number of words to write (at most RNGBulkBlockSize). Passed
+		unsigned int stream[16];		// The current block of the keystream
+		unsigned long long first;		// The index of the first block of the keystream used
+		size_t filled;					// The number of words read from RDRAND
+		bool tested = count * sizeof(unsigned long long) >= RNGHealthWindow; // Whether or not the block is long enough for the health tests
+
+		// Read the hardware words, replacing the whole block with OS output if any word couldn't be read, looks broken or fails the
+		//		health tests. NOTE: Blocks shorter than a window (small Fill calls) are too small for the health tests, so they only
+		//		get the check for stuck and repeated words
+		filled = this->hardware ? RNGReadRDRAND(words, count) : 0;
+		if (filled < count || !RNGHardwareHealthy(words, count) || (tested && this->health.Test(words, count * sizeof(unsigned long long)) != RNG_HEALTH_OK)) {
+			this->fallback.Fill(words, count);
+			if (this->hardware) { this->fallbacks.fetch_add(1, std::memory_order_relaxed); }
+		} // End if(filled < count || !RNGHardwareHealthy(words, count) || (tested && this->health.Test(words, count * sizeof(unsigned long long)) != RNG_HEALTH_OK))
+
+		// Mix in the keystream, reserving its blocks with a single atomic increment. NOTE: The upper half of the block index is
+		//		passed as the nonce, so the keystream never repeats
+		first = this->next_block.fetch_add((count + 7) / 8, std::memory_order_relaxed);
+		for (size_t b = 0; b * 8 < count; b++) {
+			unsigned int nonce[3] = { (unsigned int)((first + b) >> 32), 0, 0 }; // The upper half of the block index
+			RNGChaCha20Block(this->key, (unsigned int)(first + b), nonce, stream);
+			for (size_t i = 0; i < 8 && b * 8 + i < count; i++) { words[b * 8 + i] ^= (unsigned long long)stream[2 * i] | ((unsigned long long)stream[2 * i + 1] << 32); }
+		} // End for(b)
+		SecureZeroMemory(stream, sizeof(stream));
+	}
+	// End HardwareRNGClass<T>::Generate method
+
+	// Define a static method to check once whether or not RDRAND is present and passes the startup health check
+	static bool Usable() {
+		static const bool usable = []() -> bool {
+			unsigned long long words[16]; // The words of the health check
+			return RNGHasRDRAND() && RNGReadRDRAND(words, 16) == 16 && RNGHardwareHealthy(words, 16);
+		}();
+		return usable;
+	}
+	// End HardwareRNGClass<T>::Usable method
+
+#ifdef RNG_HAS_INT128
+	// Define a templated method to generate a 128-bit number in the set { number ∈ cast_type | floor ≤ number ≤ roof }
+	template<typename cast_type> cast_type WideRand(cast_type floor, cast_type roof) {
+		// cast_type floor;		// The minimum number that can be returned. Passed
+		// cast_type roof;		// The maximum number that can be returned. Passed
+		static_assert(sizeof(T) == 8 || sizeof(T) == 16, "128-bit ranges need a HardwareRNGClass with a 64-bit or 128-bit result_type");
+
+		// NOTE: If the range covers the whole type, its size overflows to 0, which RNGBoundedRand128 treats as the full range
+		return (cast_type)((RNGUInt128)floor + RNGBoundedRand128(*this, (RNGUInt128)roof - (RNGUInt128)floor + 1));
+	}
+	// End HardwareRNGClass<T>::WideRand<cast_type> method
+#endif
+
+	RNGClass<unsigned long long> fallback;				// The OS generator, used for the key and wherever RDRAND fails
+	bool hardware;										// Whether or not RDRAND is used
+	unsigned int key[8];								// The key of the keystream, drawn from the OS
+	std::atomic<unsigned long long> next_block;			// The index of the next block of the keystream
+	std::atomic<unsigned long long> fallbacks;			// The number of blocks taken from the OS because RDRAND failed
+	HealthMonitor health;								// The health tests run on the blocks read from RDRAND
+	unsigned long long buffer[RNGHardwareBufferWords];	// The mixed words served to single draws
+	size_t next;										// The offset of the next unserved byte of the buffer
+	std::mutex buffer_muter;							// The mutex guarding the buffer and its offset
+}; // End class HardwareRNGClass
+#endif
@@ -0,0 +1,485 @@
+﻿// HealthMonitor.h - This header declares the HealthMonitor class, and implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- A HealthMonitor runs the two continuous health tests of NIST SP 800-90B (section 4.4) on the raw blocks a generator pulls from
+	its backend, treating every byte as a sample: the repetition count test, which fails when a sample repeats too many times in
+	a row (a stuck source), and the adaptive proportion test, which fails when the first sample of a 512-sample window appears
+	too often in the window (a source that lost much of its entropy).
+
+- RNGClass tests every block its Fill method pulls from the OS, and HardwareRNGClass every block of RDRAND words of at least a
+	window before mixing it (replacing failed blocks with OS output), which includes the refills of its buffer for single draws.
+	Smaller blocks and the single draws of RNGClass are not tested, since they are too small for either test.
+
+- The cutoffs follow the formulas of SP 800-90B from the claimed min-entropy per sample (8 bits for the output of a conditioned
+	source like the OS generator or RDRAND) and the false positive probability per sample (2^-40 by default, at the strict end
+	of the range the standard allows, so that false alarms stay rare at high throughput).
+
+- Both tests share a single pass over the block, written with SSE2, AVX2 and AVX-512 intrinsics on x64 (picked like the bulk
+	kernels, see RNGDispatch.h): every vector is compared with the first sample of its window and checked for 3 equal samples at
+	an even position, with two loads and two comparisons. Only blocks where it finds some (about 1 in 32 blocks of 4KB) are
+	checked for 4 equal samples at an even position, which every run of 5 or more samples contains, and only blocks with those
+	(about 1 in 8000) get the exact repetition check. Every block is tested on its own (runs and windows don't carry over
+	between blocks), so a monitor can be shared by concurrent callers, and blocks shorter than a window only get the repetition
+	count test.
+
+- The numbers of blocks and samples tested are sharded by thread like the counters of RNGMetrics, so concurrent callers don't
+	contend on them. The failure counters are only written when a test fails.
+
+- Failures never block output: they are counted, and the status of the monitor is set until it is reset, for the application to
+	act on (e.g. stop issuing keys and alert).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "monitor" as the identifier for the HealthMonitor instance (e.g. rng.GetHealth() of an RNGClass instance)
+
+To create a health monitor
+  declare HealthMonitor identifier(entropy, alpha_exponent)
+	entropy: double, the claimed min-entropy per sample (byte), in bits. If omitted, it becomes 8
+	alpha_exponent: unsigned int, the false positive probability per sample is 2^-alpha_exponent. If omitted, it becomes 40
+
+To test a block of raw output
+ Call monitor.Test(bytes, count)
+	 bytes: const void*, the block
+	 count: size_t, the number of bytes of the block
+   RETURN: RNGHealthStatus, RNG_HEALTH_OK, RNG_HEALTH_REPETITION_FAILURE or RNG_HEALTH_PROPORTION_FAILURE
+
+To get the status (the last failure since the monitor was created or reset, or RNG_HEALTH_OK)
+ Call monitor.GetStatus()
+   RETURN: RNGHealthStatus
+
+To get the counters of the monitor
+ Call monitor.GetCounters()
+   RETURN: RNGHealthCounters, with the numbers of blocks and samples tested and of failures of either test
+
+To clear the status
+ Call monitor.Reset()
+   RETURN: void
+
+To get the cutoffs of the tests
+ Call monitor.GetRepetitionCutoff() or monitor.GetProportionCutoff()
+   RETURN: unsigned int
+*/
+
+// Include guard
+#ifndef HEALTHMONITOR_H
+#define HEALTHMONITOR_H
+
+// If necessary, include the header to allow atomic operations
+#ifndef _ATOMIC_
+#include <atomic>
+#endif
+// Include the header defining the shared primitives
+#include "RNGBulk.h"
+// Include the header defining the shards of the counters
+#include "RNGMetrics.h"
+
+// Define the number of samples per window of the adaptive proportion test (SP 800-90B, section 4.4.2, for non-binary samples)
+inline constexpr size_t RNGHealthWindow = 512;
+
+// Define the number of samples checked per pass of the exact repetition count test
+inline constexpr size_t RNGHealthChunk = RNGBulkBlockSize * 8;
+
+// Define the results of a health test
+enum RNGHealthStatus { RNG_HEALTH_OK, RNG_HEALTH_REPETITION_FAILURE, RNG_HEALTH_PROPORTION_FAILURE };
+
+// Define the counters of a health monitor
+struct RNGHealthCounters {
+	unsigned long long blocks;				// The number of blocks tested
+	unsigned long long samples;				// The number of samples tested
+	unsigned long long repetition_failures;	// The number of blocks failing the repetition count test
+	unsigned long long proportion_failures;	// The number of blocks failing the adaptive proportion test
+}; // End struct RNGHealthCounters
+
+// Define the results of the scan of a block shared by both tests
+struct RNGHealthScan {
+	bool triple;		// Whether or not the block has 3 equal samples starting at an even position, which every run of 4 or more
+						//		samples does (so blocks without one pass the repetition count test without further checks)
+	bool proportion;	// Whether or not a full window has at least the cutoff of samples equal to its first sample
+}; // End struct RNGHealthScan
+
+// Define a function to check whether or not a block has 3 equal samples starting at an even position, from an even position on
+inline bool RNGTripleLoop(const unsigned char* block, size_t start, size_t count) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t start;				// The even position to start at. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	unsigned int found = 0;			// Non-zero if 3 equal samples were found
+
+	for (size_t p = start; p + 2 < count; p += 2) { found |= (unsigned int)((block[p] == block[p + 1]) & (block[p] == block[p + 2])); }
+	return found != 0;
+}
+// End RNGTripleLoop function
+
+// Define a function to check whether or not a block has 4 equal samples starting at an even position, which every run of 5 or
+//		more samples does (so blocks without one pass the repetition count test without the exact check), from an even position on
+inline bool RNGQuadLoop(const unsigned char* block, size_t start, size_t count) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t start;				// The even position to start at. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	unsigned int found = 0;			// Non-zero if 4 equal samples were found
+
+	for (size_t p = start; p + 3 < count; p += 2) { found |= (unsigned int)((block[p] == block[p + 1]) & (block[p] == block[p + 2]) & (block[p] == block[p + 3])); }
+	return found != 0;
+}
+// End RNGQuadLoop function
+
+// Define a function to scan a block for both tests in a single pass: every window is counted while its samples are checked for 3
+//		equal samples at even positions
+inline RNGHealthScan RNGScanLoop(const unsigned char* block, size_t count, unsigned int cutoff) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	// unsigned int cutoff;			// The matches in a window failing the adaptive proportion test. Passed
+	RNGHealthScan scan = { false, false };	// The results of the scan
+	size_t i = 0;							// The position of the current pair of samples
+
+	for (size_t window = 0; window + RNGHealthWindow <= count; window += RNGHealthWindow) {
+		unsigned char first = block[window];	// The first sample of the window
+		unsigned int matches = 0;				// The samples of the window equal to the first one
+
+		for (; i < window + RNGHealthWindow; i += 2) {
+			matches += (unsigned int)(block[i] == first) + (unsigned int)(block[i + 1] == first);
+			scan.triple |= i + 2 < count && block[i] == block[i + 1] && block[i] == block[i + 2];
+		} // End for(; i < window + RNGHealthWindow; i += 2)
+		scan.proportion |= matches >= cutoff;
+	} // End for(window)
+
+	scan.triple = scan.triple || RNGTripleLoop(block, i, count);
+	return scan;
+}
+// End RNGScanLoop function
+
+#ifdef RNG_HAS_DISPATCH
+// Define the SSE2 (baseline on x64) variant of RNGScanLoop. Matches are counted in 8-bit lanes (at most 32 per lane per window)
+//		summed once per window, and 8 even positions are checked per vector: a 16-bit lane equal to the lane 1 sample further
+//		means that the 3 samples starting at it are equal. NOTE: The last vector of a block can't load the sample after it, so it
+//		shifts it in from its own register instead (with a 0 past the end, which can only cause an extra check)
+inline RNGHealthScan RNGScanSSE2(const unsigned char* block, size_t count, unsigned int cutoff) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	// unsigned int cutoff;			// The matches in a window failing the adaptive proportion test. Passed
+	RNGHealthScan scan = { false, false };	// The results of the scan
+	__m128i found = _mm_setzero_si128();	// The lanes where 3 equal samples were found
+	__m128i x;								// The samples of the current vector
+	size_t i = 0;							// The position of the current vector
+
+	for (size_t window = 0; window + RNGHealthWindow <= count; window += RNGHealthWindow) {
+		const __m128i first = _mm_set1_epi8((char)block[window]);	// The first sample of the window, in every lane
+		__m128i matches = _mm_setzero_si128();						// The matches of every lane
+		size_t end = window + RNGHealthWindow;						// The end of the window
+		size_t stop = (end < count) ? end : end - 16;				// The end of the vectors that can load the next sample
+
+		for (; i < stop; i += 16) {
+			x = _mm_loadu_si128((const __m128i*)(block + i));
+			matches = _mm_sub_epi8(matches, _mm_cmpeq_epi8(x, first));
+			found = _mm_or_si128(found, _mm_cmpeq_epi16(x, _mm_loadu_si128((const __m128i*)(block + i + 1))));
+		} // End for(; i < stop; i += 16)
+		if (i < end) {
+			x = _mm_loadu_si128((const __m128i*)(block + i));
+			matches = _mm_sub_epi8(matches, _mm_cmpeq_epi8(x, first));
+			found = _mm_or_si128(found, _mm_cmpeq_epi16(x, _mm_srli_si128(x, 1)));
+			i = end;
+		} // End if(i < end)
+		matches = _mm_sad_epu8(matches, _mm_setzero_si128());
+		scan.proportion |= (unsigned int)(_mm_cvtsi128_si32(matches) + _mm_extract_epi16(matches, 4)) >= cutoff;
+	} // End for(window)
+
+	// Check the samples after the last full window
+	for (; i + 17 <= count; i += 16) {
+		x = _mm_loadu_si128((const __m128i*)(block + i));
+		found = _mm_or_si128(found, _mm_cmpeq_epi16(x, _mm_loadu_si128((const __m128i*)(block + i + 1))));
+	} // End for(; i + 17 <= count; i += 16)
+
+	scan.triple = _mm_movemask_epi8(found) != 0 || RNGTripleLoop(block, i, count);
+	return scan;
+}
+// End RNGScanSSE2 function
+
+// Define the AVX2 variant of RNGScanLoop (at most 16 matches per 8-bit lane per window)
+RNG_TARGET("avx2") inline RNGHealthScan RNGScanAVX2(const unsigned char* block, size_t count, unsigned int cutoff) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	// unsigned int cutoff;			// The matches in a window failing the adaptive proportion test. Passed
+	RNGHealthScan scan = { false, false };		// The results of the scan
+	__m256i found = _mm256_setzero_si256();		// The lanes where 3 equal samples were found
+	__m256i x;									// The samples of the current vector
+	size_t i = 0;								// The position of the current vector
+
+	for (size_t window = 0; window + RNGHealthWindow <= count; window += RNGHealthWindow) {
+		const __m256i first = _mm256_set1_epi8((char)block[window]);	// The first sample of the window, in every lane
+		__m256i matches = _mm256_setzero_si256();						// The matches of every lane
+		__m128i total;													// The sums of the halves
+		size_t end = window + RNGHealthWindow;							// The end of the window
+		size_t stop = (end < count) ? end : end - 32;					// The end of the vectors that can load the next sample
+
+		for (; i < stop; i += 32) {
+			x = _mm256_loadu_si256((const __m256i*)(block + i));
+			matches = _mm256_sub_epi8(matches, _mm256_cmpeq_epi8(x, first));
+			found = _mm256_or_si256(found, _mm256_cmpeq_epi16(x, _mm256_loadu_si256((const __m256i*)(block + i + 1))));
+		} // End for(; i < stop; i += 32)
+		if (i < end) {
+			// NOTE: The byte shift works on 128-bit halves, so the upper half is moved down first to carry its first sample
+			x = _mm256_loadu_si256((const __m256i*)(block + i));
+			matches = _mm256_sub_epi8(matches, _mm256_cmpeq_epi8(x, first));
+			found = _mm256_or_si256(found, _mm256_cmpeq_epi16(x, _mm256_alignr_epi8(_mm256_permute2x128_si256(x, x, 0x81), x, 1)));
+			i = end;
+		} // End if(i < end)
+		matches = _mm256_sad_epu8(matches, _mm256_setzero_si256());
+		total = _mm_add_epi64(_mm256_castsi256_si128(matches), _mm256_extracti128_si256(matches, 1));
+		scan.proportion |= (unsigned int)(_mm_cvtsi128_si32(total) + _mm_extract_epi16(total, 4)) >= cutoff;
+	} // End for(window)
+
+	// Check the samples after the last full window
+	for (; i + 33 <= count; i += 32) {
+		x = _mm256_loadu_si256((const __m256i*)(block + i));
+		found = _mm256_or_si256(found, _mm256_cmpeq_epi16(x, _mm256_loadu_si256((const __m256i*)(block + i + 1))));
+	} // End for(; i + 33 <= count; i += 32)
+
+	scan.triple = !_mm256_testz_si256(found, found) || RNGTripleLoop(block, i, count);
+	return scan;
+}
+// End RNGScanAVX2 function
+
+// Define the AVX-512 variant of RNGScanLoop, comparing into mask registers: matches are counted by a masked subtraction (at most 8
+//		per 8-bit lane per window), and the masks of the 16-bit comparisons are combined directly
+RNG_TARGET("avx512f,avx512bw") inline RNGHealthScan RNGScanAVX512(const unsigned char* block, size_t count, unsigned int cutoff) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	// unsigned int cutoff;			// The matches in a window failing the adaptive proportion test. Passed
+	RNGHealthScan scan = { false, false };			// The results of the scan
+	const __m512i ones = _mm512_set1_epi8(1);		// 1 in every lane
+	__mmask32 found = 0;							// The lanes where 3 equal samples were found
+	__m512i x;										// The samples of the current vector
+	size_t i = 0;									// The position of the current vector
+
+	for (size_t window = 0; window + RNGHealthWindow <= count; window += RNGHealthWindow) {
+		const __m512i first = _mm512_set1_epi8((char)block[window]);	// The first sample of the window, in every lane
+		__m512i matches = _mm512_setzero_si512();						// The matches of every lane
+		__m256i half;													// The sums of the halves
+		__m128i total;													// The sums of the quarters
+		size_t end = window + RNGHealthWindow;							// The end of the window
+		size_t stop = (end < count) ? end : end - 64;					// The end of the vectors that can load the next sample
+
+		for (; i < stop; i += 64) {
+			x = _mm512_loadu_si512(block + i);
+			matches = _mm512_mask_add_epi8(matches, _mm512_cmpeq_epi8_mask(x, first), matches, ones);
+			found |= _mm512_cmpeq_epi16_mask(x, _mm512_loadu_si512(block + i + 1));
+		} // End for(; i < stop; i += 64)
+		if (i < end) {
+			// NOTE: The byte shift works on 128-bit lanes, so the vector is also shifted down a lane (zeroing the top one) to carry
+			//		their first samples. Masked forms are used here and below, as GCC 12 warns about the undefined source of the others
+			x = _mm512_loadu_si512(block + i);
+			matches = _mm512_mask_add_epi8(matches, _mm512_cmpeq_epi8_mask(x, first), matches, ones);
+			found |= _mm512_cmpeq_epi16_mask(x, _mm512_alignr_epi8(_mm512_maskz_shuffle_i32x4((__mmask16)0x0FFF, x, x, 0x39), x, 1));
+			i = end;
+		} // End if(i < end)
+		matches = _mm512_sad_epu8(matches, _mm512_setzero_si512());
+		half = _mm256_add_epi64(_mm512_maskz_extracti64x4_epi64((__mmask8)0x0F, matches, 0), _mm512_maskz_extracti64x4_epi64((__mmask8)0x0F, matches, 1));
+		total = _mm_add_epi64(_mm256_castsi256_si128(half), _mm256_extracti128_si256(half, 1));
+		scan.proportion |= (unsigned int)(_mm_cvtsi128_si32(total) + _mm_extract_epi16(total, 4)) >= cutoff;
+	} // End for(window)
+
+	// Check the samples after the last full window
+	for (; i + 65 <= count; i += 64) {
+		x = _mm512_loadu_si512(block + i);
+		found |= _mm512_cmpeq_epi16_mask(x, _mm512_loadu_si512(block + i + 1));
+	} // End for(; i + 65 <= count; i += 64)
+
+	scan.triple = found != 0 || RNGTripleLoop(block, i, count);
+	return scan;
+}
+// End RNGScanAVX512 function
+
+// Define the SSE2 variant of RNGQuadLoop, checking 8 even positions per vector: a 16-bit lane equal to the lanes 1 and 2 samples
+//		further means that the 4 samples starting at it are equal
+inline bool RNGQuadSSE2(const unsigned char* block, size_t count) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	__m128i found = _mm_setzero_si128();	// The lanes where 4 equal samples were found
+	size_t i = 0;							// The position of the current vector
+
+	for (; i + 18 <= count; i += 16) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(block + i)); // The samples of the current vector
+		found = _mm_or_si128(found, _mm_and_si128(_mm_cmpeq_epi16(x, _mm_loadu_si128((const __m128i*)(block + i + 1))), _mm_cmpeq_epi16(x, _mm_loadu_si128((const __m128i*)(block + i + 2)))));
+	} // End for(; i + 18 <= count; i += 16)
+
+	return _mm_movemask_epi8(found) != 0 || RNGQuadLoop(block, i, count);
+}
+// End RNGQuadSSE2 function
+
+// Define the AVX2 variant of RNGQuadLoop
+RNG_TARGET("avx2") inline bool RNGQuadAVX2(const unsigned char* block, size_t count) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	__m256i found = _mm256_setzero_si256();	// The lanes where 4 equal samples were found
+	size_t i = 0;							// The position of the current vector
+
+	for (; i + 34 <= count; i += 32) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(block + i)); // The samples of the current vector
+		found = _mm256_or_si256(found, _mm256_and_si256(_mm256_cmpeq_epi16(x, _mm256_loadu_si256((const __m256i*)(block + i + 1))), _mm256_cmpeq_epi16(x, _mm256_loadu_si256((const __m256i*)(block + i + 2)))));
+	} // End for(; i + 34 <= count; i += 32)
+
+	return !_mm256_testz_si256(found, found) || RNGQuadLoop(block, i, count);
+}
+// End RNGQuadAVX2 function
+#endif
+
+// Define a function to scan a block for both tests, using the widest variant
+inline RNGHealthScan RNGScanBlock(const unsigned char* block, size_t count, unsigned int cutoff) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t count;				// The number of samples of the block. Passed
+	// unsigned int cutoff;			// The matches in a window failing the adaptive proportion test. Passed
+#ifdef RNG_HAS_DISPATCH
+	switch (RNGSelectedKernel()) {
+	case RNG_KERNEL_AVX512: return RNGScanAVX512(block, count, cutoff);
+	case RNG_KERNEL_AVX2: return RNGScanAVX2(block, count, cutoff);
+	default: return RNGScanSSE2(block, count, cutoff);
+	} // End switch(RNGSelectedKernel())
+#else
+	return RNGScanLoop(block, count, cutoff);
+#endif
+}
+// End RNGScanBlock function
+
+// Define a function to check whether or not a block has 4 equal samples starting at an even position, using the widest variant.
+//		NOTE: Only runs on the few blocks the scan found 3 equal samples in, so it stops at AVX2
+inline bool RNGQuadScan(const unsigned char* block, size_t count) {
+	// const unsigned char* block;	// The samples of the block. Passed
+	// size_t count;				// The number of samples of the block. Passed
+#ifdef RNG_HAS_DISPATCH
+	if (RNGSelectedKernel() >= RNG_KERNEL_AVX2) { return RNGQuadAVX2(block, count); }
+	return RNGQuadSSE2(block, count);
+#else
+	return RNGQuadLoop(block, 0, count);
+#endif
+}
+// End RNGQuadScan function
+
+class HealthMonitor {
+public:
+	// Define the constructor to calculate the cutoffs of the tests
+	explicit HealthMonitor(double entropy = 8, unsigned int alpha_exponent = 40) : status(RNG_HEALTH_OK), shards{}, repetition_failures(0), proportion_failures(0) {
+		// double entropy;				// The claimed min-entropy per sample, in bits. Passed. 8 if omitted
+		// unsigned int alpha_exponent;	// The false positive probability per sample is 2^-alpha_exponent. Passed. 40 if omitted
+		double alpha = std::ldexp(1.0, -(int)alpha_exponent);	// The false positive probability
+		double probability = std::exp2(-entropy);				// The probability of the most likely sample
+		double tail = 0;										// The probability of more than critical matches in a window
+		unsigned int critical = (unsigned int)RNGHealthWindow;	// CRITBINOM(W, p, 1 - alpha)
+
+		// Ensure that the parameters are valid
+		assert(("The entropy per sample must be in (0, 8]", entropy > 0 && entropy <= 8));
+		assert(("The false positive exponent must be positive", alpha_exponent > 0));
+
+		// Repetition count test: C = 1 + ceil(-log2(alpha) / H)
+		this->repetition_cutoff = 1 + (unsigned int)std::ceil(alpha_exponent / entropy);
+
+		// Adaptive proportion test: C = 1 + CRITBINOM(W, p, 1 - alpha), the smallest k with P(X ≤ k) ≥ 1 - alpha, found by
+		//		summing the binomial tail from the top (in logarithms, since the terms are tiny)
+		while (critical > 0) {
+			double term = std::exp(std::lgamma(RNGHealthWindow + 1.0) - std::lgamma(critical + 1.0) - std::lgamma(RNGHealthWindow - critical + 1.0) + critical * std::log(probability) + (RNGHealthWindow - critical) * std::log1p(-probability)); // P(X = critical)
+			if (tail + term > alpha) { break; }
+			tail += term;
+			critical--;
+		} // End while(critical > 0)
+		this->proportion_cutoff = 1 + critical;
+	}
+
+	// Disallow copies, since the counters are shared by all callers
+	HealthMonitor(const HealthMonitor&) = delete;
+	HealthMonitor& operator=(const HealthMonitor&) = delete;
+
+	// **** Define non-const methods ****
+
+	// Define a method to run both tests on a block of raw output. NOTE: Thread-safe
+	RNGHealthStatus Test(const void* bytes, size_t count) {
+		// const void* bytes;	// The block. Passed
+		// size_t count;		// The number of bytes of the block. Passed
+		const unsigned char* block = (const unsigned char*)bytes;	// The samples of the block
+		bool repetition_failed = false;								// Whether or not a run reached the cutoff
+		RNGHealthStatus result = RNG_HEALTH_OK;						// The result to return
+		Shard& shard = this->shards[RNGMetricShard()];				// The counters of the current thread
+
+		// Scan the block once for both tests: the adaptive proportion test counts the samples of every full window equal to its
+		//		first sample, and the repetition count test looks for 3 equal samples at an even position. Only blocks with some
+		//		(about 1 in 32 blocks of 4KB) are checked for 4 equal samples at an even position, which every run of 5 or more
+		//		has, and only blocks with those get the exact check (unless the cutoff is below 5)
+		RNGHealthScan scan = RNGScanBlock(block, count, this->proportion_cutoff); // The results of the scan
+		if (this->repetition_cutoff < 5 || (scan.triple && RNGQuadScan(block, count))) { repetition_failed = this->HasRun(block, count); }
+
+		// Update the counters and the status
+		shard.blocks.fetch_add(1, std::memory_order_relaxed);
+		shard.samples.fetch_add(count, std::memory_order_relaxed);
+		if (repetition_failed) {
+			this->repetition_failures.fetch_add(1, std::memory_order_relaxed);
+			result = RNG_HEALTH_REPETITION_FAILURE;
+		} // End if(repetition_failed)
+		if (scan.proportion) {
+			this->proportion_failures.fetch_add(1, std::memory_order_relaxed);
+			result = RNG_HEALTH_PROPORTION_FAILURE;
+		} // End if(scan.proportion)
+		if (result != RNG_HEALTH_OK) { this->status.store(result, std::memory_order_relaxed); }
+		return result;
+	}
+	// End HealthMonitor::Test method
+
+	// Define a method to clear the status
+	void Reset() { this->status.store(RNG_HEALTH_OK, std::memory_order_relaxed); }
+
+	// **** Define const methods ****
+
+	// Define a method to return the last failure since the monitor was created or reset, or RNG_HEALTH_OK
+	RNGHealthStatus GetStatus() const { return this->status.load(std::memory_order_relaxed); }
+
+	// Define a method to return the counters of the monitor
+	RNGHealthCounters GetCounters() const {
+		RNGHealthCounters counters = { 0, 0, this->repetition_failures.load(std::memory_order_relaxed), this->proportion_failures.load(std::memory_order_relaxed) }; // The counters to return
+
+		for (size_t s = 0; s < RNGMetricShards; s++) {
+			counters.blocks += this->shards[s].blocks.load(std::memory_order_relaxed);
+			counters.samples += this->shards[s].samples.load(std::memory_order_relaxed);
+		} // End for(s)
+		return counters;
+	}
+	// End HealthMonitor::GetCounters method
+
+	// Define methods to return the cutoffs of the tests
+	unsigned int GetRepetitionCutoff() const { return this->repetition_cutoff; }
+	unsigned int GetProportionCutoff() const { return this->proportion_cutoff; }
+
+protected:
+	// Define a shard of the counters of every block, aligned so that no two shards share a cache line (see RNGMetrics.h)
+	struct alignas(64) Shard {
+		std::atomic<unsigned long long> blocks;		// The number of blocks tested
+		std::atomic<unsigned long long> samples;	// The number of samples tested
+	}; // End struct Shard
+
+	// Define a method to check exactly whether or not a block has a run of repetition_cutoff equal samples
+	bool HasRun(const unsigned char* block, size_t count) const {
+		// const unsigned char* block;	// The samples of the block. Passed
+		// size_t count;				// The number of samples of the block. Passed
+		unsigned char run[RNGHealthChunk];					// Whether or not a run starts at every position of the current pass
+		unsigned int span = this->repetition_cutoff - 1;	// The distance between the first and the last sample of a run
+		unsigned char found = 0;							// Non-zero if a run was found
+
+		// A run starts at i if every sample up to i + span equals sample i, checked one distance at a time so that every pass is a
+		//		plain loop
+		for (size_t start = 0; start + span < count; start += RNGHealthChunk) {
+			size_t positions = count - span - start; // The number of positions of this pass
+			if (positions > RNGHealthChunk) { positions = RNGHealthChunk; }
+
+			for (size_t i = 0; i < positions; i++) { run[i] = (unsigned char)(block[start + i] == block[start + i + 1]); }
+			for (size_t k = 2; k <= span; k++) {
+				for (size_t i = 0; i < positions; i++) { run[i] &= (unsigned char)(block[start + i] == block[start + i + k]); }
+			} // End for(k)
+			for (size_t i = 0; i < positions; i++) { found |= run[i]; }
+		} // End for(start)
+		return found != 0;
+	}
+	// End HealthMonitor::HasRun method
+
+	unsigned int repetition_cutoff;								// The length of a run failing the repetition count test
+	unsigned int proportion_cutoff;								// The matches in a window failing the adaptive proportion test
+	std::atomic<RNGHealthStatus> status;						// The last failure, or RNG_HEALTH_OK
+	Shard shards[RNGMetricShards];								// The numbers of blocks and samples tested, sharded by thread
+	std::atomic<unsigned long long> repetition_failures;		// The number of blocks failing the repetition count test
+	std::atomic<unsigned long long> proportion_failures;		// The number of blocks failing the adaptive proportion test
+}; // End class HealthMonitor
+#endif
@@ -0,0 +1,201 @@
+﻿// MersenneTwisterClass.h - This header declares the MersenneTwisterClass class, and (due to it being a class template)
+//		implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- MersenneTwisterClass<unsigned int> produces exactly the same numbers as std::mt19937, and MersenneTwisterClass<unsigned long long>
+	exactly the same as std::mt19937_64, for the same seed (including the default seed 5489). Since min() and max() match too, the
+	std distributions and std::shuffle give the same results with either engine, so data generated with the std engines can be
+	replayed bit for bit.
+
+- The difference is speed: the state is regenerated (twisted) as a whole block in three branch-free loops instead of one word at
+	a time. In each loop every word only depends on words that are either not yet rewritten or were rewritten at least m words
+	earlier, so the compiler vectorizes the loops (SFMT-style block generation, keeping the MT19937 recurrence). Fill tempers whole
+	blocks straight into the caller's buffer.
+
+- Verify checks the 10000th number of a default-seeded engine against the value required by the C++ standard (§29.6.5), which is
+	a quick way to confirm a build reproduces the std sequences. It is constexpr, so the check can be a static_assert.
+
+- The engine is constexpr, so it can also run at compile time (e.g. to build a table in a constant expression).
+
+- Like the std engines, an instance is NOT thread-safe. It is NOT suitable for cryptographic use.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for the MersenneTwisterClass instance, and result_type as the type specified at
+	identifier declaration
+
+To create a Mersenne Twister matching std::mt19937 or std::mt19937_64
+  declare MersenneTwisterClass<result_type> identifier(seed)
+	result_type: "unsigned int" (for std::mt19937) or "unsigned long long" (for std::mt19937_64)
+	seed: result_type, the seed of the generator. If omitted, it becomes 5489 (the default of the std engines)
+
+To generate a random number
+ Call rng() or rng.GetRand()
+   RETURN: result_type
+
+To fill a buffer with random numbers (the same numbers as repeated rng() calls)
+ Call rng.Fill(numbers, count)
+	 numbers: result_type*, the buffer to fill
+	 count: size_t, the number of numbers to write
+   RETURN: void
+
+To reseed the instance
+ Call rng.Seed(seed)
+	 seed: result_type, the seed of the generator
+   RETURN: void
+
+To skip numbers
+ Call rng.Discard(count)
+	 count: unsigned long long, the number of numbers to skip
+   RETURN: void
+
+To check that the engine reproduces the std sequence (at compile time with static_assert(MersenneTwisterClass<result_type>::Verify()))
+ call MersenneTwisterClass<result_type>::Verify()
+   RETURN: bool, whether or not the 10000th number of a default-seeded engine is the one required by the standard
+*/
+
+// Include guard
+#ifndef MERSENNETWISTERCLASS_H
+#define MERSENNETWISTERCLASS_H
+
+// Include the header defining the shared primitives
+#include "RNGBulk.h"
+
+// typename T; // The type of number to generate. Must be unsigned int (MT19937) or unsigned long long (MT19937-64)
+template <typename T>
+class MersenneTwisterClass { // NOTE: Like RNGClass, this class is compliant with §29.6.1.3 of the C++17 standard draft
+public:
+	// Ensure that the provided type is one of the two supported widths
+	static_assert(std::is_same_v<T, unsigned int> || std::is_same_v<T, unsigned long long>, "The type provided for MersenneTwisterClass must be unsigned int or unsigned long long");
+
+	// Create result_type as an alias for T (the provided type)
+	typedef T result_type;
+
+	// Define the parameters of the two engines (§29.6.5 of the C++17 standard draft)
+	static constexpr bool wide = sizeof(T) == 8;											// Whether or not this is MT19937-64
+	static constexpr size_t state_size = wide ? 312 : 624;									// n
+	static constexpr size_t shift_size = wide ? 156 : 397;									// m
+	static constexpr T xor_mask = (T)(wide ? 0xB5026F5AA96619E9ULL : 0x9908B0DFULL);		// a
+	static constexpr T upper_mask = (T)(wide ? 0xFFFFFFFF80000000ULL : 0x80000000ULL);		// The upper w - r bits
+	static constexpr T lower_mask = (T)~upper_mask;											// The lower r bits
+	static constexpr T initialization_multiplier = (T)(wide ? 6364136223846793005ULL : 1812433253ULL); // f
+	static constexpr T default_seed = 5489;
+
+	// Define the constructor to seed the instance
+	constexpr explicit MersenneTwisterClass(result_type seed = default_seed) : state{}, index(0) { this->Seed(seed); }
+
+	// **** Define non-const methods ****
+
+	// Define the () operator to return the next number, as required by §29.6.1.3 of the C++17 standard draft
+	constexpr result_type operator()() {
+		if (this->index >= state_size) { this->Twist(); }
+		return MersenneTwisterClass::Temper(this->state[this->index++]);
+	}
+	// End MersenneTwisterClass<T>::operator() method
+
+	// Define a method to fill a buffer with the next numbers, tempering whole blocks at once
+	constexpr void Fill(result_type* numbers, size_t count) {
+		// result_type* numbers;	// The buffer to fill. Passed
+		// size_t count;			// The number of numbers to write. Passed
+		size_t block = 0;				// The number of numbers taken from the current state
+
+		while (count > 0) {
+			if (this->index >= state_size) { this->Twist(); }
+			block = (count < state_size - this->index) ? count : state_size - this->index;
+			for (size_t i = 0; i < block; i++) { numbers[i] = MersenneTwisterClass::Temper(this->state[this->index + i]); }
+			this->index += block;
+			numbers += block;
+			count -= block;
+		} // End while(count > 0)
+	}
+	// End MersenneTwisterClass<T>::Fill method
+
+	// Define a method to reseed the instance, as std::mersenne_twister_engine::seed does
+	constexpr void Seed(result_type seed) {
+		// result_type seed; // The seed of the generator. Passed
+
+		this->state[0] = seed;
+		for (size_t i = 1; i < state_size; i++) {
+			this->state[i] = (T)(initialization_multiplier * (this->state[i - 1] ^ (this->state[i - 1] >> (wide ? 62 : 30))) + (T)i);
+		} // End for(i)
+		this->index = state_size;
+	}
+	// End MersenneTwisterClass<T>::Seed method
+
+	// Define a method to skip numbers. NOTE: Whole states are skipped by twisting without tempering
+	constexpr void Discard(unsigned long long count) {
+		// unsigned long long count; // The number of numbers to skip. Passed
+
+		while (count > state_size - this->index) {
+			count -= state_size - this->index;
+			this->Twist();
+		} // End while(count > state_size - this->index)
+		this->index += (size_t)count;
+	}
+	// End MersenneTwisterClass<T>::Discard method
+
+	// Define a method to return a random number (since pointers can't access the "()" operator in an easily readable way)
+	constexpr result_type GetRand() { return this->operator()(); }
+
+	// **** Define const methods ****
+
+	// Define the method "max" to return the maximum number the provided type can contain. NOTE: Name is wrapped in "()" to
+	//		avoid the compiler trying to replace "max" with the macro defined in Windows.h
+	static constexpr T(max)() { return RNGHighest<T>(); }
+
+	// Define the method "min" to return the minimum number the provided type can contain
+	static constexpr T(min)() { return 0; }
+
+	// Define a static method to check the 10000th number of a default-seeded engine against the value required by the standard
+	static constexpr bool Verify() {
+		MersenneTwisterClass engine; // A default-seeded engine
+
+		engine.Discard(9999);
+		return engine() == (T)(wide ? 9981545732273789042ULL : 4123659995ULL);
+	}
+	// End MersenneTwisterClass<T>::Verify method
+
+protected:
+	// Define a method to regenerate the whole state. NOTE: Split in three loops at the points where the words read by the
+	//		recurrence wrap around, so that no loop depends on a word rewritten less than m words earlier
+	constexpr void Twist() {
+		T y = 0; // The concatenation of the upper bits of a word and the lower bits of the next
+
+		for (size_t i = 0; i < state_size - shift_size; i++) {
+			y = (this->state[i] & upper_mask) | (this->state[i + 1] & lower_mask);
+			this->state[i] = this->state[i + shift_size] ^ (y >> 1) ^ ((0 - (y & 1)) & xor_mask);
+		} // End for(i)
+		for (size_t i = state_size - shift_size; i < state_size - 1; i++) {
+			y = (this->state[i] & upper_mask) | (this->state[i + 1] & lower_mask);
+			this->state[i] = this->state[i + shift_size - state_size] ^ (y >> 1) ^ ((0 - (y & 1)) & xor_mask);
+		} // End for(i)
+		y = (this->state[state_size - 1] & upper_mask) | (this->state[0] & lower_mask);
+		this->state[state_size - 1] = this->state[shift_size - 1] ^ (y >> 1) ^ ((0 - (y & 1)) & xor_mask);
+
+		this->index = 0;
+	}
+	// End MersenneTwisterClass<T>::Twist method
+
+	// Define a static method to temper a word of the state into an output number
+	static constexpr T Temper(T y) {
+		// T y; // The word to temper. Passed
+
+		if constexpr (wide) {
+			y ^= (y >> 29) & 0x5555555555555555ULL;
+			y ^= (y << 17) & 0x71D67FFFEDA60000ULL;
+			y ^= (y << 37) & 0xFFF7EEE000000000ULL;
+			return y ^ (y >> 43);
+		}
+		else {
+			y ^= y >> 11;
+			y ^= (y << 7) & 0x9D2C5680u;
+			y ^= (y << 15) & 0xEFC60000u;
+			return y ^ (y >> 18);
+		}
+	}
+	// End MersenneTwisterClass<T>::Temper method
+
+	T state[state_size];	// The state of the engine
+	size_t index;			// The position of the next word of the state to temper
+}; // End class MersenneTwisterClass
+#endif
@@ -0,0 +1,270 @@
+﻿// RNGArrivals.h - This header declares the ArrivalProcess class, and implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- An ArrivalProcess generates the timestamps of events (e.g. requests of a load generator) in batches. It remembers the time of
+	the last arrival and its current state, so consecutive batches continue the same process.
+
+- Every kind of process is generated by the same time change: one unit exponential number is drawn per arrival (in bulk), and
+	is "spent" at the current rate. When the rate changes before the number is spent, the remainder carries over to the new rate,
+	which is exact for Poisson processes with piecewise constant rates. A constant rate process is a plain cumulative sum.
+
+- A rate of 0 is allowed for any state or segment (e.g. the "off" state of an on/off source), but at least one must be positive.
+	A zero rate that never ends (the last segment of a schedule that doesn't repeat, or an absorbing state) ends the process: no
+	more arrivals happen, so every timestamp from then on is +inf (HUGE_VAL).
+
+- Rate changes of schedules happen at fixed times. Rate changes of Markov-modulated processes happen after exponentially
+	distributed holding times, after which the next state is chosen according to the transition rates. The draws needed for
+	state changes are made one at a time, since they are far rarer than arrivals.
+
+- Like the distributions, an instance is used with a generator: any generator with a 64-bit result_type and a "Fill" method
+	(RNGClass or SeededRNGClass). An instance is NOT thread-safe, so give every thread its own.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type, and "arrivals" as the identifier
+	for the ArrivalProcess instance. Times and rates use the same (arbitrary) unit of time
+
+To create a Poisson process with a constant rate
+ call ArrivalProcess::Poisson(rate, start)
+	 rate: double, the mean number of arrivals per unit of time. Must be positive
+	 start: double, the time the process starts at. If omitted, it becomes 0
+   RETURN: ArrivalProcess
+
+To create a Poisson process whose rate follows a schedule of constant rate segments
+ call ArrivalProcess::Schedule(rates, durations, segments, repeat, start)
+	 rates: const double*, the rate of every segment
+	 durations: const double*, the length of every segment. Must be positive
+	 segments: size_t, the number of segments
+	 repeat: bool, whether or not to start over once the schedule ends (otherwise the last rate is kept). If omitted, it becomes true
+	 start: double, the time the process (and its first segment) starts at. If omitted, it becomes 0
+   RETURN: ArrivalProcess
+
+To create a Markov-modulated Poisson process
+ call ArrivalProcess::Modulated(rates, transitions, states, initial_state, start)
+	 rates: const double*, the arrival rate of every state
+	 transitions: const double*, a states x states matrix (row by row) of the rates of moving from every state to every other
+		state. The diagonal is ignored
+	 states: size_t, the number of states
+	 initial_state: size_t, the state the process starts in. If omitted, it becomes 0
+	 start: double, the time the process starts at. If omitted, it becomes 0
+   RETURN: ArrivalProcess
+
+To create a bursty process alternating between a normal and a burst rate (a two-state Markov-modulated Poisson process)
+ call ArrivalProcess::Bursty(normal_rate, burst_rate, normal_duration, burst_duration, start)
+	 normal_rate: double, the arrival rate outside of bursts
+	 burst_rate: double, the arrival rate during bursts
+	 normal_duration: double, the mean time between bursts
+	 burst_duration: double, the mean length of a burst
+	 start: double, the time the process starts at (outside of a burst). If omitted, it becomes 0
+   RETURN: ArrivalProcess
+
+To generate the timestamps of the next arrivals
+ Call arrivals.Generate(rng, times, count)
+	 times: double*, the buffer to fill with increasing timestamps (+inf once the process has ended on a zero rate)
+	 count: size_t, the number of arrivals to generate
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGARRIVALS_H
+#define RNGARRIVALS_H
+
+// If necessary, include the header to allow vectors
+#ifndef _VECTOR_
+#include <vector>
+#endif
+// Include the header defining the shared bulk primitives and the bulk exponential fill
+#include "RNGBulk.h"
+
+class ArrivalProcess {
+public:
+	// **** Define static methods ****
+
+	// Define a method to create a Poisson process with a constant rate
+	static ArrivalProcess Poisson(double rate, double start = 0) {
+		ArrivalProcess process(start); // The process to return
+
+		// Ensure that the rate is valid
+		assert(("The rate of a Poisson process must be positive", rate > 0));
+
+		process.rates.assign(1, rate);
+		process.rate = rate;
+		return process;
+	}
+	// End ArrivalProcess::Poisson method
+
+	// Define a method to create a Poisson process whose rate follows a schedule
+	static ArrivalProcess Schedule(const double* rates, const double* durations, size_t segments, bool repeat = true, double start = 0) {
+		ArrivalProcess process(start); // The process to return
+
+		// Ensure that the schedule is valid
+		assert(("A schedule must have at least one segment", segments > 0));
+
+		process.kind = KIND_SCHEDULE;
+		process.rates.assign(rates, rates + segments);
+		process.durations.assign(durations, durations + segments);
+		process.repeat = repeat;
+		process.rate = rates[0];
+		process.next_change = (segments > 1 || repeat) ? start + durations[0] : HUGE_VAL;
+		return process;
+	}
+	// End ArrivalProcess::Schedule method
+
+	// Define a method to create a Markov-modulated Poisson process
+	static ArrivalProcess Modulated(const double* rates, const double* transitions, size_t states, size_t initial_state = 0, double start = 0) {
+		ArrivalProcess process(start); // The process to return
+
+		// Ensure that the states are valid
+		assert(("A Markov-modulated process must have at least one state", states > 0 && initial_state < states));
+
+		process.kind = KIND_MODULATED;
+		process.rates.assign(rates, rates + states);
+		process.transitions.assign(transitions, transitions + states * states);
+		process.leave_rates.assign(states, 0);
+		for (size_t i = 0; i < states; i++) {
+			process.transitions[i * states + i] = 0;
+			for (size_t j = 0; j < states; j++) { process.leave_rates[i] += process.transitions[i * states + j]; }
+		} // End for(i)
+		process.state = initial_state;
+		process.rate = rates[initial_state];
+		process.holding_pending = true; // NOTE: The first holding time needs a generator, so it's drawn on the first Generate call
+		return process;
+	}
+	// End ArrivalProcess::Modulated method
+
+	// Define a method to create a bursty process (a two-state Markov-modulated Poisson process)
+	static ArrivalProcess Bursty(double normal_rate, double burst_rate, double normal_duration, double burst_duration, double start = 0) {
+		double rates[2] = { normal_rate, burst_rate };										// The rates of the two states
+		double transitions[4] = { 0, 1 / normal_duration, 1 / burst_duration, 0 };			// The rates of moving between them
+
+		return ArrivalProcess::Modulated(rates, transitions, 2, 0, start);
+	}
+	// End ArrivalProcess::Bursty method
+
+	// **** Define non-const methods ****
+
+	// Define a method to generate the timestamps of the next arrivals
+	template<typename engine_type> void Generate(engine_type& rng, double* times, size_t count) {
+		// engine_type& rng;	// The generator to pull bits from. Passed by reference
+		// double* times;		// The buffer to fill with the timestamps. Passed
+		// size_t count;		// The number of arrivals to generate. Passed
+		double inverse_rate;	// The reciprocal of the current rate
+		double budget;			// The unit exponential number left to spend on the current arrival
+
+		// If necessary, draw the first holding time of a Markov-modulated process
+		if (this->holding_pending) {
+			this->holding_pending = false;
+			this->next_change = this->time + this->HoldingTime(rng);
+		} // End if(this->holding_pending)
+
+		// If the process has ended on a zero rate that never changes, there are no more arrivals
+		if (this->rate <= 0 && this->next_change == HUGE_VAL) {
+			this->End(times, count);
+			return;
+		} // End if(this->rate <= 0 && this->next_change == HUGE_VAL)
+
+		// Draw the unit exponential numbers of every arrival into the output, to be turned into timestamps in place
+		FillExponentialRand(rng, times, count, 1.0);
+
+		// With a constant rate, the timestamps are a plain scaled cumulative sum
+		if (this->next_change == HUGE_VAL) {
+			inverse_rate = 1 / this->rate;
+			for (size_t i = 0; i < count; i++) {
+				this->time += times[i] * inverse_rate;
+				times[i] = this->time;
+			} // End for(i)
+			return;
+		} // End if(this->next_change == HUGE_VAL)
+
+		// Otherwise, spend every number at the current rate, carrying the remainder over whenever the rate changes first. NOTE: The
+		//		process ends if it reaches a zero rate that never changes
+		for (size_t i = 0; i < count; i++) {
+			budget = times[i];
+			while (this->next_change != HUGE_VAL && budget >= this->rate * (this->next_change - this->time)) {
+				budget -= this->rate * (this->next_change - this->time);
+				this->time = this->next_change;
+				this->ChangeRate(rng);
+			} // End while(this->next_change != HUGE_VAL && budget >= this->rate * (this->next_change - this->time))
+			if (this->rate <= 0) {
+				this->End(times + i, count - i);
+				return;
+			} // End if(this->rate <= 0)
+			this->time += budget / this->rate;
+			times[i] = this->time;
+		} // End for(i)
+	}
+	// End ArrivalProcess::Generate method
+
+	// **** Define const methods ****
+
+	// Define methods to return the time of the last arrival (or the start), the current rate, and the current state or segment
+	double GetTime() const { return this->time; }
+	double GetRate() const { return this->rate; }
+	size_t GetState() const { return this->state; }
+
+protected:
+	// Define the kinds of processes
+	enum Kind { KIND_CONSTANT, KIND_SCHEDULE, KIND_MODULATED };
+
+	// Define the constructor used by the creation methods
+	explicit ArrivalProcess(double start) : kind(KIND_CONSTANT), repeat(false), holding_pending(false), state(0), time(start), rate(0), next_change(HUGE_VAL) {}
+
+	// Define a method to move on to the next segment or state once the current one ends
+	template<typename engine_type> void ChangeRate(engine_type& rng) {
+		// engine_type& rng; // The generator used to choose the next state. Passed by reference
+		size_t states = this->rates.size(); // The number of states or segments
+
+		if (this->kind == KIND_SCHEDULE) {
+			// Move on to the next segment, keeping the last one forever if the schedule doesn't repeat
+			this->state = (this->state + 1 < states) ? this->state + 1 : 0;
+			this->rate = this->rates[this->state];
+			this->next_change = (this->repeat || this->state + 1 < states) ? this->time + this->durations[this->state] : HUGE_VAL;
+		} // End if(this->kind == KIND_SCHEDULE)
+		else {
+			// Choose the next state in proportion to the transition rates, then draw how long it lasts
+			double target = RNGBitsToUnit<double>(rng()) * this->leave_rates[this->state]; // The point choosing the next state
+			size_t next = this->state; // The next state. NOTE: Rounding can leave the point past the last state, which is then kept
+			for (size_t j = 0; j < states; j++) {
+				if (this->transitions[this->state * states + j] <= 0) { continue; }
+				next = j;
+				target -= this->transitions[this->state * states + j];
+				if (target < 0) { break; }
+			} // End for(j)
+			this->state = next;
+			this->rate = this->rates[next];
+			this->next_change = this->time + this->HoldingTime(rng);
+		} // End else
+	}
+	// End ArrivalProcess::ChangeRate method
+
+	// Define a method to end the process, setting the remaining timestamps to +inf
+	void End(double* times, size_t count) {
+		// double* times;	// The remaining timestamps. Passed
+		// size_t count;	// The number of remaining timestamps. Passed
+
+		for (size_t i = 0; i < count; i++) { times[i] = HUGE_VAL; }
+		this->time = HUGE_VAL;
+	}
+	// End ArrivalProcess::End method
+
+	// Define a method to draw how long the current state of a Markov-modulated process lasts
+	template<typename engine_type> double HoldingTime(engine_type& rng) {
+		// NOTE: An absorbing state (with no way out) lasts forever
+		if (this->leave_rates[this->state] <= 0) { return HUGE_VAL; }
+		return -std::log(RNGBitsToOpenUnit<double>(rng())) / this->leave_rates[this->state];
+	}
+	// End ArrivalProcess::HoldingTime method
+
+	Kind kind;								// The kind of process
+	bool repeat;							// Boolean for whether or not a schedule starts over once it ends
+	bool holding_pending;					// Boolean for whether or not the first holding time still has to be drawn
+	size_t state;							// The current state or segment
+	double time;							// The time of the last arrival (or the start)
+	double rate;							// The current rate
+	double next_change;						// The time the current rate ends (HUGE_VAL if never)
+	std::vector<double> rates;				// The rate of every state or segment
+	std::vector<double> durations;			// The length of every segment of a schedule
+	std::vector<double> transitions;		// The transition rates between the states of a Markov-modulated process
+	std::vector<double> leave_rates;		// The total rate of leaving every state of a Markov-modulated process
+}; // End class ArrivalProcess
+#endif
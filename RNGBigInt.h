@@ -0,0 +1,133 @@
+﻿// RNGBigInt.h - This header defines the templated functions used to generate uniform multi-limb integers below an arbitrary bound
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Numbers are arrays of 64-bit limbs, least significant limb first, and every generated number has as many limbs as the bound
+	(limbs above the highest non-zero limb of the bound are always 0).
+
+- Generation is by rejection: a candidate gets random lower limbs and a top limb masked to the bit length of the bound's top limb,
+	so at least half of the candidates are accepted. Only the top limbs are compared in the common case; the remaining limbs are
+	compared only when the top limbs are equal, which (for a top limb with many bits) almost never happens.
+
+- The bulk overload generates many candidates with one Fill call and compacts the accepted ones into the output, so an RNGClass
+	instance makes one OS call per block of candidates rather than one per limb. For cryptographic use (e.g. nonces or keys below
+	a modulus), pass an RNGClass<unsigned long long> instance, which is backed by the OS's secure generator.
+
+- Blocks of up to RNGBigIntStackLimbs limbs (e.g. one or a few numbers of up to a few thousand bits) are kept on the stack, and
+	larger ones on the heap. Either way, the candidates are wiped with SecureZeroMemory once a block is compacted, so neither
+	rejected nor accepted limbs are left behind.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type (e.g. RNGClass<unsigned long long>)
+
+To generate a number in the set { number | 0 ≤ number < bound }
+ call GenerateBelow(rng, bound, limbs, number)
+	 bound: const unsigned long long*, the limbs of the bound, least significant first. Must not be 0
+	 limbs: size_t, the number of limbs of the bound (and of the number)
+	 number: unsigned long long*, the buffer to fill with the limbs of the number
+   RETURN: void
+
+To generate many numbers in the set { number | 0 ≤ number < bound }
+ call GenerateBelow(rng, bound, limbs, numbers, count)
+	 bound: const unsigned long long*, the limbs of the bound, least significant first. Must not be 0
+	 limbs: size_t, the number of limbs of the bound (and of every number)
+	 numbers: unsigned long long*, the buffer to fill, with number i in the limbs [i * limbs, (i + 1) * limbs)
+	 count: size_t, the number of numbers to generate
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGBIGINT_H
+#define RNGBIGINT_H
+
+// If necessary, include the header to allow the use of WinAPI (used to wipe candidates)
+#ifndef _WINDOWS_
+#include <Windows.h>
+#endif
+// If necessary, include the header to allow vectors
+#ifndef _VECTOR_
+#include <vector>
+#endif
+// Include the header defining the shared bulk primitives
+#include "RNGBulk.h"
+
+// Define the maximum number of random limbs pulled from a generator at a time by GenerateBelow (32KiB)
+inline constexpr size_t RNGBigIntBlockLimbs = RNGBulkBlockSize * 8;
+
+// Define the maximum number of random limbs GenerateBelow keeps on the stack instead of the heap (2KiB)
+inline constexpr size_t RNGBigIntStackLimbs = 256;
+
+// Define a templated function to generate many numbers in the set { number | 0 ≤ number < bound }
+template<typename engine_type> void GenerateBelow(engine_type& rng, const unsigned long long* bound, size_t limbs, unsigned long long* numbers, size_t count) {
+	// engine_type& rng;					// The generator to pull bits from. Passed by reference
+	// const unsigned long long* bound;		// The limbs of the bound, least significant first. Passed
+	// size_t limbs;						// The number of limbs of the bound and of every number. Passed
+	// unsigned long long* numbers;			// The buffer to fill. Passed
+	// size_t count;						// The number of numbers to generate. Passed
+	unsigned long long local[RNGBigIntStackLimbs];	// The limbs of the current block of candidates, if they fit on the stack
+	std::vector<unsigned long long> heap;			// The limbs of the current block of candidates, otherwise
+	unsigned long long* candidates;					// The limbs of the current block of candidates
+	size_t used = limbs;						// The number of limbs up to and including the highest non-zero limb of the bound
+	unsigned long long top;						// The highest non-zero limb of the bound
+	unsigned long long mask;					// The bits of the top limb that candidates may set
+	double acceptance;							// The probability of a candidate being accepted (roughly)
+	size_t block;								// The number of candidates of the current block
+	size_t accepted;							// The number of candidates of the current block that were accepted
+
+	// Ensure that the provided generator is usable
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for GenerateBelow must have a 64-bit result_type");
+
+	// Find the highest non-zero limb of the bound, and mask candidates' top limbs to its bit length
+	while (used > 0 && bound[used - 1] == 0) { used--; }
+	assert(("The bound must not be 0", used > 0));
+	top = bound[used - 1];
+	mask = top;
+	for (int shift = 1; shift < 64; shift *= 2) { mask |= mask >> shift; }
+	acceptance = ((double)top + 1) / ((double)mask + 1);
+
+	while (count > 0) {
+		// Generate enough candidates for the remaining numbers (on average), up to a block
+		block = (size_t)((double)count / acceptance) + 1;
+		if (block * used > RNGBigIntBlockLimbs) { block = (RNGBigIntBlockLimbs / used > 0) ? RNGBigIntBlockLimbs / used : 1; }
+		if (block * used <= RNGBigIntStackLimbs) { candidates = local; }
+		else {
+			heap.resize(block * used);
+			candidates = heap.data();
+		} // End else
+		rng.Fill(candidates, block * used);
+
+		// Keep the candidates below the bound, comparing the lower limbs only if the top limbs are equal
+		accepted = 0;
+		for (size_t c = 0; c < block && accepted < count; c++) {
+			unsigned long long* candidate = candidates + c * used; // The limbs of the current candidate
+			bool below;											   // Whether or not the candidate is below the bound
+			candidate[used - 1] &= mask;
+			if (candidate[used - 1] != top) { below = candidate[used - 1] < top; }
+			else {
+				size_t limb = used - 1; // The limb being compared
+				while (limb > 0 && candidate[limb - 1] == bound[limb - 1]) { limb--; }
+				below = limb > 0 && candidate[limb - 1] < bound[limb - 1];
+			} // End else
+
+			if (below) {
+				unsigned long long* number = numbers + accepted * limbs; // The limbs of the number being written
+				for (size_t limb = 0; limb < used; limb++) { number[limb] = candidate[limb]; }
+				for (size_t limb = used; limb < limbs; limb++) { number[limb] = 0; }
+				accepted++;
+			} // End if(below)
+		} // End for(c)
+
+		// Wipe the candidates before the buffer is reused, grown or freed
+		SecureZeroMemory(candidates, block * used * sizeof(unsigned long long));
+		numbers += accepted * limbs;
+		count -= accepted;
+	} // End while(count > 0)
+}
+// End GenerateBelow<engine_type> [overload: bulk] function
+
+// Define a templated function to generate a number in the set { number | 0 ≤ number < bound }
+template<typename engine_type> void GenerateBelow(engine_type& rng, const unsigned long long* bound, size_t limbs, unsigned long long* number) {
+	GenerateBelow(rng, bound, limbs, number, 1);
+}
+// End GenerateBelow<engine_type> [overload: single] function
+#endif
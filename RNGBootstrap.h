@@ -0,0 +1,246 @@
+﻿// RNGBootstrap.h - This header declares the PoissonBootstrap class, and implements it, as well as defining the templated functions
+//		used for bootstrap resampling
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Resample indices are generated in bulk with FillBoundedRand (RNGBulk.h), which scales whole blocks of random numbers at once
+	instead of making one CustomRand call per index, and the values are then gathered in a separate tight loop.
+
+- BootstrapResample runs every resample on its own substream of the provided SeededRNGClass instance (substream b for resample b),
+	so the results are identical however many threads are used.
+
+- For data that arrives as a stream (or doesn't fit in memory), PoissonBootstrap uses the Poisson bootstrap: instead of drawing
+	indices, every observation gets an independent Poisson(1) weight in every resample, which approximates multinomial resampling
+	for large samples. Poisson(1) weights are generated by comparing one 64-bit random number against a table of the cumulative
+	probabilities, a branch-free loop over a handful of thresholds.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type (a SeededRNGClass<unsigned long long>
+	instance where stated)
+
+To gather the values at a list of indices
+ call BootstrapGather(values, indices, sample, count)
+	 values: const value_type*, the original data
+	 indices: const index_type*, the indices to gather
+	 sample: value_type*, the buffer to fill with the gathered values
+	 count: size_t, the number of values to gather
+   RETURN: void
+
+To evaluate a statistic on many resamples, in parallel
+ call BootstrapResample(rng, values, rows, resamples, statistic, results, threads)
+	 rng: SeededRNGClass<unsigned long long>, the generator whose substreams drive the resamples
+	 values: const value_type*, the original data
+	 rows: size_t, the number of values
+	 resamples: size_t, the number of resamples
+	 statistic: a callable taking (const value_type* sample, size_t rows) and returning a double. NOTE: Called concurrently
+		by different threads
+	 results: double*, the buffer to fill with the statistic of every resample
+	 threads: size_t, the number of threads to use. If 0 or omitted, it becomes the number of hardware threads
+   RETURN: void
+
+To calculate a percentile confidence interval from the statistics of the resamples
+ call BootstrapPercentileInterval(results, resamples, confidence, lower, upper)
+	 results: double*, the statistics of the resamples (reordered by the call)
+	 resamples: size_t, the number of resamples
+	 confidence: double, the confidence level (e.g. 0.95)
+	 lower, upper: double&, the bounds of the interval
+   RETURN: void
+
+To fill a buffer with Poisson(1) weights
+ call FillPoissonOneRand(rng, weights, count)
+	 weights: unsigned int*, the buffer to fill
+	 count: size_t, the number of weights to write
+   RETURN: void
+
+To create a streaming Poisson bootstrap of the mean
+  declare PoissonBootstrap identifier(rng, resamples)
+	rng: SeededRNGClass<unsigned long long>, the generator driving the weights
+	resamples: size_t, the number of resamples
+
+To add observations to every resample
+ Call bootstrap.Add(values, count)
+	 values: const double*, the observations
+	 count: size_t, the number of observations
+   RETURN: void
+
+To get the mean of every resample
+ Call bootstrap.Means(means)
+	 means: double*, the buffer to fill with resamples numbers
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGBOOTSTRAP_H
+#define RNGBOOTSTRAP_H
+
+// If necessary, include the header to allow vectors
+#ifndef _VECTOR_
+#include <vector>
+#endif
+// If necessary, include the header to allow threads
+#ifndef _THREAD_
+#include <thread>
+#endif
+// If necessary, include the header to allow partial sorting
+#ifndef _ALGORITHM_
+#include <algorithm>
+#endif
+// Include the header declaring SeededRNGClass, which provides the per-resample streams
+#include "SeededRNGClass.h"
+
+// Define the number of cumulative probabilities used for Poisson(1) weights. NOTE: P(weight ≥ 20) < 2^-60, far below the
+//		resolution of the 64-bit comparison
+inline constexpr size_t RNGPoissonOneLimit = 20;
+
+// Define a function to return the cumulative probabilities P(weight ≤ k) of Poisson(1), scaled to 64-bit thresholds
+inline const unsigned long long* RNGPoissonOneThresholds() {
+	// Calculate the table once, on first use. NOTE: Initialization of function statics is thread-safe
+	static const std::vector<unsigned long long> thresholds = []() {
+		std::vector<unsigned long long> table(RNGPoissonOneLimit);	// The table to return
+		double probability = std::exp(-1.0);						// The probability P(weight = k), starting at k = 0
+		double cumulative = 0;										// The probability P(weight ≤ k)
+		for (size_t k = 0; k < RNGPoissonOneLimit; k++) {
+			cumulative += probability;
+			probability /= (double)(k + 1);
+			table[k] = (cumulative >= 1) ? ~0ULL : (unsigned long long)(cumulative * 18446744073709551616.0);
+		} // End for(k)
+		return table;
+	}();
+	return thresholds.data();
+}
+// End RNGPoissonOneThresholds function
+
+// Define a templated function to gather the values at a list of indices
+template<typename value_type, typename index_type> void BootstrapGather(const value_type* values, const index_type* indices, value_type* sample, size_t count) {
+	// const value_type* values;	// The original data. Passed
+	// const index_type* indices;	// The indices to gather. Passed
+	// value_type* sample;			// The buffer to fill. Passed
+	// size_t count;				// The number of values to gather. Passed
+
+	// NOTE: A plain indexed loop, which the compiler turns into gather instructions where the target supports them
+	for (size_t i = 0; i < count; i++) { sample[i] = values[indices[i]]; }
+}
+// End BootstrapGather<value_type, index_type> function
+
+// Define a templated function to fill a buffer with Poisson(1) weights
+template<typename engine_type> void FillPoissonOneRand(engine_type& rng, unsigned int* weights, size_t count) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// unsigned int* weights;		// The buffer to fill. Passed
+	// size_t count;				// The number of weights to write. Passed
+	const unsigned long long* thresholds = RNGPoissonOneThresholds(); // The cumulative probabilities
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random bits currently being converted
+	size_t block;								// The number of weights converted from the current block
+
+	// Ensure that the provided generator is usable
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for FillPoissonOneRand must have a 64-bit result_type");
+
+	while (count > 0) {
+		block = (count < RNGBulkBlockSize) ? count : RNGBulkBlockSize;
+		rng.Fill(bits, block);
+
+		// The weight is the number of cumulative probabilities the random number reaches
+		for (size_t i = 0; i < block; i++) { weights[i] = 0; }
+		for (size_t k = 0; k < RNGPoissonOneLimit; k++) {
+			for (size_t i = 0; i < block; i++) { weights[i] += (unsigned int)(bits[i] >= thresholds[k]); }
+		} // End for(k)
+
+		weights += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End FillPoissonOneRand<engine_type> function
+
+// Define a templated function to evaluate a statistic on many resamples, one substream per resample, using multiple threads
+template<typename value_type, typename statistic_type> void BootstrapResample(const SeededRNGClass<unsigned long long>& rng, const value_type* values, size_t rows, size_t resamples, statistic_type statistic, double* results, size_t threads = 0) {
+	// const SeededRNGClass<unsigned long long>& rng;	// The generator whose substreams drive the resamples. Passed by reference
+	// const value_type* values;						// The original data. Passed
+	// size_t rows;										// The number of values. Passed
+	// size_t resamples;								// The number of resamples. Passed
+	// statistic_type statistic;						// The statistic to evaluate. Passed
+	// double* results;									// The buffer to fill with the statistics. Passed
+	// size_t threads;									// The number of threads to use. Passed. Hardware threads if 0 or omitted
+	std::vector<std::thread> workers;					// The threads evaluating the resamples
+
+	if (threads == 0) { threads = (std::max)(1u, std::thread::hardware_concurrency()); }
+	for (size_t t = 0; t < threads; t++) {
+		workers.emplace_back([=, &rng, &statistic]() {
+			std::vector<unsigned long long> indices(rows);	// The indices of the current resample
+			std::vector<value_type> sample(rows);			// The values of the current resample
+			for (size_t b = (size_t)RNGPartStart(resamples, t, threads); b < (size_t)RNGPartStart(resamples, t + 1, threads); b++) {
+				SeededRNGClass<unsigned long long> stream = rng.Substream(b); // The stream of the current resample
+				FillBoundedRand(stream, indices.data(), rows, rows);
+				BootstrapGather(values, indices.data(), sample.data(), rows);
+				results[b] = statistic((const value_type*)sample.data(), rows);
+			} // End for(b)
+		});
+	} // End for(t)
+
+	for (std::thread& worker : workers) { worker.join(); }
+}
+// End BootstrapResample<value_type, statistic_type> function
+
+// Define a function to calculate a percentile confidence interval from the statistics of the resamples
+inline void BootstrapPercentileInterval(double* results, size_t resamples, double confidence, double& lower, double& upper) {
+	// double* results;		// The statistics of the resamples (reordered by the call). Passed
+	// size_t resamples;	// The number of resamples. Passed
+	// double confidence;	// The confidence level. Passed
+	// double& lower;		// The lower bound of the interval. Passed by reference
+	// double& upper;		// The upper bound of the interval. Passed by reference
+	size_t low_rank;		// The rank of the lower bound among the statistics
+	size_t high_rank;		// The rank of the upper bound among the statistics
+
+	// Ensure that the parameters are valid
+	assert(("There must be at least one resample", resamples > 0));
+	assert(("The confidence level must be in the set (0, 1)", confidence > 0 && confidence < 1));
+
+	// Select the two ranks (mirrored, so the interval is symmetric) without fully sorting the statistics
+	low_rank = (size_t)((1 - confidence) / 2 * (double)(resamples - 1));
+	high_rank = resamples - 1 - low_rank;
+	std::nth_element(results, results + low_rank, results + resamples);
+	lower = results[low_rank];
+	std::nth_element(results + low_rank, results + high_rank, results + resamples);
+	upper = results[high_rank];
+}
+// End BootstrapPercentileInterval function
+
+class PoissonBootstrap {
+public:
+	// Define the constructor to start every resample empty
+	PoissonBootstrap(const SeededRNGClass<unsigned long long>& rng, size_t resamples) : stream(rng), sums(resamples, 0), totals(resamples, 0), weights(resamples) {}
+
+	// **** Define non-const methods ****
+
+	// Define a method to add observations to every resample, each with its own Poisson(1) weight per resample
+	void Add(const double* values, size_t count) {
+		// const double* values;	// The observations. Passed
+		// size_t count;			// The number of observations. Passed
+		size_t resamples = this->sums.size(); // The number of resamples
+
+		for (size_t i = 0; i < count; i++) {
+			FillPoissonOneRand(this->stream, this->weights.data(), resamples);
+			for (size_t b = 0; b < resamples; b++) {
+				this->sums[b] += this->weights[b] * values[i];
+				this->totals[b] += this->weights[b];
+			} // End for(b)
+		} // End for(i)
+	}
+	// End PoissonBootstrap::Add method
+
+	// **** Define const methods ****
+
+	// Define a method to return the (weighted) mean of every resample. NOTE: A resample with no weight yet has a mean of 0
+	void Means(double* means) const {
+		for (size_t b = 0; b < this->sums.size(); b++) { means[b] = (this->totals[b] > 0) ? this->sums[b] / (double)this->totals[b] : 0; }
+	}
+	// End PoissonBootstrap::Means method
+
+	// Define a method to return the number of resamples
+	size_t GetResamples() const { return this->sums.size(); }
+
+protected:
+	SeededRNGClass<unsigned long long> stream;	// The stream driving the weights
+	std::vector<double> sums;					// The weighted sum of the observations of every resample
+	std::vector<unsigned long long> totals;		// The total weight of every resample
+	std::vector<unsigned int> weights;			// The weights of the current observation
+}; // End class PoissonBootstrap
+#endif
@@ -0,0 +1,222 @@
+﻿// RNGBrownian.h - This header declares the BrownianBridge class, and (due to it being a class template) implements it, as well as
+//		defining the templated functions used to fill matrices of Brownian paths
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Paths are written row by row: path p occupies paths[p * steps] to paths[p * steps + steps - 1], and element i of a path is the
+	value of the process at the end of step i (the starting value 0 is not stored).
+
+- Every path is generated from its own substream of the provided SeededRNGClass instance (substream p for path p), so a path
+	only depends on the seed and its index. Ranges of paths can therefore be generated by different threads, in any order and
+	with any split, and the matrix will always be identical.
+
+- The increments are generated and summed one block at a time, so every block is accumulated while it is still in the cache.
+
+- The Brownian bridge builds a path from its end point inwards by bisection, so the first normal numbers decide the large scale
+	shape of the path. This concentrates the variance in the first dimensions, which is what makes quasi-random (e.g. Sobol) inputs
+	effective: pass their normal numbers to BrownianBridge::Build directly.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a SeededRNGClass<unsigned long long> instance, and floating_type is the type of
+	the path values (e.g. float, double)
+
+To fill a matrix with Brownian paths built from cumulative sums of increments
+ call FillBrownianPaths(rng, paths, first_path, path_count, steps, time_step, drift, volatility)
+	 paths: floating_type*, the buffer to fill, holding path_count * steps numbers
+	 first_path: size_t, the index of the first path to generate (selects the substreams used)
+	 path_count: size_t, the number of paths to generate
+	 steps: size_t, the number of steps of every path
+	 time_step: floating_type, the length of every step
+	 drift: floating_type, the drift per unit of time. If omitted, it becomes 0
+	 volatility: floating_type, the volatility per square root of unit of time. If omitted, it becomes 1
+   RETURN: void
+
+To create a Brownian bridge construction
+  declare BrownianBridge<floating_type> identifier(steps, time_step)
+	steps: size_t, the number of steps of every path
+	time_step: floating_type, the length of every step
+ ----------OR---------
+  declare BrownianBridge<floating_type> identifier(times, steps)
+	times: const floating_type*, the strictly increasing (and positive) times at the end of every step
+	steps: size_t, the number of steps of every path
+
+To build a path from standard normal numbers (e.g. from a quasi-random sequence)
+ Call bridge.Build(normals, path)
+	 normals: const floating_type*, the steps standard normal numbers, most important first
+	 path: floating_type*, the buffer to fill with the steps values of the path
+   RETURN: void
+
+To fill a matrix with Brownian paths built by the bridge
+ call FillBrownianBridgePaths(rng, bridge, paths, first_path, path_count, drift, volatility)
+	 (parameters as for FillBrownianPaths, with the steps and times taken from the bridge)
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGBROWNIAN_H
+#define RNGBROWNIAN_H
+
+// If necessary, include the header to allow vectors
+#ifndef _VECTOR_
+#include <vector>
+#endif
+// Include the header declaring SeededRNGClass, which provides the per-path streams
+#include "SeededRNGClass.h"
+
+// typename floating_type; // The type of the path values. Must be floating-point
+template <typename floating_type>
+class BrownianBridge {
+public:
+	// Ensure that the provided type is floating-point
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for BrownianBridge must be floating-point");
+
+	// Define the constructor for equally spaced steps
+	BrownianBridge(size_t steps, floating_type time_step) : times(steps) {
+		// size_t steps;				// The number of steps of every path. Passed
+		// floating_type time_step;		// The length of every step. Passed
+
+		for (size_t i = 0; i < steps; i++) { this->times[i] = time_step * (floating_type)(i + 1); }
+		this->Prepare();
+	}
+
+	// Define the constructor for arbitrary step times
+	BrownianBridge(const floating_type* times, size_t steps) : times(times, times + steps) { this->Prepare(); }
+
+	// **** Define const methods ****
+
+	// Define a method to build a path from standard normal numbers, most important first
+	void Build(const floating_type* normals, floating_type* path) const {
+		// const floating_type* normals;	// The standard normal numbers to build the path from. Passed
+		// floating_type* path;				// The buffer to fill with the values of the path. Passed
+		size_t steps = this->times.size();	// The number of steps of the path
+
+		if (steps == 0) { return; }
+
+		// Place the end point, then fill in every other point between its (already placed) neighbours
+		path[steps - 1] = this->deviations[0] * normals[0];
+		for (size_t i = 1; i < steps; i++) {
+			path[this->bridge_index[i]] = this->right_weights[i] * path[this->right_index[i]] + this->deviations[i] * normals[i];
+			if (this->left_index[i] > 0) { path[this->bridge_index[i]] += this->left_weights[i] * path[this->left_index[i] - 1]; }
+		} // End for(i)
+	}
+	// End BrownianBridge<floating_type>::Build method
+
+	// Define methods to return the number of steps and the time at the end of a step
+	size_t GetSteps() const { return this->times.size(); }
+	floating_type GetTime(size_t step) const { return this->times[step]; }
+
+protected:
+	// Define a method to calculate the order in which the points are placed and the weights used to place them
+	void Prepare() {
+		size_t steps = this->times.size();	// The number of steps of the path
+		std::vector<size_t> placed(steps);	// The order in which every point is placed (plus one, 0 if not placed yet)
+		size_t left = 0;					// The index of the first unplaced point of the current gap
+		size_t right;						// The index of the placed point ending the current gap
+		size_t middle;						// The index of the point placed in the middle of the current gap
+		floating_type left_time;			// The time of the placed point starting the current gap
+
+		this->left_index.assign(steps, 0);
+		this->right_index.assign(steps, 0);
+		this->bridge_index.assign(steps, 0);
+		this->left_weights.assign(steps, 0);
+		this->right_weights.assign(steps, 0);
+		this->deviations.assign(steps, 0);
+		if (steps == 0) { return; }
+
+		// The end point is placed first, from the starting value 0
+		placed[steps - 1] = 1;
+		this->bridge_index[0] = steps - 1;
+		this->deviations[0] = std::sqrt(this->times[steps - 1]);
+
+		// Sweep the gaps between placed points, halving each one, until every point is placed
+		for (size_t i = 1; i < steps; i++) {
+			while (placed[left]) { left++; }
+			right = left;
+			while (!placed[right]) { right++; }
+			middle = left + ((right - 1 - left) >> 1);
+			placed[middle] = i + 1;
+			this->bridge_index[i] = middle;
+			this->left_index[i] = left; // NOTE: Stored plus one, so that 0 denotes the starting value
+			this->right_index[i] = right;
+
+			// Interpolate between the neighbours, adding the conditional deviation of the bridge between them
+			left_time = (left > 0) ? this->times[left - 1] : 0;
+			this->left_weights[i] = (this->times[right] - this->times[middle]) / (this->times[right] - left_time);
+			this->right_weights[i] = (this->times[middle] - left_time) / (this->times[right] - left_time);
+			this->deviations[i] = std::sqrt((this->times[middle] - left_time) * (this->times[right] - this->times[middle]) / (this->times[right] - left_time));
+
+			// Move on to the next gap, wrapping around to the start once the last gap is halved
+			left = right + 1;
+			if (left >= steps) { left = 0; }
+		} // End for(i)
+	}
+	// End BrownianBridge<floating_type>::Prepare method
+
+	std::vector<floating_type> times;			// The time at the end of every step
+	std::vector<size_t> left_index;				// The index (plus one) of the left neighbour of every placed point
+	std::vector<size_t> right_index;			// The index of the right neighbour of every placed point
+	std::vector<size_t> bridge_index;			// The index of the point placed at every stage
+	std::vector<floating_type> left_weights;	// The weight of the left neighbour of every placed point
+	std::vector<floating_type> right_weights;	// The weight of the right neighbour of every placed point
+	std::vector<floating_type> deviations;		// The conditional standard deviation of every placed point
+}; // End class BrownianBridge
+
+// Define a templated function to fill a matrix with Brownian paths, each built from cumulative sums of its own normal increments
+template<typename floating_type> void FillBrownianPaths(const SeededRNGClass<unsigned long long>& rng, floating_type* paths, size_t first_path, size_t path_count, size_t steps, floating_type time_step, floating_type drift = 0, floating_type volatility = 1) {
+	// const SeededRNGClass<unsigned long long>& rng;	// The generator whose substreams drive the paths. Passed by reference
+	// floating_type* paths;							// The buffer to fill, one row per path. Passed
+	// size_t first_path;								// The index of the first path to generate. Passed
+	// size_t path_count;								// The number of paths to generate. Passed
+	// size_t steps;									// The number of steps of every path. Passed
+	// floating_type time_step;							// The length of every step. Passed
+	// floating_type drift;								// The drift per unit of time. Passed. 0 if omitted
+	// floating_type volatility;						// The volatility per square root of unit of time. Passed. 1 if omitted
+	floating_type mean = drift * time_step;							// The mean of every increment
+	floating_type deviation = volatility * std::sqrt(time_step);	// The standard deviation of every increment
+	floating_type level;											// The value of the path at the end of the previous step
+	floating_type* row;												// The row of the current path
+	size_t block;													// The number of steps generated in the current block
+
+	for (size_t p = 0; p < path_count; p++) {
+		SeededRNGClass<unsigned long long> stream = rng.Substream(first_path + p); // The stream of the current path
+		row = paths + p * steps;
+		level = 0;
+
+		// Generate the increments of a block, then sum them while they're still in the cache
+		for (size_t done = 0; done < steps; done += block) {
+			block = (steps - done < RNGBulkBlockSize) ? steps - done : RNGBulkBlockSize;
+			FillNormalRand(stream, row + done, block, mean, deviation);
+			for (size_t i = done; i < done + block; i++) {
+				level += row[i];
+				row[i] = level;
+			} // End for(i)
+		} // End for(done)
+	} // End for(p)
+}
+// End FillBrownianPaths<floating_type> function
+
+// Define a templated function to fill a matrix with Brownian paths, each built by the provided bridge from its own normal numbers
+template<typename floating_type> void FillBrownianBridgePaths(const SeededRNGClass<unsigned long long>& rng, const BrownianBridge<floating_type>& bridge, floating_type* paths, size_t first_path, size_t path_count, floating_type drift = 0, floating_type volatility = 1) {
+	// const SeededRNGClass<unsigned long long>& rng;	// The generator whose substreams drive the paths. Passed by reference
+	// const BrownianBridge<floating_type>& bridge;		// The bridge construction, holding the steps and their times. Passed by reference
+	// floating_type* paths;							// The buffer to fill, one row per path. Passed
+	// size_t first_path;								// The index of the first path to generate. Passed
+	// size_t path_count;								// The number of paths to generate. Passed
+	// floating_type drift;								// The drift per unit of time. Passed. 0 if omitted
+	// floating_type volatility;						// The volatility per square root of unit of time. Passed. 1 if omitted
+	size_t steps = bridge.GetSteps();					// The number of steps of every path
+	std::vector<floating_type> normals(steps);			// The normal numbers of the current path
+	floating_type* row;									// The row of the current path
+
+	for (size_t p = 0; p < path_count; p++) {
+		SeededRNGClass<unsigned long long> stream = rng.Substream(first_path + p); // The stream of the current path
+		row = paths + p * steps;
+
+		// Build the standard path, then scale it and add the drift in one vectorizable pass
+		FillNormalRand(stream, normals.data(), steps, (floating_type)0, (floating_type)1);
+		bridge.Build(normals.data(), row);
+		for (size_t i = 0; i < steps; i++) { row[i] = drift * bridge.GetTime(i) + volatility * row[i]; }
+	} // End for(p)
+}
+// End FillBrownianBridgePaths<floating_type> function
+#endif
@@ -0,0 +1,804 @@
+﻿// RNGBulk.h - This header defines the primitives shared by the bulk generation helpers (bit mixing, wide multiplication,
+//		conversion of raw bits to floating-point numbers and bounded integers) and the templated bulk fill functions built on them
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Every bulk function in this header accepts any generator with a result_type of 64 bits and a "Fill" method, which is the case
+	for both RNGClass<unsigned long long> and SeededRNGClass<unsigned long long>. Raw bits are pulled from the generator in blocks
+	of RNGBulkBlockSize numbers, so an RNGClass instance makes one OS call per block instead of one per number.
+
+- Unlike FloatingRand, the floating-point fills generate numbers in the half-open set [floor, roof), and the conversions are done
+	without std distributions so that the same bits always produce the same numbers regardless of the standard library used.
+
+- The conversion loops are kept free of branches and function calls other than <cmath> ones so that the compiler can vectorize them.
+	Every loop is compiled for several instruction sets (and the scaling and floating-point conversion are also written with AVX2
+	and AVX-512 intrinsics), and the widest one the machine supports is picked at run time (see RNGDispatch.h).
+
+- Where the compiler has 128-bit integers (RNG_HAS_INT128 is defined, which excludes MSVC), RNGUInt128 and RNGInt128 are usable as
+	result and cast types, with RNGIsIntegral, RNGIsUnsigned, RNGUnsignedOfT, RNGLowest and RNGHighest standing in for the std
+	traits (which only know the 128-bit integers in GNU language modes). FillRand128 works everywhere, for any 16-byte type.
+
+- The single-number primitives (RNGMix64, RNGMultiply128, RNGBitsToUnit, RNGBoundedRand and their 128-bit versions) are constexpr,
+	so they also work at compile time with a constexpr engine such as SeededRNGClass.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type
+
+To fill a buffer with uniform floating-point numbers
+ call FillFloatingRand(rng, numbers, count, floor, roof)
+	 numbers: floating_type*, the buffer to fill (e.g. float*, double*)
+	 count: size_t, the number of numbers to write
+	 floor: floating_type, the minimum possible number. If omitted, it becomes 0
+	 roof: floating_type, the upper bound of the numbers (excluded). If omitted, it becomes 1
+   RETURN: void
+
+To fill a buffer with normally distributed floating-point numbers
+ call FillNormalRand(rng, numbers, count, mean, deviation)
+	 numbers: floating_type*, the buffer to fill
+	 count: size_t, the number of numbers to write
+	 mean: floating_type, the mean of the distribution. If omitted, it becomes 0
+	 deviation: floating_type, the standard deviation of the distribution. If omitted, it becomes 1
+   RETURN: void
+
+To fill a buffer with uniform integers in the set { number ∈ unsigned long long | 0 ≤ number < range }
+ call FillBoundedRand(rng, numbers, count, range)
+	 numbers: integral_type*, the buffer to fill (e.g. unsigned int*, unsigned long long*)
+	 count: size_t, the number of numbers to write
+	 range: unsigned long long, the number of possible results. Must fit in integral_type
+   RETURN: void
+
+To fill a buffer with exponentially distributed floating-point numbers
+ call FillExponentialRand(rng, numbers, count, rate)
+	 numbers: floating_type*, the buffer to fill
+	 count: size_t, the number of numbers to write
+	 rate: floating_type, the rate of the distribution (the reciprocal of its mean). If omitted, it becomes 1
+   RETURN: void
+
+To fill a buffer with random 128-bit identifiers
+ call FillRand128(rng, identifiers, count)
+	 identifiers: identifier_type*, the buffer to fill (any trivially copyable 16-byte type, e.g. RNGUInt128, GUID)
+	 count: size_t, the number of identifiers to write
+   RETURN: void
+
+To generate a number in the set { number ∈ RNGUInt128 | 0 ≤ number < range } (only where RNG_HAS_INT128 is defined)
+ call RNGBoundedRand128(rng, range)
+	 rng: a generator with a 64-bit or 128-bit result_type
+	 range: RNGUInt128, the number of possible results. 0 denotes every 128-bit number
+   RETURN: RNGUInt128
+*/
+
+// Include guard
+#ifndef RNGBULK_H
+#define RNGBULK_H
+
+// If necessary, include the header to define limits of integral types
+#ifndef _LIMITS_
+#include <limits>
+#endif
+// If necessary, include the header to allow mathematical functions
+#ifndef _CMATH_
+#include <cmath>
+#endif
+// If necessary, include the header to allow copying memory
+#ifndef _CSTRING_
+#include <cstring>
+#endif
+// If necessary, include the header to allow type traits
+#ifndef _TYPE_TRAITS_
+#include <type_traits>
+#endif
+// If necessary, include the header to allow the intrinsic used for 64x64 bit multiplication on MSVC
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(_INC_INTRIN)
+#include <intrin.h>
+#endif
+// Include the header to allow run-time assertions. NOTE: assert.h does not contain an include guard, but due to only containing
+//		a forward declaration and a macro there are no side effects of multiple inclusions
+#include <assert.h>
+// Include the header selecting the instruction set of the bulk kernels
+#include "RNGDispatch.h"
+
+// Define the number of 64-bit numbers pulled from a generator at a time by the bulk functions (4KiB of stack per buffer)
+inline constexpr size_t RNGBulkBlockSize = 512;
+
+// Define the constant 2π used by the Box-Muller transform
+inline constexpr double RNGTwoPi = 6.283185307179586476925286766559;
+
+// If the compiler provides 128-bit integers (GCC and Clang on 64-bit targets, but not MSVC), define aliases for them, which enables
+//		them as result and cast types. NOTE: __extension__ keeps pedantic builds quiet about the non-standard type
+#if defined(__SIZEOF_INT128__)
+#define RNG_HAS_INT128 1
+__extension__ typedef unsigned __int128 RNGUInt128;
+__extension__ typedef __int128 RNGInt128;
+#endif
+
+// Define a templated constant for whether or not a type is a 128-bit integer
+template<typename integral_type> inline constexpr bool RNGIsWide = false;
+#ifdef RNG_HAS_INT128
+template<> inline constexpr bool RNGIsWide<RNGUInt128> = true;
+template<> inline constexpr bool RNGIsWide<RNGInt128> = true;
+#endif
+
+// Define templated constants extending std::is_integral and std::is_unsigned to the 128-bit integers, which the std traits only
+//		recognise in GNU language modes
+template<typename integral_type> inline constexpr bool RNGIsIntegral = std::is_integral_v<integral_type> || RNGIsWide<integral_type>;
+template<typename integral_type> inline constexpr bool RNGIsUnsigned = std::is_unsigned_v<integral_type>;
+#ifdef RNG_HAS_INT128
+template<> inline constexpr bool RNGIsUnsigned<RNGUInt128> = true;
+#endif
+
+// Define a templated struct extending std::make_unsigned to the 128-bit integers
+template<typename integral_type> struct RNGUnsignedOf { typedef std::make_unsigned_t<integral_type> type; };
+#ifdef RNG_HAS_INT128
+template<> struct RNGUnsignedOf<RNGUInt128> { typedef RNGUInt128 type; };
+template<> struct RNGUnsignedOf<RNGInt128> { typedef RNGUInt128 type; };
+#endif
+template<typename integral_type> using RNGUnsignedOfT = typename RNGUnsignedOf<integral_type>::type;
+
+// Define a templated function to return the largest number of an integral type (including the 128-bit integers)
+template<typename integral_type> constexpr integral_type RNGHighest() {
+	typedef RNGUnsignedOfT<integral_type> unsigned_type; // The unsigned type of the same width
+	return (integral_type)((unsigned_type)~(unsigned_type)0 >> (RNGIsUnsigned<integral_type> ? 0 : 1));
+}
+// End RNGHighest<integral_type> function
+
+// Define a templated function to return the lowest number of an integral type (including the 128-bit integers)
+template<typename integral_type> constexpr integral_type RNGLowest() {
+	if constexpr (RNGIsUnsigned<integral_type>) { return 0; }
+	else { return (integral_type)(-RNGHighest<integral_type>() - 1); }
+}
+// End RNGLowest<integral_type> function
+
+// Define a function to scramble the bits of a 64-bit number (the finalizer of SplitMix64). Every input maps to a different output
+constexpr unsigned long long RNGMix64(unsigned long long bits) {
+	// unsigned long long bits; // The number to scramble. Passed
+
+	bits = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EBULL;
+	return bits ^ (bits >> 31);
+}
+// End RNGMix64 function
+
+// Define a function to multiply two 64-bit numbers, returning the upper 64 bits of the product and storing the lower 64 bits.
+//		NOTE: Usable in constant expressions (MSVC's intrinsic is only used at run time)
+constexpr unsigned long long RNGMultiply128(unsigned long long a, unsigned long long b, unsigned long long& low) {
+	// unsigned long long a;	// The first factor. Passed
+	// unsigned long long b;	// The second factor. Passed
+	// unsigned long long& low;	// The lower 64 bits of the product. Passed by reference
+#if defined(_MSC_VER) && defined(_M_X64) // MSVC has no 128-bit type, but exposes the instruction directly
+	if (!__builtin_is_constant_evaluated()) {
+		unsigned long long high = 0; // The upper 64 bits of the product
+		low = _umul128(a, b, &high);
+		return high;
+	} // End if(!__builtin_is_constant_evaluated())
+#endif
+#if defined(RNG_HAS_INT128)
+	RNGUInt128 product = (RNGUInt128)a * b; // The full product
+	low = (unsigned long long)product;
+	return (unsigned long long)(product >> 64);
+#else // Fall back on schoolbook multiplication of 32-bit halves (also MSVC's constant evaluation)
+	unsigned long long a_low = a & 0xFFFFFFFFULL, a_high = a >> 32;		// The halves of the first factor
+	unsigned long long b_low = b & 0xFFFFFFFFULL, b_high = b >> 32;		// The halves of the second factor
+	unsigned long long cross = (a_low * b_low >> 32) + (a_high * b_low & 0xFFFFFFFFULL) + a_low * b_high; // The middle column
+	low = a * b;
+	return a_high * b_high + (a_high * b_low >> 32) + (cross >> 32);
+#endif
+}
+// End RNGMultiply128 function
+
+#ifdef RNG_HAS_INT128
+// Define a function to multiply two 128-bit numbers, returning the upper 128 bits of the product and storing the lower 128 bits
+constexpr RNGUInt128 RNGMultiply256(RNGUInt128 a, RNGUInt128 b, RNGUInt128& low) {
+	// RNGUInt128 a;	// The first factor. Passed
+	// RNGUInt128 b;	// The second factor. Passed
+	// RNGUInt128& low;	// The lower 128 bits of the product. Passed by reference
+	RNGUInt128 a_low = (unsigned long long)a, a_high = a >> 64;		// The halves of the first factor
+	RNGUInt128 b_low = (unsigned long long)b, b_high = b >> 64;		// The halves of the second factor
+	RNGUInt128 low_high = a_low * b_high;							// The first cross product
+	RNGUInt128 high_low = a_high * b_low;							// The second cross product
+	RNGUInt128 bottom = a_low * b_low;								// The product of the lower halves
+	RNGUInt128 middle = (bottom >> 64) + (unsigned long long)low_high + (unsigned long long)high_low; // The middle column
+
+	low = (middle << 64) | (unsigned long long)bottom;
+	return a_high * b_high + (low_high >> 64) + (high_low >> 64) + (middle >> 64);
+}
+// End RNGMultiply256 function
+#endif
+
+// Define a templated function to convert 64 random bits to a floating-point number in the set { number | 0 ≤ number < 1 }, using
+//		only as many bits as the mantissa of the type can hold so that every result is equally likely
+template<typename floating_type> constexpr floating_type RNGBitsToUnit(unsigned long long bits) {
+	// unsigned long long bits; // The random bits to convert. Passed
+	constexpr int digits = (std::numeric_limits<floating_type>::digits < 64) ? std::numeric_limits<floating_type>::digits : 64;
+	constexpr floating_type scale = (floating_type)1 / (floating_type)(1ULL << (digits - 1)) / 2; // 2^-digits
+
+	// Ensure that the provided type is floating-point
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for RNGBitsToUnit must be floating-point");
+
+	return (floating_type)(bits >> (64 - digits)) * scale;
+}
+// End RNGBitsToUnit<floating_type> function
+
+// Define a templated function to convert 64 random bits to a floating-point number in the set { number | 0 < number ≤ 1 }, for use
+//		where the result is passed to a logarithm or divided by
+template<typename floating_type> constexpr floating_type RNGBitsToOpenUnit(unsigned long long bits) {
+	// unsigned long long bits; // The random bits to convert. Passed
+	constexpr int digits = (std::numeric_limits<floating_type>::digits < 64) ? std::numeric_limits<floating_type>::digits : 64;
+	constexpr floating_type scale = (floating_type)1 / (floating_type)(1ULL << (digits - 1)) / 2; // 2^-digits
+
+	return (floating_type)((bits >> (64 - digits)) + 1) * scale;
+}
+// End RNGBitsToOpenUnit<floating_type> function
+
+// Define a templated function to generate a number in the set { number ∈ unsigned long long | 0 ≤ number < range } from a
+//		generator with a 64-bit result_type, using Lemire's multiply-and-reject method (almost never needs a division)
+template<typename engine_type> constexpr unsigned long long RNGBoundedRand(engine_type& rng, unsigned long long range) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// unsigned long long range;	// The number of possible results (0 means the whole 64-bit range). Passed
+	unsigned long long low = 0;			// The lower 64 bits of the scaled number
+	unsigned long long high = 0;		// The upper 64 bits of the scaled number, which is the result
+	unsigned long long threshold = 0;	// The lower bits below which the result is biased and must be rejected
+
+	// A range of 0 denotes every 64-bit number
+	if (range == 0) { return rng(); }
+
+	// Scale a random number up to the range, only calculating the rejection threshold in the rare case it might be needed
+	high = RNGMultiply128(rng(), range, low);
+	if (low < range) {
+		threshold = (0 - range) % range;
+		while (low < threshold) { high = RNGMultiply128(rng(), range, low); }
+	} // End if(low < range)
+
+	return high;
+}
+// End RNGBoundedRand<engine_type> function
+
+#ifdef RNG_HAS_INT128
+// Define a templated function to pull 128 random bits from a generator with a 64-bit or 128-bit result_type
+template<typename engine_type> constexpr RNGUInt128 RNGDraw128(engine_type& rng) {
+	// engine_type& rng; // The generator to pull bits from. Passed by reference
+	static_assert(sizeof(typename engine_type::result_type) == 8 || sizeof(typename engine_type::result_type) == 16, "The generator provided for RNGDraw128 must have a 64-bit or 128-bit result_type");
+
+	if constexpr (sizeof(typename engine_type::result_type) == 16) { return rng(); }
+	else {
+		RNGUInt128 high = rng(); // The upper 64 bits, drawn first
+		return (high << 64) | rng();
+	}
+}
+// End RNGDraw128<engine_type> function
+
+// Define a templated function to generate a number in the set { number ∈ RNGUInt128 | 0 ≤ number < range }, using Lemire's method
+//		with a 128x128 bit multiplication
+template<typename engine_type> constexpr RNGUInt128 RNGBoundedRand128(engine_type& rng, RNGUInt128 range) {
+	// engine_type& rng;	// The generator to pull bits from. Passed by reference
+	// RNGUInt128 range;	// The number of possible results (0 means the whole 128-bit range). Passed
+	RNGUInt128 low = 0;			// The lower 128 bits of the scaled number
+	RNGUInt128 high = 0;		// The upper 128 bits of the scaled number, which is the result
+	RNGUInt128 threshold = 0;	// The lower bits below which the result is biased and must be rejected
+
+	// A range of 0 denotes every 128-bit number
+	if (range == 0) { return RNGDraw128(rng); }
+
+	high = RNGMultiply256(RNGDraw128(rng), range, low);
+	if (low < range) {
+		threshold = (0 - range) % range;
+		while (low < threshold) { high = RNGMultiply256(RNGDraw128(rng), range, low); }
+	} // End if(low < range)
+
+	return high;
+}
+// End RNGBoundedRand128<engine_type> function
+#endif
+
+// Define a function to split a range of work into parts, returning the first item of the provided part
+inline unsigned long long RNGPartStart(unsigned long long total, size_t part, size_t parts) {
+	// unsigned long long total;	// The number of items in the range. Passed
+	// size_t part;					// The index of the part. Passed
+	// size_t parts;				// The number of parts. Passed
+
+	// NOTE: The first (total % parts) parts get one extra item, which avoids multiplying total by part (which could overflow)
+	return (total / parts) * part + ((part < total % parts) ? part : total % parts);
+}
+// End RNGPartStart function
+
+// **** Define the bulk kernels, which convert blocks of random bits in place of the loops of the fill functions ****
+
+// Define a templated loop to scale a block of random bits into numbers in the set { number | 0 ≤ number < range }, replacing the
+//		bits with the lower halves of the products and returning non-zero if any number might be biased. NOTE: Like the other
+//		loops, it is inlined in every variant so that it is compiled (and vectorized) for the variant's instruction set
+template<typename integral_type> RNG_FORCE_INLINE unsigned long long RNGScaleLoop(unsigned long long* bits, integral_type* numbers, size_t count, unsigned long long range) {
+	// unsigned long long* bits;	// The random bits, replaced with the lower halves. Passed
+	// integral_type* numbers;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to scale. Passed
+	// unsigned long long range;	// The number of possible results. Passed
+	unsigned long long low = 0;		// The lower 64 bits of the current scaled number
+	unsigned long long suspect = 0;	// Non-zero if any number might be biased
+
+	for (size_t i = 0; i < count; i++) {
+		numbers[i] = (integral_type)RNGMultiply128(bits[i], range, low);
+		bits[i] = low;
+		suspect |= (unsigned long long)(low < range);
+	} // End for(i)
+	return suspect;
+}
+// End RNGScaleLoop<integral_type> function
+
+// Define a templated loop to convert a block of random bits to floating-point numbers in the set { number | floor ≤ number < floor + span }
+template<typename floating_type> RNG_FORCE_INLINE void RNGUnitLoop(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type floor, floating_type span) {
+	RNG_NO_CONTRACT_SCOPE
+	// const unsigned long long* bits;	// The random bits. Passed
+	// floating_type* numbers;			// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert. Passed
+	// floating_type floor;				// The minimum possible number. Passed
+	// floating_type span;				// The width of the range. Passed
+
+	for (size_t i = 0; i < count; i++) { numbers[i] = floor + span * RNGBitsToUnit<floating_type>(bits[i]); }
+}
+// End RNGUnitLoop<floating_type> function
+
+// Define a templated loop to convert a block of random bits (an even number) to normally distributed numbers with the
+//		Box-Muller transform
+template<typename floating_type> RNG_FORCE_INLINE void RNGNormalLoop(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type mean, floating_type deviation) {
+	RNG_NO_CONTRACT_SCOPE
+	// const unsigned long long* bits;	// The random bits, two words per pair. Passed
+	// floating_type* numbers;			// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert (even). Passed
+	// floating_type mean;				// The mean of the distribution. Passed
+	// floating_type deviation;			// The standard deviation of the distribution. Passed
+	floating_type radius = 0;			// The radius of the current pair
+	floating_type angle = 0;			// The angle of the current pair
+
+	for (size_t i = 0; i < count; i += 2) {
+		radius = deviation * std::sqrt(-2 * std::log(RNGBitsToOpenUnit<floating_type>(bits[i])));
+		angle = (floating_type)RNGTwoPi * RNGBitsToUnit<floating_type>(bits[i + 1]);
+		numbers[i] = mean + radius * std::cos(angle);
+		numbers[i + 1] = mean + radius * std::sin(angle);
+	} // End for(i)
+}
+// End RNGNormalLoop<floating_type> function
+
+// Define a templated loop to convert a block of random bits to exponentially distributed numbers by inversion
+template<typename floating_type> RNG_FORCE_INLINE void RNGExponentialLoop(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type scale) {
+	RNG_NO_CONTRACT_SCOPE
+	// const unsigned long long* bits;	// The random bits. Passed
+	// floating_type* numbers;			// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert. Passed
+	// floating_type scale;				// The negated mean of the distribution. Passed
+
+	for (size_t i = 0; i < count; i++) { numbers[i] = scale * std::log(RNGBitsToOpenUnit<floating_type>(bits[i])); }
+}
+// End RNGExponentialLoop<floating_type> function
+
+#ifdef RNG_HAS_DISPATCH
+// Define a templated struct holding the loops compiled for a variant's instruction set, specialized for every variant below
+template<RNGKernel kernel> struct RNGKernelLoops;
+
+// Define a macro to specialize RNGKernelLoops for a variant, compiling every loop for the provided instruction set
+#define RNG_DEFINE_KERNEL_LOOPS(kernel, instruction_set) \
+template<> struct RNGKernelLoops<kernel> { \
+	template<typename integral_type> RNG_TARGET(instruction_set) static unsigned long long Scale(unsigned long long* bits, integral_type* numbers, size_t count, unsigned long long range) { return RNGScaleLoop(bits, numbers, count, range); } \
+	template<typename floating_type> RNG_TARGET(instruction_set) static void Unit(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type floor, floating_type span) { RNGUnitLoop(bits, numbers, count, floor, span); } \
+	template<typename floating_type> RNG_TARGET(instruction_set) static void Normal(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type mean, floating_type deviation) { RNGNormalLoop(bits, numbers, count, mean, deviation); } \
+	template<typename floating_type> RNG_TARGET(instruction_set) static void Exponential(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type scale) { RNGExponentialLoop(bits, numbers, count, scale); } \
+};
+RNG_DEFINE_KERNEL_LOOPS(RNG_KERNEL_SSE42, "sse4.2")
+RNG_DEFINE_KERNEL_LOOPS(RNG_KERNEL_AVX2, "avx2")
+RNG_DEFINE_KERNEL_LOOPS(RNG_KERNEL_AVX512, "avx512f,avx512dq")
+#undef RNG_DEFINE_KERNEL_LOOPS
+
+// Define a function to scale a block of random bits with AVX2, 4 numbers at a time. NOTE: There is no 64x64 bit multiplication
+//		in AVX2, so the products are built from 32x32 bit ones exactly as RNGMultiply128 does without 128-bit integers, and the
+//		unsigned comparison is done as a signed one with flipped sign bits
+RNG_TARGET("avx2") inline unsigned long long RNGScaleAVX2(unsigned long long* bits, unsigned long long* numbers, size_t count, unsigned long long range) {
+	// unsigned long long* bits;	// The random bits, replaced with the lower halves. Passed
+	// unsigned long long* numbers;	// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to scale. Passed
+	// unsigned long long range;	// The number of possible results. Passed
+	const __m256i half = _mm256_set1_epi64x(0xFFFFFFFFLL);					// The mask of the lower 32 bits
+	const __m256i sign = _mm256_set1_epi64x((long long)0x8000000000000000ULL);	// The sign bits
+	const __m256i b = _mm256_set1_epi64x((long long)range);				// The range (its lower half is used by the multiplications)
+	const __m256i b_high = _mm256_srli_epi64(b, 32);						// The upper half of the range
+	const __m256i b_signed = _mm256_xor_si256(b, sign);						// The range with a flipped sign bit
+	__m256i suspect = _mm256_setzero_si256();								// Non-zero lanes if any number might be biased
+	size_t i = 0;															// The position of the current vector
+
+	for (; i + 4 <= count; i += 4) {
+		__m256i a = _mm256_loadu_si256((const __m256i*)(bits + i));	// The random bits
+		__m256i a_high = _mm256_srli_epi64(a, 32);						// The upper halves of the random bits
+		__m256i low_low = _mm256_mul_epu32(a, b);						// The products of the partial numbers
+		__m256i low_high = _mm256_mul_epu32(a, b_high);
+		__m256i high_low = _mm256_mul_epu32(a_high, b);
+		__m256i high_high = _mm256_mul_epu32(a_high, b_high);
+		__m256i cross = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(low_low, 32), _mm256_and_si256(high_low, half)), low_high); // The middle column
+		__m256i low = _mm256_or_si256(_mm256_slli_epi64(cross, 32), _mm256_and_si256(low_low, half));	// The lower halves of the products
+
+		_mm256_storeu_si256((__m256i*)(numbers + i), _mm256_add_epi64(_mm256_add_epi64(high_high, _mm256_srli_epi64(high_low, 32)), _mm256_srli_epi64(cross, 32)));
+		_mm256_storeu_si256((__m256i*)(bits + i), low);
+		suspect = _mm256_or_si256(suspect, _mm256_cmpgt_epi64(b_signed, _mm256_xor_si256(low, sign)));
+	} // End for(; i + 4 <= count; i += 4)
+
+	return (unsigned long long)!_mm256_testz_si256(suspect, suspect) | RNGScaleLoop(bits + i, numbers + i, count - i, range);
+}
+// End RNGScaleAVX2 function
+
+// The AVX-512 intrinsics of GCC 12 pass an undefined vector as the unused source of the unmasked forms, which -Wall reports as
+//		uninitialized once they are inlined, so these warnings are turned off around the AVX-512 kernels
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// Define a function to scale a block of random bits with AVX-512, 8 numbers at a time (see RNGScaleAVX2)
+RNG_TARGET("avx512f,avx512dq") inline unsigned long long RNGScaleAVX512(unsigned long long* bits, unsigned long long* numbers, size_t count, unsigned long long range) {
+	// unsigned long long* bits;	// The random bits, replaced with the lower halves. Passed
+	// unsigned long long* numbers;	// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to scale. Passed
+	// unsigned long long range;	// The number of possible results. Passed
+	const __m512i half = _mm512_set1_epi64(0xFFFFFFFFLL);	// The mask of the lower 32 bits
+	const __m512i b = _mm512_set1_epi64((long long)range);	// The range (its lower half is used by the multiplications)
+	const __m512i b_high = _mm512_set1_epi64((long long)(range >> 32)); // The upper half of the range
+	__mmask8 suspect = 0;									// Non-zero bits if any number might be biased
+	size_t i = 0;											// The position of the current vector
+
+	for (; i + 8 <= count; i += 8) {
+		__m512i a = _mm512_loadu_si512((const void*)(bits + i));	// The random bits
+		__m512i a_high = _mm512_srli_epi64(a, 32);					// The upper halves of the random bits
+		__m512i low_low = _mm512_mul_epu32(a, b);					// The products of the partial numbers
+		__m512i low_high = _mm512_mul_epu32(a, b_high);
+		__m512i high_low = _mm512_mul_epu32(a_high, b);
+		__m512i high_high = _mm512_mul_epu32(a_high, b_high);
+		__m512i cross = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(low_low, 32), _mm512_and_si512(high_low, half)), low_high); // The middle column
+		__m512i low = _mm512_or_si512(_mm512_slli_epi64(cross, 32), _mm512_and_si512(low_low, half));	// The lower halves of the products
+
+		_mm512_storeu_si512((void*)(numbers + i), _mm512_add_epi64(_mm512_add_epi64(high_high, _mm512_srli_epi64(high_low, 32)), _mm512_srli_epi64(cross, 32)));
+		_mm512_storeu_si512((void*)(bits + i), low);
+		suspect |= _mm512_cmplt_epu64_mask(low, b);
+	} // End for(; i + 8 <= count; i += 8)
+
+	return (unsigned long long)(suspect != 0) | RNGScaleLoop(bits + i, numbers + i, count - i, range);
+}
+// End RNGScaleAVX512 function
+
+// Define a function to convert a block of random bits to doubles with AVX2, 4 numbers at a time. NOTE: There is no 64-bit integer
+//		conversion in AVX2, so the 53 bits are split in halves, each placed in the mantissa of a power of two that is then
+//		subtracted, which is exact
+RNG_TARGET("avx2") inline void RNGUnitAVX2(const unsigned long long* bits, double* numbers, size_t count, double floor, double span) {
+	// const unsigned long long* bits;	// The random bits. Passed
+	// double* numbers;					// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert. Passed
+	// double floor;					// The minimum possible number. Passed
+	// double span;						// The width of the range. Passed
+	const __m256i half = _mm256_set1_epi64x(0xFFFFFFFFLL);					// The mask of the lower 32 bits
+	const __m256i exponent_low = _mm256_set1_epi64x(0x4330000000000000LL);	// The bits of 2^52
+	const __m256i exponent_high = _mm256_set1_epi64x(0x4530000000000000LL);	// The bits of 2^84
+	const __m256d offset_low = _mm256_set1_pd(4503599627370496.0);			// 2^52
+	const __m256d offset_high = _mm256_set1_pd(19342813113834066795298816.0);	// 2^84
+	const __m256d scale = _mm256_set1_pd(RNGBitsToUnit<double>(1ULL << 11));	// 2^-53
+	const __m256d floors = _mm256_set1_pd(floor);							// The minimum possible number
+	const __m256d spans = _mm256_set1_pd(span);								// The width of the range
+	size_t i = 0;															// The position of the current vector
+
+	for (; i + 4 <= count; i += 4) {
+		__m256i x = _mm256_srli_epi64(_mm256_loadu_si256((const __m256i*)(bits + i)), 11);	// The 53 bits used
+		__m256d low = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(x, half), exponent_low)), offset_low);		// The lower half
+		__m256d high = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(x, 32), exponent_high)), offset_high);	// The upper half, times 2^32
+		_mm256_storeu_pd(numbers + i, _mm256_add_pd(floors, _mm256_mul_pd(spans, _mm256_mul_pd(_mm256_add_pd(high, low), scale))));
+	} // End for(; i + 4 <= count; i += 4)
+
+	RNGUnitLoop(bits + i, numbers + i, count - i, floor, span);
+}
+// End RNGUnitAVX2 [overload: double] function
+
+// Define an overload of RNGUnitAVX2 to convert to floats, whose 24 bits are converted as 32-bit integers
+RNG_TARGET("avx2") inline void RNGUnitAVX2(const unsigned long long* bits, float* numbers, size_t count, float floor, float span) {
+	// const unsigned long long* bits;	// The random bits. Passed
+	// float* numbers;					// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert. Passed
+	// float floor;						// The minimum possible number. Passed
+	// float span;						// The width of the range. Passed
+	const __m256i lower = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);	// The positions of the lower halves of the words
+	const __m128 scale = _mm_set1_ps(RNGBitsToUnit<float>(1ULL << 40));	// 2^-24
+	const __m128 floors = _mm_set1_ps(floor);							// The minimum possible number
+	const __m128 spans = _mm_set1_ps(span);								// The width of the range
+	size_t i = 0;														// The position of the current vector
+
+	for (; i + 4 <= count; i += 4) {
+		__m256i x = _mm256_srli_epi64(_mm256_loadu_si256((const __m256i*)(bits + i)), 40);				// The 24 bits used
+		__m128 unit = _mm_mul_ps(_mm_cvtepi32_ps(_mm256_castsi256_si128(_mm256_permutevar8x32_epi32(x, lower))), scale);	// The numbers in [0, 1)
+		_mm_storeu_ps(numbers + i, _mm_add_ps(floors, _mm_mul_ps(spans, unit)));
+	} // End for(; i + 4 <= count; i += 4)
+
+	RNGUnitLoop(bits + i, numbers + i, count - i, floor, span);
+}
+// End RNGUnitAVX2 [overload: float] function
+
+// Define a function to convert a block of random bits to doubles with AVX-512, 8 numbers at a time
+RNG_TARGET("avx512f,avx512dq") inline void RNGUnitAVX512(const unsigned long long* bits, double* numbers, size_t count, double floor, double span) {
+	// const unsigned long long* bits;	// The random bits. Passed
+	// double* numbers;					// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert. Passed
+	// double floor;					// The minimum possible number. Passed
+	// double span;						// The width of the range. Passed
+	const __m512d scale = _mm512_set1_pd(RNGBitsToUnit<double>(1ULL << 11));	// 2^-53
+	const __m512d floors = _mm512_set1_pd(floor);								// The minimum possible number
+	const __m512d spans = _mm512_set1_pd(span);									// The width of the range
+	size_t i = 0;																// The position of the current vector
+
+	for (; i + 8 <= count; i += 8) {
+		__m512d unit = _mm512_mul_pd(_mm512_cvtepu64_pd(_mm512_srli_epi64(_mm512_loadu_si512((const void*)(bits + i)), 11)), scale); // The numbers in [0, 1)
+		_mm512_storeu_pd(numbers + i, _mm512_add_pd(floors, _mm512_mul_pd(spans, unit)));
+	} // End for(; i + 8 <= count; i += 8)
+
+	RNGUnitLoop(bits + i, numbers + i, count - i, floor, span);
+}
+// End RNGUnitAVX512 [overload: double] function
+
+// Define an overload of RNGUnitAVX512 to convert to floats
+RNG_TARGET("avx512f,avx512dq") inline void RNGUnitAVX512(const unsigned long long* bits, float* numbers, size_t count, float floor, float span) {
+	// const unsigned long long* bits;	// The random bits. Passed
+	// float* numbers;					// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert. Passed
+	// float floor;						// The minimum possible number. Passed
+	// float span;						// The width of the range. Passed
+	const __m256 scale = _mm256_set1_ps(RNGBitsToUnit<float>(1ULL << 40));	// 2^-24
+	const __m256 floors = _mm256_set1_ps(floor);							// The minimum possible number
+	const __m256 spans = _mm256_set1_ps(span);								// The width of the range
+	size_t i = 0;															// The position of the current vector
+
+	for (; i + 8 <= count; i += 8) {
+		__m256 unit = _mm256_mul_ps(_mm512_cvtepi64_ps(_mm512_srli_epi64(_mm512_loadu_si512((const void*)(bits + i)), 40)), scale); // The numbers in [0, 1)
+		_mm256_storeu_ps(numbers + i, _mm256_add_ps(floors, _mm256_mul_ps(spans, unit)));
+	} // End for(; i + 8 <= count; i += 8)
+
+	RNGUnitLoop(bits + i, numbers + i, count - i, floor, span);
+}
+// End RNGUnitAVX512 [overload: float] function
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+// Define a templated function to scale a block of random bits with the selected variant (see RNGScaleLoop)
+template<typename integral_type> unsigned long long RNGScaleBlock(unsigned long long* bits, integral_type* numbers, size_t count, unsigned long long range) {
+	// unsigned long long* bits;	// The random bits, replaced with the lower halves. Passed
+	// integral_type* numbers;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to scale (at most RNGBulkBlockSize). Passed
+	// unsigned long long range;	// The number of possible results. Passed
+#ifdef RNG_HAS_DISPATCH
+	RNGKernel kernel = RNGSelectedKernel();	// The variant to use
+	unsigned long long suspect = 0;			// Non-zero if any number might be biased
+
+	if (kernel >= RNG_KERNEL_AVX2) {
+		// The vector kernels produce 64-bit numbers, which are narrowed afterwards if necessary
+		unsigned long long wide[RNGBulkBlockSize]; // The 64-bit numbers (only for narrower types)
+		unsigned long long* scaled = (sizeof(integral_type) == 8) ? (unsigned long long*)numbers : wide; // The buffer of the 64-bit numbers
+
+		suspect = (kernel == RNG_KERNEL_AVX512) ? RNGScaleAVX512(bits, scaled, count, range) : RNGScaleAVX2(bits, scaled, count, range);
+		if constexpr (sizeof(integral_type) != 8) { for (size_t i = 0; i < count; i++) { numbers[i] = (integral_type)wide[i]; } }
+		return suspect;
+	} // End if(kernel >= RNG_KERNEL_AVX2)
+	if (kernel == RNG_KERNEL_SSE42) { return RNGKernelLoops<RNG_KERNEL_SSE42>::Scale(bits, numbers, count, range); }
+#endif
+	return RNGScaleLoop(bits, numbers, count, range);
+}
+// End RNGScaleBlock<integral_type> function
+
+// Define a templated function to convert a block of random bits to floating-point numbers with the selected variant
+template<typename floating_type> void RNGUnitBlock(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type floor, floating_type span) {
+	// const unsigned long long* bits;	// The random bits. Passed
+	// floating_type* numbers;			// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert. Passed
+	// floating_type floor;				// The minimum possible number. Passed
+	// floating_type span;				// The width of the range. Passed
+#ifdef RNG_HAS_DISPATCH
+	constexpr bool vector = std::is_same_v<floating_type, double> || std::is_same_v<floating_type, float>; // Whether or not the vector kernels handle the type
+
+	switch (RNGSelectedKernel()) {
+	case RNG_KERNEL_AVX512:
+		if constexpr (vector) { RNGUnitAVX512(bits, numbers, count, floor, span); }
+		else { RNGKernelLoops<RNG_KERNEL_AVX512>::Unit(bits, numbers, count, floor, span); }
+		return;
+	case RNG_KERNEL_AVX2:
+		if constexpr (vector) { RNGUnitAVX2(bits, numbers, count, floor, span); }
+		else { RNGKernelLoops<RNG_KERNEL_AVX2>::Unit(bits, numbers, count, floor, span); }
+		return;
+	case RNG_KERNEL_SSE42: RNGKernelLoops<RNG_KERNEL_SSE42>::Unit(bits, numbers, count, floor, span); return;
+	default: break;
+	} // End switch(RNGSelectedKernel())
+#endif
+	RNGUnitLoop(bits, numbers, count, floor, span);
+}
+// End RNGUnitBlock<floating_type> function
+
+// Define a templated function to convert a block of random bits (an even number) to normally distributed numbers with the
+//		selected variant
+template<typename floating_type> void RNGNormalBlock(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type mean, floating_type deviation) {
+	// const unsigned long long* bits;	// The random bits, two words per pair. Passed
+	// floating_type* numbers;			// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert (even). Passed
+	// floating_type mean;				// The mean of the distribution. Passed
+	// floating_type deviation;			// The standard deviation of the distribution. Passed
+#ifdef RNG_HAS_DISPATCH
+	switch (RNGSelectedKernel()) {
+	case RNG_KERNEL_AVX512: RNGKernelLoops<RNG_KERNEL_AVX512>::Normal(bits, numbers, count, mean, deviation); return;
+	case RNG_KERNEL_AVX2: RNGKernelLoops<RNG_KERNEL_AVX2>::Normal(bits, numbers, count, mean, deviation); return;
+	case RNG_KERNEL_SSE42: RNGKernelLoops<RNG_KERNEL_SSE42>::Normal(bits, numbers, count, mean, deviation); return;
+	default: break;
+	} // End switch(RNGSelectedKernel())
+#endif
+	RNGNormalLoop(bits, numbers, count, mean, deviation);
+}
+// End RNGNormalBlock<floating_type> function
+
+// Define a templated function to convert a block of random bits to exponentially distributed numbers with the selected variant
+template<typename floating_type> void RNGExponentialBlock(const unsigned long long* bits, floating_type* numbers, size_t count, floating_type scale) {
+	// const unsigned long long* bits;	// The random bits. Passed
+	// floating_type* numbers;			// The buffer to fill. Passed
+	// size_t count;					// The number of numbers to convert. Passed
+	// floating_type scale;				// The negated mean of the distribution. Passed
+#ifdef RNG_HAS_DISPATCH
+	switch (RNGSelectedKernel()) {
+	case RNG_KERNEL_AVX512: RNGKernelLoops<RNG_KERNEL_AVX512>::Exponential(bits, numbers, count, scale); return;
+	case RNG_KERNEL_AVX2: RNGKernelLoops<RNG_KERNEL_AVX2>::Exponential(bits, numbers, count, scale); return;
+	case RNG_KERNEL_SSE42: RNGKernelLoops<RNG_KERNEL_SSE42>::Exponential(bits, numbers, count, scale); return;
+	default: break;
+	} // End switch(RNGSelectedKernel())
+#endif
+	RNGExponentialLoop(bits, numbers, count, scale);
+}
+// End RNGExponentialBlock<floating_type> function
+
+// Define a templated function to fill a buffer with uniform integers in the set { number | 0 ≤ number < range }, using a batched
+//		form of Lemire's method: a whole block is scaled in a vectorizable loop, and only the rare candidates that might be biased
+//		are checked (and redrawn) afterwards
+template<typename engine_type, typename integral_type> void FillBoundedRand(engine_type& rng, integral_type* numbers, size_t count, unsigned long long range) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// integral_type* numbers;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to write. Passed
+	// unsigned long long range;	// The number of possible results. Passed
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random bits currently being scaled
+	unsigned long long suspect;					// Non-zero if any number of the block might be biased
+	unsigned long long threshold;				// The lower bits below which a number is biased
+	size_t block;								// The number of numbers scaled from the current block
+
+	// Ensure that the provided types are usable
+	static_assert(std::is_integral_v<integral_type>, "The type provided for FillBoundedRand must be integral");
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for FillBoundedRand must have a 64-bit result_type");
+
+	// Ensure that the range is valid
+	assert(("The range must have at least one number", range > 0));
+
+	while (count > 0) {
+		block = (count < RNGBulkBlockSize) ? count : RNGBulkBlockSize;
+		rng.Fill(bits, block);
+
+		// Scale the block, keeping the lower halves (in place of the bits) to check for bias
+		suspect = RNGScaleBlock(bits, numbers, block, range);
+
+		// Only if a lower half is small enough to be biased, calculate the exact threshold and redraw the biased numbers
+		if (suspect) {
+			threshold = (0 - range) % range;
+			for (size_t i = 0; i < block; i++) {
+				if (bits[i] < threshold) { numbers[i] = (integral_type)RNGBoundedRand(rng, range); }
+			} // End for(i)
+		} // End if(suspect)
+
+		numbers += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End FillBoundedRand<engine_type, integral_type> function
+
+// Define a templated function to fill a buffer with uniform floating-point numbers in the set { number | floor ≤ number < roof }
+template<typename engine_type, typename floating_type> void FillFloatingRand(engine_type& rng, floating_type* numbers, size_t count, floating_type floor = 0, floating_type roof = 1) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// floating_type* numbers;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to write. Passed
+	// floating_type floor;			// The minimum possible number. Passed. 0 if omitted
+	// floating_type roof;			// The upper bound of the numbers (excluded). Passed. 1 if omitted
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random bits currently being converted
+	floating_type span = roof - floor;			// The width of the range
+	size_t block;								// The number of numbers converted from the current block
+
+	// Ensure that the provided types are usable
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for FillFloatingRand must be floating-point");
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for FillFloatingRand must have a 64-bit result_type");
+
+	// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
+	assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
+
+	// Convert one block at a time
+	while (count > 0) {
+		block = (count < RNGBulkBlockSize) ? count : RNGBulkBlockSize;
+		rng.Fill(bits, block);
+		RNGUnitBlock(bits, numbers, block, floor, span);
+		numbers += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End FillFloatingRand<engine_type, floating_type> function
+
+// Define a templated function to fill a buffer with normally distributed floating-point numbers using the Box-Muller transform,
+//		which turns every two uniform numbers into two independent normal numbers without any rejection
+template<typename engine_type, typename floating_type> void FillNormalRand(engine_type& rng, floating_type* numbers, size_t count, floating_type mean = 0, floating_type deviation = 1) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// floating_type* numbers;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to write. Passed
+	// floating_type mean;			// The mean of the distribution. Passed. 0 if omitted
+	// floating_type deviation;		// The standard deviation of the distribution. Passed. 1 if omitted
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random bits currently being converted
+	floating_type tail[2];						// The pair generated for an odd final number
+	size_t block;								// The number of numbers converted from the current block
+
+	// Ensure that the provided types are usable
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for FillNormalRand must be floating-point");
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for FillNormalRand must have a 64-bit result_type");
+
+	// Convert one block at a time, two numbers per pair of random words
+	while (count > 1) {
+		block = (count < RNGBulkBlockSize) ? (count & ~(size_t)1) : RNGBulkBlockSize;
+		rng.Fill(bits, block);
+		RNGNormalBlock(bits, numbers, block, mean, deviation);
+		numbers += block;
+		count -= block;
+	} // End while(count > 1)
+
+	// If the count was odd, generate one more pair and discard its second number
+	if (count == 1) {
+		FillNormalRand(rng, tail, 2, mean, deviation);
+		numbers[0] = tail[0];
+	} // End if(count == 1)
+}
+// End FillNormalRand<engine_type, floating_type> function
+
+// Define a templated function to fill a buffer with exponentially distributed floating-point numbers by inversion
+template<typename engine_type, typename floating_type> void FillExponentialRand(engine_type& rng, floating_type* numbers, size_t count, floating_type rate = 1) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// floating_type* numbers;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to write. Passed
+	// floating_type rate;			// The rate of the distribution. Passed. 1 if omitted
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random bits currently being converted
+	floating_type scale = -1 / rate;			// The factor turning logarithms of uniform numbers into exponential numbers
+	size_t block;								// The number of numbers converted from the current block
+
+	// Ensure that the provided types are usable
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for FillExponentialRand must be floating-point");
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for FillExponentialRand must have a 64-bit result_type");
+
+	// Ensure that the rate is valid
+	assert(("The rate of an exponential distribution must be positive", rate > 0));
+
+	while (count > 0) {
+		block = (count < RNGBulkBlockSize) ? count : RNGBulkBlockSize;
+		rng.Fill(bits, block);
+		RNGExponentialBlock(bits, numbers, block, scale);
+		numbers += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End FillExponentialRand<engine_type, floating_type> function
+
+// Define a templated function to fill a buffer with random 128-bit identifiers (e.g. RNGUInt128, GUID or a pair of 64-bit numbers)
+template<typename engine_type, typename identifier_type> void FillRand128(engine_type& rng, identifier_type* identifiers, size_t count) {
+	// engine_type& rng;					// The generator to pull bits from. Passed by reference
+	// identifier_type* identifiers;		// The buffer to fill. Passed
+	// size_t count;						// The number of identifiers to write. Passed
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random bits currently being copied
+	size_t block;								// The number of identifiers copied from the current block
+
+	// Ensure that the provided types are usable
+	static_assert(sizeof(identifier_type) == 16 && std::is_trivially_copyable_v<identifier_type>, "The type provided for FillRand128 must be a trivially copyable 128-bit type");
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for FillRand128 must have a 64-bit result_type");
+
+	// NOTE: The bits are copied rather than generated in place, since the identifier type may not be an array of 64-bit numbers
+	while (count > 0) {
+		block = (count < RNGBulkBlockSize / 2) ? count : RNGBulkBlockSize / 2;
+		rng.Fill(bits, block * 2);
+		std::memcpy((void*)identifiers, bits, block * 16);
+		identifiers += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End FillRand128<engine_type, identifier_type> function
+#endif
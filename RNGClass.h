@@ -13,6 +13,20 @@
 
 - At the time of writing, RNGClass::FloatingRand will generate numbers inclusively. According to documentation on the
 	std::uniform_real_distribution the maximum number is excluded, however my tests have demonstrated otherwise.
+
+- Where the compiler has 128-bit integers (see RNGBulk.h), RNGUInt128 can be used as result_type and both RNGUInt128 and RNGInt128
+	as cast types of CustomRand. std::uniform_int_distribution doesn't support them, so their ranges are generated with a 128x128
+	bit multiply-and-reject (RNGBoundedRand128), pulling all 128 bits from a single OS call.
+
+- Every block Fill pulls from the OS goes through the continuous health tests of SP 800-90B (see HealthMonitor.h). Failures don't
+	stop the output, but are counted and reported by the instance's monitor (GetHealth), which the application should poll.
+
+- Every instance counts its draws, OS calls, bytes, rejection retries and lock waits (see RNGMetrics.h), per instance (GetMetrics)
+	and for the whole process (RNGProcessMetrics). The numbers the std distributions pull internally are counted as OS calls, not
+	as draws of GetRand.
+
+- When RNG_LATENCY is defined, every instance also samples the latency of its generation methods into histograms (GetLatency, see
+	RNGLatency.h). Otherwise, the instrumentation isn't compiled in at all.
 */
 
 /* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
@@ -32,7 +46,7 @@ NOTE: Examples use "rng" as the identifier for the RNGClass instance, and result
 
 To create an instance of the random number generation class
   declare RNGClass<result_type> identifier
-	result_type: An *UNSIGNED* integral type to generate numbers in (e.g. "unsigned int", "unsigned long long")
+	result_type: An *UNSIGNED* integral type to generate numbers in (e.g. "unsigned int", "unsigned long long", RNGUInt128)
 	identifier: The name of the identifier used to access the class instance
 
 To generate a random number using the RNGClass instance
@@ -56,9 +70,16 @@ To generate a random number in a specified range using the RNGClass instance
    RETURN: result_type
    NOTE: Generates numbers in the set { RETURN ∈ result_type | floor ≤ RETURN ≤ roof }
 
+To fill a buffer with random numbers using the RNGClass instance
+ Call rng.Fill(numbers, count)
+	 numbers: result_type*, the buffer to fill
+	 count: size_t, the number of numbers to write to the buffer
+   RETURN: void
+   NOTE: Uses a single OS call for the whole buffer, so prefer this over repeated rng() calls for large amounts of numbers
+
 To generate a random number of an integral type different than result_type
  Call rng.CustomRand<cast_type>(floor, roof)
-	 cast_type: the type of the result (e.g. int, long long, unsigned int)
+	 cast_type: the type of the result (e.g. int, long long, unsigned int, RNGInt128)
 	 floor: cast_type, the minimum possible number. If omitted, it becomes the type's lowest possible value (e.g. INT_MIN)
 	 roof: cast_type, the maximum possible number. If omitted, it becomes the type's largest possible value (e.g. INT_MAX)
    RETURN: cast_type
@@ -76,6 +97,18 @@ To manually initialize the RNGClass instance
  Call rng.Initialize(reinitialize)
 	 reinitialize: bool, whether or not to reinitialize if the class instance is already initialized. If omitted, it becomes false
    RETURN: void
+
+To get the health monitor testing the blocks pulled by Fill (status, counters, reset)
+ Call rng.GetHealth()
+   RETURN: HealthMonitor&
+
+To get the counters of the instance (draws, OS calls, bytes, rejection retries, lock waits)
+ Call rng.GetMetrics()
+   RETURN: RNGMetrics&, whose Snapshot method returns the counters (see RNGMetrics.h)
+
+To get the latency histograms of the generation methods (only if RNG_LATENCY is defined)
+ Call rng.GetLatency()
+   RETURN: RNGLatency&, dumped with RNGLatencyText (see RNGLatency.h)
 */
 
 // Include guard
@@ -115,6 +148,14 @@ To manually initialize the RNGClass instance
 #ifndef _CONDITION_VARIABLE_
 #include <condition_variable>
 #endif
+// Include the header defining the shared primitives (used for 128-bit numbers)
+#include "RNGBulk.h"
+// Include the header defining the health tests run on the blocks pulled from the OS
+#include "HealthMonitor.h"
+// Include the header defining the counters of the instance
+#include "RNGMetrics.h"
+// Include the header defining the latency histograms of the instance (only compiled in if RNG_LATENCY is defined)
+#include "RNGLatency.h"
 // Include the header to allow run-time assertions. NOTE: assert.h does not contain an include guard, but due to only containing
 //		a forward declaration and a macro there are no side effects of multiple inclusions
 #include <assert.h>
@@ -125,7 +166,7 @@ class RNGClass { // NOTE: Most of the stuff in this class isn't done in my usual
 				 //		with §29.6.1.3 of the C++17 standard draft, which is necessary to be used with the std::shuffle function
 public:
 	// Ensure that the provided type is numerical and unsigned
-	static_assert(std::is_unsigned_v<T>, "The type provided for RNGClass must be unsigned");
+	static_assert(RNGIsUnsigned<T>, "The type provided for RNGClass must be unsigned");
 
 	// Create result_type as an alias for T (the provided type)
 	typedef T result_type;
@@ -160,6 +201,7 @@ public:
 	//		{ number ∈ result_type | min() ≤ number ≤ max() }, as required by §29.6.1.3 of the C++17 standard draft
 	result_type operator()() {
 		result_type number; // The number to return
+		RNG_TIME_CALL(this->latency, RNG_TIMED_GETRAND); // NOTE: Times the call if RNG_LATENCY is defined
 
 		// Increment the number of pending generations, forwarding exceptions
 		try { this->IncrementCount(); }
@@ -169,7 +211,8 @@ public:
 		if (!initialized) { this->Initialize(); }
 
 		// Calculate the random number, and return it
-		BCryptGenRandom(this->algorithm_handle, (unsigned char*)&number, sizeof(number), NULL);
+		number = this->Pull();
+		this->metrics.Add(RNG_METRIC_GETRAND);
 
 		// Decrement the number of pending generations
 		this->DecrementCount();
@@ -185,6 +228,7 @@ public:
 		// result_type floor;	// The minimum number that can be returned. Passed
 		// result_type roof;	// The maximum number that can be returned. Passed
 		result_type number;		// The number to return
+		RNG_TIME_CALL(this->latency, RNG_TIMED_GETRAND); // NOTE: Times the call if RNG_LATENCY is defined
 
 		// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
 		assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
@@ -193,8 +237,9 @@ public:
 		try { this->IncrementCount(); }
 		catch (...) { throw; }
 
-		// Create a temporary integer distributer and use it to get a number within the specified range of the specified type
-		number = std::uniform_int_distribution<result_type>(floor, roof)(*this);
+		// Get a number within the specified range
+		number = this->RangeRand<result_type>(floor, roof);
+		this->metrics.Add(RNG_METRIC_GETRAND);
 
 		// Decrement the number of pending generations
 		this->DecrementCount();
@@ -204,6 +249,38 @@ public:
 	}
 	// End RNGClass<T>::operator() [overload: result_type, result_type] method
 
+	// Define a method to fill a buffer with random numbers of the provided type using a single call to the OS generator, which
+	//		is far cheaper than one call per number when large amounts of numbers are needed
+	void Fill(result_type* numbers, size_t count) {
+		// result_type* numbers;	// The buffer to fill. Passed
+		// size_t count;			// The number of numbers to write to the buffer. Passed
+		size_t chunk;				// The number of numbers generated by the current OS call
+		RNG_TIME_CALL(this->latency, RNG_TIMED_FILL); // NOTE: Times the call if RNG_LATENCY is defined
+
+		// Increment the number of pending generations, forwarding exceptions
+		try { this->IncrementCount(); }
+		catch (...) { throw; }
+
+		// If necessary, initialize this instance of RNGClass
+		if (!initialized) { this->Initialize(); }
+		this->metrics.Add(RNG_METRIC_FILL, count);
+
+		// Fill the buffer, splitting the request since BCryptGenRandom takes the byte count as a ULONG
+		while (count > 0) {
+			chunk = (count < ((ULONG)-1) / sizeof(result_type)) ? count : ((ULONG)-1) / sizeof(result_type);
+			BCryptGenRandom(this->algorithm_handle, (unsigned char*)numbers, (ULONG)(chunk * sizeof(result_type)), NULL);
+			this->metrics.Add(RNG_METRIC_BACKEND_CALLS);
+			this->metrics.Add(RNG_METRIC_BYTES, chunk * sizeof(result_type));
+			this->health.Test(numbers, chunk * sizeof(result_type));
+			numbers += chunk;
+			count -= chunk;
+		} // End while(count > 0)
+
+		// Decrement the number of pending generations
+		this->DecrementCount();
+	}
+	// End RNGClass<T>::Fill method
+
 	// Define a method to intitialize the instance of RNGClass
 	void Initialize(bool reinitialize = false) {
 		// bool reinitialize; // Boolean for whether or not to reinitialize the class instance if the class instance has already
@@ -225,12 +302,23 @@ public:
 	}
 	// End RNGClass<T>::Initialize method
 
+	// Define a method to return the health monitor testing the blocks pulled by Fill
+	HealthMonitor& GetHealth() { return this->health; }
+
+	// Define a method to return the counters of the instance
+	RNGMetrics& GetMetrics() { return this->metrics; }
+
+#ifdef RNG_LATENCY
+	// Define a method to return the latency histograms of the generation methods
+	RNGLatency& GetLatency() { return this->latency; }
+#endif
+
 	// Define the method "max" to return the maximum number the provided type can contain. NOTE: Name is wrapped in "()" to
 	//		avoid the compiler trying to replace "max" with the macro defined in Windows.h
-	static T(max)() { return (std::numeric_limits<T>::max)(); }
+	static constexpr T(max)() { return RNGHighest<T>(); }
 
 	// Define the method "min" to return the minimum number the provided type can contain (0 because the types must be unsigned)
-	static T(min)() { return 0; }
+	static constexpr T(min)() { return 0; }
 
 	// Define a method to return a random number (since pointers can't access the "()" operator in an easily readable way)
 	result_type GetRand() { try { return this->operator()(); } catch (...) { throw; } }
@@ -240,13 +328,14 @@ public:
 
 	// Define a templated method to generate a random number of the specified type over the specified range
 	//		{ number ∈ cast_type | floor ≤ number ≤ roof }
-	template<typename cast_type> cast_type CustomRand(cast_type floor = (std::numeric_limits<cast_type>::min)(), cast_type roof = (std::numeric_limits<cast_type>::max)()) {
+	template<typename cast_type> cast_type CustomRand(cast_type floor = RNGLowest<cast_type>(), cast_type roof = RNGHighest<cast_type>()) {
 		// cast_type floor; // The minimum number that can be returned. Passed. Minimum of the type if omitted
 		// cast_type roof;	// The maximum number that can be returned. Passed. Maximum of the type if omitted
 		cast_type number;	// The number to return
+		RNG_TIME_CALL(this->latency, RNG_TIMED_CUSTOMRAND); // NOTE: Times the call if RNG_LATENCY is defined
 
 		// Ensure that the provided type is numerical, but not necessarily and unsigned
-		static_assert(std::is_integral_v<cast_type>, "The type provided for RNGClass::CustomRand must be integral");
+		static_assert(RNGIsIntegral<cast_type>, "The type provided for RNGClass::CustomRand must be integral");
 
 		// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
 		assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
@@ -255,8 +344,9 @@ public:
 		try { this->IncrementCount(); }
 		catch (...) { throw; }
 
-		// Create a temporary integer distributer and use it to get a number within the specified range of the specified type
-		number = std::uniform_int_distribution<cast_type>(floor, roof)(*this);
+		// Get a number within the specified range
+		number = this->RangeRand<cast_type>(floor, roof);
+		this->metrics.Add(RNG_METRIC_CUSTOMRAND);
 
 		// Decrement the number of pending generations
 		this->DecrementCount();
@@ -271,6 +361,8 @@ public:
 		// cast_type floor;		// The minimum number that can be returned. Passed. 0 if omitted
 		// cast_type roof;		// The maximum number that can be returned. Passed. 1 if omitted
 		floating_type number;	// The number to return
+		BackendView backend{ *this, 0 }; // The instance as the generator of the distribution (whose pulls aren't GetRand draws)
+		RNG_TIME_CALL(this->latency, RNG_TIMED_FLOATINGRAND); // NOTE: Times the call if RNG_LATENCY is defined
 
 		// Ensure that the provided type is floating-point
 		static_assert(std::is_floating_point_v<floating_type>, "The type provided for RNGClass::FloatingRand must be floating-point");
@@ -282,8 +374,12 @@ public:
 		try { this->IncrementCount(); }
 		catch (...) { throw; }
 
-		// Create a temporary integer distributer and use it to get a number within the specified range of the specified type
-		number = std::uniform_real_distribution<floating_type>(floor, roof)(*this);
+		// If necessary, initialize this instance of RNGClass
+		if (!initialized) { this->Initialize(); }
+
+		// Create a temporary real distributer and use it to get a number within the specified range of the specified type
+		number = std::uniform_real_distribution<floating_type>(floor, roof)(backend);
+		this->metrics.Add(RNG_METRIC_FLOATINGRAND);
 
 		// Decrement the number of pending generations
 		this->DecrementCount();
@@ -313,7 +409,8 @@ protected:
 		}
 
 		// If necessary, block the current thread until current count incrementation is complete
-		std::lock_guard<std::mutex> lock(this->count_muter);
+		std::unique_lock<std::mutex> lock(this->count_muter, std::defer_lock);
+		this->Acquire(lock);
 
 		// Incremet count
 		pending_count += 1; // NOTE: lock is released when it runs out of scope
@@ -326,15 +423,128 @@ protected:
 		//		generations is not interrupted. Declared later due to constructor use
 
 		// If necessary, block the current thread until current count decrementation is complete
-		std::lock_guard<std::mutex> lock(this->count_muter);
+		std::unique_lock<std::mutex> lock(this->count_muter, std::defer_lock);
+		this->Acquire(lock);
 
 		// Decremet count
 		pending_count -= 1; // NOTE: lock is released when it runs out of scope
 	}
 	// End RNGClass<T>::DecrementCount method
 
+	// Define a method to lock a mutex, counting and timing the wait if another thread holds it
+	void Acquire(std::unique_lock<std::mutex>& lock) {
+		// std::unique_lock<std::mutex>& lock;		// The unlocked lock of the mutex. Passed by reference
+		std::chrono::steady_clock::time_point start;	// The time the wait started
+
+		// Only time the wait if the mutex is held, so the uncontended path stays a single attempt
+		if (lock.try_lock()) { return; }
+		start = std::chrono::steady_clock::now();
+		lock.lock();
+		this->metrics.Add(RNG_METRIC_LOCK_WAITS);
+		this->metrics.Add(RNG_METRIC_LOCK_WAIT_NS, (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+	// End RNGClass<T>::Acquire method
+
+	// Define a method to pull a single number from the OS. NOTE: Called by methods which have already incremented the number of
+	//		pending generations and initialized the instance
+	result_type Pull() {
+		result_type number; // The number to return
+
+		BCryptGenRandom(this->algorithm_handle, (unsigned char*)&number, sizeof(number), NULL);
+		this->metrics.Add(RNG_METRIC_BACKEND_CALLS);
+		this->metrics.Add(RNG_METRIC_BYTES, sizeof(number));
+		return number;
+	}
+	// End RNGClass<T>::Pull method
+
+	// Define a struct to view the instance as the generator of the std distributions, counting its pulls (which are OS calls, not
+	//		GetRand draws) to find the rejection retries
+	struct BackendView {
+		typedef T result_type;
+		RNGClass& parent;			// The instance pulled from
+		unsigned long long pulls;	// The number of numbers pulled
+		result_type operator()() {
+			this->pulls++;
+			return parent.Pull();
+		}
+		static constexpr T(max)() { return RNGHighest<T>(); }
+		static constexpr T(min)() { return 0; }
+	}; // End struct BackendView
+
+	// Define a templated method to generate a number in the set { number ∈ cast_type | floor ≤ number ≤ roof }, counting the pulls
+	//		beyond the fewest the range needs as rejection retries. NOTE: Called by methods which have already incremented the number
+	//		of pending generations
+	template<typename cast_type> cast_type RangeRand(cast_type floor, cast_type roof) {
+		// cast_type floor;				// The minimum number that can be returned. Passed
+		// cast_type roof;				// The maximum number that can be returned. Passed
+		BackendView backend{ *this, 0 };	// The instance as the generator of the distribution
+		unsigned long long span;		// The width of the range, minus 1
+		unsigned long long fewest;		// The fewest pulls the range needs
+		unsigned int bits = 0;			// The number of bits of the range
+		cast_type number;				// The number to return
+
+		// Use a temporary integer distributer, unless the type is too wide for the std distributions
+		if constexpr (RNGIsWide<cast_type>) { return this->WideRand(floor, roof); }
+		else {
+			// If necessary, initialize this instance of RNGClass
+			if (!initialized) { this->Initialize(); }
+			number = std::uniform_int_distribution<cast_type>(floor, roof)(backend);
+
+			// Count the retries: every pull gives std::numeric_limits<T>::digits bits
+			span = (unsigned long long)(std::make_unsigned_t<cast_type>)((std::make_unsigned_t<cast_type>)roof - (std::make_unsigned_t<cast_type>)floor);
+			for (; span != 0; span >>= 1) { bits++; }
+			fewest = (bits + std::numeric_limits<T>::digits - 1) / std::numeric_limits<T>::digits;
+			if (backend.pulls > fewest) { this->metrics.Add(RNG_METRIC_RETRIES, backend.pulls - fewest); }
+			return number;
+		} // End else
+	}
+	// End RNGClass<T>::RangeRand<cast_type> method
+
+#ifdef RNG_HAS_INT128
+	// Define a struct to view the instance as a generator of 128-bit numbers, pulling every number from a single OS call
+	struct WideView {
+		typedef RNGUInt128 result_type;
+		RNGClass& parent; // The instance whose algorithm is used
+		unsigned long long pulls;	// The number of numbers pulled
+		result_type operator()() {
+			result_type number; // The number to return
+			BCryptGenRandom(parent.algorithm_handle, (unsigned char*)&number, sizeof(number), NULL);
+			parent.metrics.Add(RNG_METRIC_BACKEND_CALLS);
+			parent.metrics.Add(RNG_METRIC_BYTES, sizeof(number));
+			this->pulls++;
+			return number;
+		}
+	}; // End struct WideView
+
+	// Define a templated method to generate a 128-bit number in the set { number ∈ cast_type | floor ≤ number ≤ roof }. NOTE:
+	//		Called by RangeRand, whose caller has already incremented the number of pending generations
+	template<typename cast_type> cast_type WideRand(cast_type floor, cast_type roof) {
+		// cast_type floor;		// The minimum number that can be returned. Passed
+		// cast_type roof;		// The maximum number that can be returned. Passed
+		WideView wide{ *this, 0 };	// A 128-bit view of this instance
+		cast_type number;			// The number to return
+
+		// If necessary, initialize this instance of RNGClass
+		if (!initialized) { this->Initialize(); }
+
+		// Generate an offset from the floor with unsigned wraparound. NOTE: If the range covers the whole type, its size
+		//		overflows to 0, which RNGBoundedRand128 treats as the full range
+		number = (cast_type)((RNGUInt128)floor + RNGBoundedRand128(wide, (RNGUInt128)roof - (RNGUInt128)floor + 1));
+
+		// Every pull gives 128 bits, so any pull beyond the first is a rejection retry
+		if (wide.pulls > 1) { this->metrics.Add(RNG_METRIC_RETRIES, wide.pulls - 1); }
+		return number;
+	}
+	// End RNGClass<T>::WideRand<cast_type> method
+#endif
+
 	bool initialized;					// Boolean for whether or not the instance is initialized
 	BCRYPT_ALG_HANDLE algorithm_handle;	// The handle to the algorithm used for generating numbers (time intensive to get)
+	HealthMonitor health;				// The health tests run on the blocks pulled by Fill
+	RNGMetrics metrics;					// The counters of the instance
+#ifdef RNG_LATENCY
+	RNGLatency latency;					// The latency histograms of the generation methods
+#endif
 	// NOTE: variables regarding thread safety are private to prevent tampering
 private:
 	bool dying;							// Boolean for whether or not the class instance is trying to be destroyed (used to deny generations)
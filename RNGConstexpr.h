@@ -0,0 +1,105 @@
+﻿// RNGConstexpr.h - This header defines the templated functions that generate random tables and permutations at compile time
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- SeededRNGClass, MersenneTwisterClass and the primitives of RNGBulk.h (RNGBoundedRand, RNGBitsToUnit, RNGMultiply128) are
+	constexpr, so seeded numbers can be generated by the compiler: e.g. "constexpr auto permutation = MakeRandomPermutation<256>(42);"
+	is evaluated entirely at compile time and costs nothing at run time (hash salts, S-boxes, test fixtures, lookup tables).
+
+- The numbers are the same ones the same engine produces at run time, so a table can be generated at compile time in one build and
+	at run time in another without any difference.
+
+- Only the seeded engines can be used: RNGClass and BufferedRNGClass draw from the OS and can't be evaluated by the compiler.
+	NormalRand isn't constexpr either, since the functions of <cmath> aren't in C++17.
+
+- Large tables may need a higher constexpr step limit (e.g. /constexpr:steps with MSVC, -fconstexpr-ops-limit with GCC).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type (e.g. a
+	SeededRNGClass<unsigned long long> instance). Every function can be used in constant expressions
+
+To shuffle a buffer in place (Fisher-Yates)
+ call ShuffleRand(rng, values, count)
+	 values: value_type*, the buffer to shuffle
+	 count: size_t, the number of values
+   RETURN: void
+
+To generate a random permutation of { 0, 1, ..., N - 1 }
+ call MakeRandomPermutation<N, index_type>(seed, stream)
+	 N: size_t, the number of indices
+	 index_type: the integral type of the indices. If omitted, it becomes size_t
+	 seed: unsigned long long, the seed of the SeededRNGClass instance generating the permutation
+	 stream: unsigned long long, the stream of the seed. If omitted, it becomes 0
+   RETURN: std::array<index_type, N>
+
+To generate a table of random numbers (integers over the whole type, or floating-point numbers in [0, 1))
+ call MakeRandomTable<value_type, N>(seed, stream)
+	 value_type: the type of the numbers (e.g. unsigned char, int, double)
+	 N: size_t, the number of numbers
+	 seed: unsigned long long, the seed of the SeededRNGClass instance generating the table
+	 stream: unsigned long long, the stream of the seed. If omitted, it becomes 0
+   RETURN: std::array<value_type, N>
+*/
+
+// Include guard
+#ifndef RNGCONSTEXPR_H
+#define RNGCONSTEXPR_H
+
+// If necessary, include the header to allow fixed-size arrays
+#ifndef _ARRAY_
+#include <array>
+#endif
+// Include the header declaring SeededRNGClass, which generates the tables
+#include "SeededRNGClass.h"
+
+// Define a templated function to shuffle a buffer in place with the Fisher-Yates algorithm, drawing every swap with RNGBoundedRand
+template<typename engine_type, typename value_type> constexpr void ShuffleRand(engine_type& rng, value_type* values, size_t count) {
+	// engine_type& rng;		// The generator to pull bits from. Passed by reference
+	// value_type* values;		// The buffer to shuffle. Passed
+	// size_t count;			// The number of values. Passed
+
+	for (size_t i = count; i > 1; i--) {
+		size_t j = (size_t)RNGBoundedRand(rng, i);	// The position swapped with the last unshuffled one
+		value_type value = values[i - 1];			// The last unshuffled value. NOTE: Swapped by hand since std::swap isn't constexpr in C++17
+
+		values[i - 1] = values[j];
+		values[j] = value;
+	} // End for(i)
+}
+// End ShuffleRand<engine_type, value_type> function
+
+// Define a templated function to generate a random permutation of the first N indices
+template<size_t N, typename index_type = size_t> constexpr std::array<index_type, N> MakeRandomPermutation(unsigned long long seed, unsigned long long stream = 0) {
+	// unsigned long long seed;		// The seed of the generator. Passed
+	// unsigned long long stream;	// The stream of the seed. Passed. 0 if omitted
+	SeededRNGClass<unsigned long long> rng(seed, stream);	// The generator of the permutation
+	std::array<index_type, N> permutation{};				// The permutation to return
+
+	// Ensure that every index fits in the provided type
+	static_assert(std::is_integral_v<index_type>, "The type provided for MakeRandomPermutation must be integral");
+	static_assert(N == 0 || (unsigned long long)(N - 1) <= (unsigned long long)(std::numeric_limits<index_type>::max)(), "The type provided for MakeRandomPermutation can't hold every index");
+
+	for (size_t i = 0; i < N; i++) { permutation[i] = (index_type)i; }
+	ShuffleRand(rng, permutation.data(), N);
+	return permutation;
+}
+// End MakeRandomPermutation<N, index_type> function
+
+// Define a templated function to generate a table of random numbers, integers over the whole type or floating-point numbers in [0, 1)
+template<typename value_type, size_t N> constexpr std::array<value_type, N> MakeRandomTable(unsigned long long seed, unsigned long long stream = 0) {
+	// unsigned long long seed;		// The seed of the generator. Passed
+	// unsigned long long stream;	// The stream of the seed. Passed. 0 if omitted
+	SeededRNGClass<unsigned long long> rng(seed, stream);	// The generator of the table
+	std::array<value_type, N> table{};						// The table to return
+
+	// Ensure that the provided type is numerical
+	static_assert(std::is_arithmetic_v<value_type> && !std::is_same_v<value_type, bool>, "The type provided for MakeRandomTable must be integral or floating-point");
+
+	for (size_t i = 0; i < N; i++) {
+		if constexpr (std::is_floating_point_v<value_type>) { table[i] = rng.FloatingRand<value_type>(); }
+		else { table[i] = (value_type)rng(); }
+	} // End for(i)
+	return table;
+}
+// End MakeRandomTable<value_type, N> function
+#endif
@@ -0,0 +1,227 @@
+﻿// RNGDispatch.h - This header defines the run-time selection of the instruction set used by the bulk kernels (see RNGBulk.h), and
+//		the CPU helpers shared by the other headers (CPUID, time stamp counter)
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- One binary can run on several generations of x86 hardware: the block kernels of RNGBulk.h (bounded scaling, floating-point
+	conversion, normal and exponential conversion, which back FillBoundedRand, FillFloatingRand, FillNormalRand and
+	FillExponentialRand) are compiled for the baseline instruction set and for SSE4.2, AVX2 and AVX-512, and the widest variant
+	the CPU (and the OS, which must save the wider registers) supports is picked the first time a kernel runs. The choice is made
+	once per process with CPUID, and costs one predictable branch per block of RNGBulkBlockSize numbers.
+
+- Every variant produces exactly the same numbers, so results don't depend on the machine. That requires that multiplications and
+	additions are never fused (AVX-512 implies FMA, which GCC and Clang otherwise use by default). MSVC doesn't contract by
+	default, and on Clang RNG_NO_CONTRACT_SCOPE turns it off inside the shared loops. GCC can only turn it off for a whole
+	translation unit, so builds with GCC need -ffp-contract=off: without it, the AVX-512 variants of the floating-point kernels
+	can differ from the others in the last bit.
+
+- The other bulk loops (16-bit floating-point fills, stochastic rounding, masks, geometry and the other distributions) aren't
+	dispatched: they are compiled once, for the instruction set of the build.
+
+- Setting the environment variable RNG_KERNEL to "scalar", "sse4.2", "avx2" or "avx512" forces a narrower variant, for testing or
+	benchmarking. A variant the machine can't run is never selected: the request is lowered to the widest supported one.
+
+- With GCC and Clang, RNG_TARGET compiles single functions for another instruction set, so the loops are vectorized for it. MSVC
+	can't do this (intrinsics are allowed anywhere, but the code around them keeps the instruction set of /arch), so on MSVC only
+	the kernels written with intrinsics (bounded scaling and floating-point conversion) gain from the wider variants.
+
+- On other architectures, only the baseline variant exists.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+To get the variant used by the bulk kernels
+ call RNGSelectedKernel()
+   RETURN: RNGKernel, one of RNG_KERNEL_SCALAR, RNG_KERNEL_SSE42, RNG_KERNEL_AVX2 or RNG_KERNEL_AVX512
+
+To get the widest variant the machine supports (ignoring RNG_KERNEL)
+ call RNGDetectKernel()
+   RETURN: RNGKernel
+
+To get the name of a variant
+ call RNGKernelName(kernel)
+	 kernel: RNGKernel, the variant
+   RETURN: const char*, the name accepted by RNG_KERNEL
+
+To get a report of the selection (e.g. for logs)
+ call RNGKernelReport()
+   RETURN: std::string, e.g. "avx2 (detected avx512, RNG_KERNEL=avx2)"
+
+To read a cheap, high-resolution timestamp (the time stamp counter on x64, the steady clock in nanoseconds elsewhere)
+ call RNGReadTimestamp()
+   RETURN: unsigned long long
+*/
+
+// Include guard
+#ifndef RNGDISPATCH_H
+#define RNGDISPATCH_H
+
+// If necessary, include the header to allow strings
+#ifndef _STRING_
+#include <string>
+#endif
+// If necessary, include the header to allow reading environment variables
+#ifndef _CSTDLIB_
+#include <cstdlib>
+#endif
+// If necessary, include the header to allow reading the steady clock (where there is no time stamp counter)
+#ifndef _CHRONO_
+#include <chrono>
+#endif
+
+// Dispatch is only done on x64
+#if defined(_M_X64) || defined(__x86_64__)
+#define RNG_HAS_DISPATCH
+// If necessary, include the headers declaring CPUID and the SSE, AVX2 and AVX-512 intrinsics
+#if defined(_MSC_VER) && !defined(_INC_INTRIN)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) && !defined(__CPUID_H)
+#include <cpuid.h>
+#endif
+#ifndef _INCLUDED_IMM
+#include <immintrin.h>
+#endif
+#endif
+
+// Define the macros compiling a single function for another instruction set, and forcing a function to be inlined (so that the
+//		shared loops are compiled with the instruction set of the function they are inlined in)
+// Also define the macro keeping multiplications and additions unfused on Clang, which decides per expression, so it is a pragma
+//		opening the bodies of the shared loops. NOTE: GCC needs -ffp-contract=off instead (see the notes)
+#if defined(__clang__)
+#define RNG_TARGET(instruction_set) __attribute__((target(instruction_set)))
+#define RNG_FORCE_INLINE inline __attribute__((always_inline))
+#define RNG_NO_CONTRACT_SCOPE _Pragma("clang fp contract(off)")
+#elif defined(__GNUC__)
+#define RNG_TARGET(instruction_set) __attribute__((target(instruction_set)))
+#define RNG_FORCE_INLINE inline __attribute__((always_inline))
+#define RNG_NO_CONTRACT_SCOPE
+#else
+#define RNG_TARGET(instruction_set)
+#define RNG_FORCE_INLINE __forceinline
+#define RNG_NO_CONTRACT_SCOPE
+#endif
+
+// Define the variants of the bulk kernels, from the narrowest to the widest
+enum RNGKernel { RNG_KERNEL_SCALAR, RNG_KERNEL_SSE42, RNG_KERNEL_AVX2, RNG_KERNEL_AVX512 };
+
+// Define a function to return the name of a variant
+inline const char* RNGKernelName(RNGKernel kernel) {
+	// RNGKernel kernel; // The variant. Passed
+	switch (kernel) {
+	case RNG_KERNEL_SSE42: return "sse4.2";
+	case RNG_KERNEL_AVX2: return "avx2";
+	case RNG_KERNEL_AVX512: return "avx512";
+	default: return "scalar";
+	} // End switch(kernel)
+}
+// End RNGKernelName function
+
+#ifdef RNG_HAS_DISPATCH
+// Define a function to read a leaf of CPUID, leaving the registers 0 if the CPU doesn't have the leaf
+inline void RNGCPUID(unsigned int leaf, unsigned int subleaf, unsigned int* registers) {
+	// unsigned int leaf;			// The leaf to read. Passed
+	// unsigned int subleaf;		// The subleaf to read. Passed
+	// unsigned int* registers;		// The buffer to fill with EAX, EBX, ECX and EDX. Passed
+
+	for (int i = 0; i < 4; i++) { registers[i] = 0; }
+#if defined(_MSC_VER)
+	int values[4]; // The output of the current CPUID call
+	__cpuid(values, 0);
+	if ((unsigned int)values[0] < leaf) { return; }
+	__cpuidex(values, (int)leaf, (int)subleaf);
+	for (int i = 0; i < 4; i++) { registers[i] = (unsigned int)values[i]; }
+#else
+	__get_cpuid_count(leaf, subleaf, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+}
+// End RNGCPUID function
+#endif
+
+// Define a function to detect the widest variant the CPU and the OS support
+inline RNGKernel RNGDetectKernel() {
+#ifdef RNG_HAS_DISPATCH
+	unsigned int leaf1[4];			// EAX, EBX, ECX and EDX of CPUID leaf 1 (features)
+	unsigned int leaf7[4];			// EAX, EBX, ECX and EDX of CPUID leaf 7, subleaf 0 (extended features)
+	unsigned long long xcr0 = 0;	// The register states the OS saves on context switches
+
+	RNGCPUID(1, 0, leaf1);
+	RNGCPUID(7, 0, leaf7);
+
+	// Only read XCR0 if the OS enabled XGETBV (OSXSAVE)
+	if (leaf1[2] & (1u << 27)) {
+#if defined(_MSC_VER)
+		xcr0 = _xgetbv(0);
+#else
+		unsigned int low, high; // The halves of XCR0
+		__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+		xcr0 = ((unsigned long long)high << 32) | low;
+#endif
+	} // End if(leaf1[2] & (1u << 27))
+
+	// AVX-512 needs the foundation, the 64-bit integer conversions and the byte and word lanes of the health tests (F, DQ and BW,
+	//		which every CPU with AVX-512 but the Xeon Phi has), and the OS to save the mask and upper registers
+	if ((leaf7[1] & (1u << 16)) && (leaf7[1] & (1u << 17)) && (leaf7[1] & (1u << 30)) && (xcr0 & 0xE6) == 0xE6) { return RNG_KERNEL_AVX512; }
+	// AVX2 needs AVX and the OS to save the YMM registers
+	if ((leaf7[1] & (1u << 5)) && (leaf1[2] & (1u << 28)) && (xcr0 & 0x6) == 0x6) { return RNG_KERNEL_AVX2; }
+	if (leaf1[2] & (1u << 20)) { return RNG_KERNEL_SSE42; }
+#endif
+	return RNG_KERNEL_SCALAR;
+}
+// End RNGDetectKernel function
+
+// Define a function to return the variant requested with the environment variable RNG_KERNEL, or -1 if there is none
+inline int RNGRequestedKernel() {
+	std::string requested; // The value of the variable
+
+#if defined(_MSC_VER) // NOTE: MSVC deprecates getenv
+	char* value = nullptr;	// The copy of the value allocated by _dupenv_s
+	size_t length = 0;		// The length of the value
+	if (_dupenv_s(&value, &length, "RNG_KERNEL") == 0 && value != nullptr) {
+		requested = value;
+		free(value);
+	} // End if(_dupenv_s(&value, &length, "RNG_KERNEL") == 0 && value != nullptr)
+#else
+	if (const char* value = std::getenv("RNG_KERNEL")) { requested = value; }
+#endif
+
+	for (int kernel = RNG_KERNEL_SCALAR; kernel <= RNG_KERNEL_AVX512; kernel++) {
+		if (requested == RNGKernelName((RNGKernel)kernel)) { return kernel; }
+	} // End for(kernel)
+	return -1;
+}
+// End RNGRequestedKernel function
+
+// Define a function to return the variant used by the bulk kernels, selected on the first call
+inline RNGKernel RNGSelectedKernel() {
+	// NOTE: The initialization of a static local is thread-safe, and only happens once
+	static const RNGKernel selected = []() -> RNGKernel {
+		RNGKernel detected = RNGDetectKernel();	// The widest variant supported
+		int requested = RNGRequestedKernel();	// The variant forced with RNG_KERNEL
+
+		return (requested >= 0 && requested < (int)detected) ? (RNGKernel)requested : detected;
+	}();
+	return selected;
+}
+// End RNGSelectedKernel function
+
+// Define a function to describe the selection of the variant
+inline std::string RNGKernelReport() {
+	std::string report = RNGKernelName(RNGSelectedKernel());	// The report to return
+	int requested = RNGRequestedKernel();						// The variant forced with RNG_KERNEL
+
+	report += std::string(" (detected ") + RNGKernelName(RNGDetectKernel());
+	if (requested >= 0) { report += std::string(", RNG_KERNEL=") + RNGKernelName((RNGKernel)requested); }
+	return report + ")";
+}
+// End RNGKernelReport function
+
+// Define a function to read a cheap, high-resolution timestamp. NOTE: Time stamp counter ticks are not nanoseconds, and are only
+//		comparable on the same machine
+inline unsigned long long RNGReadTimestamp() {
+#ifdef RNG_HAS_DISPATCH
+	return __rdtsc();
+#else
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+// End RNGReadTimestamp function
+#endif
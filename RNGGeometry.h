@@ -0,0 +1,273 @@
+﻿// RNGGeometry.h - This header defines the templated bulk functions used to generate uniform points in the unit disk, on and in the
+//		unit sphere, on the unit hypersphere and in the unit hyperball, as well as uniform random rotations
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- All functions write their output as a structure of arrays (one buffer per coordinate), which is what vectorized consumers want.
+
+- Like the functions of RNGBulk.h, these accept any generator with a 64-bit result_type and a "Fill" method (RNGClass or
+	SeededRNGClass), and pull bits from it in blocks.
+
+- Points in the disk and on the sphere use Marsaglia's method: candidates are generated in the square [-1, 1)² for a whole block
+	at once (a loop the compiler can vectorize), and the ~79% that land inside the disk are then compacted into the output. This
+	avoids the sine and cosine needed by the polar methods and never loops per point.
+
+- Points on hyperspheres of any dimension use normal normalization (a vector of independent normal numbers divided by its length),
+	and points in balls scale those by the dimension-th root of a uniform number.
+
+- Rotations are unit quaternions generated with Shoemake's method, which is uniform over the rotation group. The quaternions are
+	written as (w, x, y, z) with w being the scalar part.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type. Every coordinate buffer must hold
+	at least count numbers of floating_type (e.g. float, double)
+
+To generate uniform points in the unit disk
+ call FillUnitDiskRand(rng, x, y, count)
+	 x, y: floating_type*, the buffers to fill with the coordinates of the points
+	 count: size_t, the number of points to generate
+   RETURN: void
+
+To generate uniform points on the unit sphere S²
+ call FillUnitSphereRand(rng, x, y, z, count)
+	 x, y, z: floating_type*, the buffers to fill with the coordinates of the points
+	 count: size_t, the number of points to generate
+   RETURN: void
+
+To generate uniform points in the unit ball
+ call FillUnitBallRand(rng, x, y, z, count)
+	 x, y, z: floating_type*, the buffers to fill with the coordinates of the points
+	 count: size_t, the number of points to generate
+   RETURN: void
+
+To generate uniform points on the unit hypersphere S^(dimensions - 1), or in the unit hyperball
+ call FillUnitHypersphereRand(rng, coordinates, dimensions, count)
+ ----------OR---------
+ call FillUnitHyperballRand(rng, coordinates, dimensions, count)
+	 coordinates: floating_type* const*, an array of dimensions buffers, one per coordinate
+	 dimensions: size_t, the number of coordinates of every point
+	 count: size_t, the number of points to generate
+   RETURN: void
+
+To generate uniform random rotations as unit quaternions
+ call FillQuaternionRand(rng, w, x, y, z, count)
+	 w: floating_type*, the buffer to fill with the scalar parts of the quaternions
+	 x, y, z: floating_type*, the buffers to fill with the vector parts of the quaternions
+	 count: size_t, the number of quaternions to generate
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGGEOMETRY_H
+#define RNGGEOMETRY_H
+
+// Include the header defining the shared bulk primitives and the bulk normal fill
+#include "RNGBulk.h"
+
+// Define a templated function to generate uniform points strictly inside the unit disk by Marsaglia's rejection, also storing the
+//		squared radius of every point (if a buffer is provided) for the functions that build on the disk
+template<typename engine_type, typename floating_type> void RNGFillDiskCandidates(engine_type& rng, floating_type* x, floating_type* y, floating_type* radii, size_t count) {
+	// engine_type& rng;		// The generator to pull bits from. Passed by reference
+	// floating_type* x;		// The buffer to fill with the first coordinates. Passed
+	// floating_type* y;		// The buffer to fill with the second coordinates. Passed
+	// floating_type* radii;	// The buffer to fill with the squared radii, or nullptr if they aren't needed. Passed
+	// size_t count;			// The number of points to generate. Passed
+	constexpr size_t pairs = RNGBulkBlockSize / 2;	// The number of candidates generated per block
+	unsigned long long bits[RNGBulkBlockSize];		// The block of random bits currently being converted
+	floating_type candidate_x[pairs];				// The first coordinates of the current candidates
+	floating_type candidate_y[pairs];				// The second coordinates of the current candidates
+	floating_type candidate_radii[pairs];			// The squared radii of the current candidates
+	size_t written = 0;								// The number of points written so far
+
+	// Ensure that the provided types are usable
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for the geometry functions must be floating-point");
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for the geometry functions must have a 64-bit result_type");
+
+	while (written < count) {
+		// Generate a block of candidates in the square [-1, 1)². NOTE: No branches, so this loop is vectorized
+		rng.Fill(bits, RNGBulkBlockSize);
+		for (size_t i = 0; i < pairs; i++) {
+			candidate_x[i] = 2 * RNGBitsToUnit<floating_type>(bits[2 * i]) - 1;
+			candidate_y[i] = 2 * RNGBitsToUnit<floating_type>(bits[2 * i + 1]) - 1;
+			candidate_radii[i] = candidate_x[i] * candidate_x[i] + candidate_y[i] * candidate_y[i];
+		} // End for(i)
+
+		// Compact the candidates inside the disk into the output. NOTE: The origin is rejected too, since it has no direction
+		for (size_t i = 0; i < pairs && written < count; i++) {
+			if (candidate_radii[i] < 1 && candidate_radii[i] > 0) {
+				x[written] = candidate_x[i];
+				y[written] = candidate_y[i];
+				if (radii) { radii[written] = candidate_radii[i]; }
+				written++;
+			} // End if(candidate_radii[i] < 1 && candidate_radii[i] > 0)
+		} // End for(i)
+	} // End while(written < count)
+}
+// End RNGFillDiskCandidates<engine_type, floating_type> function
+
+// Define a templated function to generate uniform points in the unit disk
+template<typename engine_type, typename floating_type> void FillUnitDiskRand(engine_type& rng, floating_type* x, floating_type* y, size_t count) {
+	// engine_type& rng;	// The generator to pull bits from. Passed by reference
+	// floating_type* x;	// The buffer to fill with the first coordinates. Passed
+	// floating_type* y;	// The buffer to fill with the second coordinates. Passed
+	// size_t count;		// The number of points to generate. Passed
+
+	RNGFillDiskCandidates(rng, x, y, (floating_type*)nullptr, count);
+}
+// End FillUnitDiskRand<engine_type, floating_type> function
+
+// Define a templated function to generate uniform points on the unit sphere using Marsaglia's method: a point (a, b) with squared
+//		radius s in the unit disk maps to (2a√(1 - s), 2b√(1 - s), 1 - 2s)
+template<typename engine_type, typename floating_type> void FillUnitSphereRand(engine_type& rng, floating_type* x, floating_type* y, floating_type* z, size_t count) {
+	// engine_type& rng;	// The generator to pull bits from. Passed by reference
+	// floating_type* x;	// The buffer to fill with the first coordinates. Passed
+	// floating_type* y;	// The buffer to fill with the second coordinates. Passed
+	// floating_type* z;	// The buffer to fill with the third coordinates. Passed
+	// size_t count;		// The number of points to generate. Passed
+	floating_type scale;	// The factor mapping the disk coordinates onto the sphere
+
+	// Use the z buffer to hold the squared radii until they're mapped
+	RNGFillDiskCandidates(rng, x, y, z, count);
+	for (size_t i = 0; i < count; i++) {
+		scale = 2 * std::sqrt(1 - z[i]);
+		x[i] *= scale;
+		y[i] *= scale;
+		z[i] = 1 - 2 * z[i];
+	} // End for(i)
+}
+// End FillUnitSphereRand<engine_type, floating_type> function
+
+// Define a templated function to generate uniform points in the unit ball by scaling points on the sphere by the cube root of a
+//		uniform number
+template<typename engine_type, typename floating_type> void FillUnitBallRand(engine_type& rng, floating_type* x, floating_type* y, floating_type* z, size_t count) {
+	// engine_type& rng;	// The generator to pull bits from. Passed by reference
+	// floating_type* x;	// The buffer to fill with the first coordinates. Passed
+	// floating_type* y;	// The buffer to fill with the second coordinates. Passed
+	// floating_type* z;	// The buffer to fill with the third coordinates. Passed
+	// size_t count;		// The number of points to generate. Passed
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random bits used for the radii
+	floating_type radius;						// The radius of the current point
+	size_t block;								// The number of points scaled from the current block
+
+	FillUnitSphereRand(rng, x, y, z, count);
+	for (size_t done = 0; done < count; done += block) {
+		block = (count - done < RNGBulkBlockSize) ? count - done : RNGBulkBlockSize;
+		rng.Fill(bits, block);
+		for (size_t i = 0; i < block; i++) {
+			radius = std::cbrt(RNGBitsToUnit<floating_type>(bits[i]));
+			x[done + i] *= radius;
+			y[done + i] *= radius;
+			z[done + i] *= radius;
+		} // End for(i)
+	} // End for(done)
+}
+// End FillUnitBallRand<engine_type, floating_type> function
+
+// Define a templated function to generate uniform points on the unit hypersphere of the provided dimension by normalizing vectors
+//		of independent normal numbers
+template<typename engine_type, typename floating_type> void FillUnitHypersphereRand(engine_type& rng, floating_type* const* coordinates, size_t dimensions, size_t count) {
+	// engine_type& rng;						// The generator to pull bits from. Passed by reference
+	// floating_type* const* coordinates;		// The buffers to fill, one per coordinate. Passed
+	// size_t dimensions;						// The number of coordinates of every point. Passed
+	// size_t count;							// The number of points to generate. Passed
+	floating_type lengths[RNGBulkBlockSize];	// The squared lengths of the points of the current block
+	size_t block;								// The number of points normalized in the current block
+
+	// Ensure that the points have at least one coordinate
+	assert(("A hypersphere must have at least one dimension", dimensions > 0));
+
+	// Work on one block of points at a time, so the squared lengths stay in the cache
+	for (size_t done = 0; done < count; done += block) {
+		block = (count - done < RNGBulkBlockSize) ? count - done : RNGBulkBlockSize;
+
+		// Fill every coordinate with normal numbers and sum their squares. NOTE: Both loops run along a single coordinate buffer,
+		//		so they are vectorized
+		for (size_t i = 0; i < block; i++) { lengths[i] = 0; }
+		for (size_t d = 0; d < dimensions; d++) {
+			FillNormalRand(rng, coordinates[d] + done, block, (floating_type)0, (floating_type)1);
+			for (size_t i = 0; i < block; i++) { lengths[i] += coordinates[d][done + i] * coordinates[d][done + i]; }
+		} // End for(d)
+
+		// Regenerate the (astronomically unlikely) points that landed on the origin, which have no direction
+		for (size_t i = 0; i < block; i++) {
+			while (lengths[i] == 0) {
+				for (size_t d = 0; d < dimensions; d++) {
+					FillNormalRand(rng, coordinates[d] + done + i, 1, (floating_type)0, (floating_type)1);
+					lengths[i] += coordinates[d][done + i] * coordinates[d][done + i];
+				} // End for(d)
+			} // End while(lengths[i] == 0)
+		} // End for(i)
+
+		// Normalize the points
+		for (size_t i = 0; i < block; i++) { lengths[i] = 1 / std::sqrt(lengths[i]); }
+		for (size_t d = 0; d < dimensions; d++) {
+			for (size_t i = 0; i < block; i++) { coordinates[d][done + i] *= lengths[i]; }
+		} // End for(d)
+	} // End for(done)
+}
+// End FillUnitHypersphereRand<engine_type, floating_type> function
+
+// Define a templated function to generate uniform points in the unit hyperball of the provided dimension by scaling points on the
+//		hypersphere by the dimensions-th root of a uniform number
+template<typename engine_type, typename floating_type> void FillUnitHyperballRand(engine_type& rng, floating_type* const* coordinates, size_t dimensions, size_t count) {
+	// engine_type& rng;						// The generator to pull bits from. Passed by reference
+	// floating_type* const* coordinates;		// The buffers to fill, one per coordinate. Passed
+	// size_t dimensions;						// The number of coordinates of every point. Passed
+	// size_t count;							// The number of points to generate. Passed
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random bits used for the radii
+	floating_type radii[RNGBulkBlockSize];		// The radii of the points of the current block
+	floating_type exponent = (floating_type)1 / (floating_type)dimensions; // The exponent turning uniform numbers into radii
+	size_t block;								// The number of points scaled in the current block
+
+	FillUnitHypersphereRand(rng, coordinates, dimensions, count);
+	for (size_t done = 0; done < count; done += block) {
+		block = (count - done < RNGBulkBlockSize) ? count - done : RNGBulkBlockSize;
+		rng.Fill(bits, block);
+		for (size_t i = 0; i < block; i++) { radii[i] = std::pow(RNGBitsToUnit<floating_type>(bits[i]), exponent); }
+		for (size_t d = 0; d < dimensions; d++) {
+			for (size_t i = 0; i < block; i++) { coordinates[d][done + i] *= radii[i]; }
+		} // End for(d)
+	} // End for(done)
+}
+// End FillUnitHyperballRand<engine_type, floating_type> function
+
+// Define a templated function to generate uniform random rotations as unit quaternions using Shoemake's method: for uniform
+//		numbers u1, u2 and u3, the quaternion (√u1 cos 2πu3, √(1 - u1) sin 2πu2, √(1 - u1) cos 2πu2, √u1 sin 2πu3) is uniform
+template<typename engine_type, typename floating_type> void FillQuaternionRand(engine_type& rng, floating_type* w, floating_type* x, floating_type* y, floating_type* z, size_t count) {
+	// engine_type& rng;	// The generator to pull bits from. Passed by reference
+	// floating_type* w;	// The buffer to fill with the scalar parts. Passed
+	// floating_type* x;	// The buffer to fill with the first vector parts. Passed
+	// floating_type* y;	// The buffer to fill with the second vector parts. Passed
+	// floating_type* z;	// The buffer to fill with the third vector parts. Passed
+	// size_t count;		// The number of quaternions to generate. Passed
+	constexpr size_t triples = RNGBulkBlockSize / 3;	// The number of quaternions generated per block
+	unsigned long long bits[RNGBulkBlockSize];			// The block of random bits currently being converted
+	floating_type split;								// The uniform number splitting the length between the two halves
+	floating_type first_angle;							// The angle of the vector half
+	floating_type second_angle;							// The angle of the scalar half
+	floating_type first_length;							// The length of the vector half
+	floating_type second_length;						// The length of the scalar half
+	size_t block;										// The number of quaternions generated from the current block
+
+	// Ensure that the provided types are usable
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for FillQuaternionRand must be floating-point");
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for FillQuaternionRand must have a 64-bit result_type");
+
+	for (size_t done = 0; done < count; done += block) {
+		block = (count - done < triples) ? count - done : triples;
+		rng.Fill(bits, 3 * block);
+		for (size_t i = 0; i < block; i++) {
+			split = RNGBitsToUnit<floating_type>(bits[3 * i]);
+			first_angle = (floating_type)RNGTwoPi * RNGBitsToUnit<floating_type>(bits[3 * i + 1]);
+			second_angle = (floating_type)RNGTwoPi * RNGBitsToUnit<floating_type>(bits[3 * i + 2]);
+			first_length = std::sqrt(1 - split);
+			second_length = std::sqrt(split);
+			w[done + i] = second_length * std::cos(second_angle);
+			x[done + i] = first_length * std::sin(first_angle);
+			y[done + i] = first_length * std::cos(first_angle);
+			z[done + i] = second_length * std::sin(second_angle);
+		} // End for(i)
+	} // End for(done)
+}
+// End FillQuaternionRand<engine_type, floating_type> function
+#endif
@@ -0,0 +1,348 @@
+﻿// RNGGraphs.h - This header declares the GraphEdge structure and the ErdosRenyiGenerator, BarabasiAlbertGenerator and
+//		RMATGenerator classes, and implements them, as well as defining the templated GenerateGraphParallel function
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Every generator produces its edges in batches: Generate(edges, capacity) writes up to capacity edges into the buffer (which may
+	be a memory-mapped file) and returns how many it wrote, 0 meaning that the generator is finished. Nodes are numbered from 0.
+
+- Every generator can be split into parts: the part with index "part" of "parts" produces its own share of the edges from its own
+	substream of the provided SeededRNGClass instance, so the parts can be generated by different threads with no communication.
+	GenerateGraphParallel does exactly this, with one thread per part.
+
+- ErdosRenyiGenerator (G(n, p)) jumps over the pairs that are not edges with geometrically distributed skips (Batagelj and
+	Brandes), so it costs O(n + edges) instead of O(n²). Its parts split the pairs, so the graph depends on the seed AND the number
+	of parts.
+
+- BarabasiAlbertGenerator (preferential attachment) connects every new node to edges_per_node earlier endpoints chosen uniformly
+	among all endpoints of earlier edges (Batagelj and Brandes' edge list formulation). The random choice of every edge is derived
+	from the edge's own substream, so earlier edges can be resolved on the fly instead of being stored (Sanders and Schulz), and the
+	graph only depends on the seed. As in the original model, the graph may contain multi-edges, and the first edge is a self-loop
+	of node 0.
+
+- RMATGenerator places every edge by descending scale levels of the adjacency matrix, choosing one of the four quadrants at
+	every level with probabilities a, b, c and d (recursive matrix / Kronecker graphs). Its parts split the edges, so the graph
+	depends on the seed AND the number of parts. The quadrant probabilities are applied with 32-bit precision.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a SeededRNGClass<unsigned long long> instance, and "generator" as the identifier
+	for a generator instance. For every generator, part (the index of the part to generate) and parts (the number of parts) can
+	be omitted, in which case they become 0 and 1
+
+To create a G(n, p) generator
+  declare ErdosRenyiGenerator identifier(rng, nodes, probability, directed, part, parts)
+	nodes: unsigned long long, the number of nodes
+	probability: double, the probability of every pair of nodes being an edge
+	directed: bool, whether or not (u, v) and (v, u) are different edges (self-loops are never generated). If omitted, it becomes
+		false, and every edge is generated as (u, v) with u > v
+
+To create a preferential attachment generator
+  declare BarabasiAlbertGenerator identifier(rng, nodes, edges_per_node, part, parts)
+	nodes: unsigned long long, the number of nodes
+	edges_per_node: unsigned long long, the number of edges every node adds, each from the new node to an earlier one
+
+To create an R-MAT generator
+  declare RMATGenerator identifier(rng, scale, edge_count, a, b, c, part, parts)
+	scale: unsigned int, the base 2 logarithm of the number of nodes (at most 63)
+	edge_count: unsigned long long, the number of edges to generate (over all parts)
+	a, b, c: double, the probabilities of the top left, top right and bottom left quadrants (the bottom right one gets the rest)
+
+To generate the next batch of edges
+ Call generator.Generate(edges, capacity)
+	 edges: GraphEdge*, the buffer to fill
+	 capacity: size_t, the maximum number of edges to write
+   RETURN: size_t, the number of edges written. 0 once the generator is finished
+
+To generate every part of a graph in parallel
+ call GenerateGraphParallel(generators, sink, batch)
+	 generators: std::vector<generator_type>&, one generator per part (e.g. created with part = 0 to parts - 1)
+	 sink: a callable taking (size_t part, const GraphEdge* edges, size_t count), called by the thread of every part for every
+		batch it generates. NOTE: Called concurrently by different threads
+	 batch: size_t, the number of edges per batch. If omitted, it becomes 65536
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGGRAPHS_H
+#define RNGGRAPHS_H
+
+// If necessary, include the header to allow vectors
+#ifndef _VECTOR_
+#include <vector>
+#endif
+// If necessary, include the header to allow threads
+#ifndef _THREAD_
+#include <thread>
+#endif
+// Include the header declaring SeededRNGClass, which provides the per-part streams
+#include "SeededRNGClass.h"
+
+// Define the structure holding one edge of a graph
+struct GraphEdge {
+	unsigned long long source;	// The node the edge starts from
+	unsigned long long target;	// The node the edge ends at
+}; // End struct GraphEdge
+
+class ErdosRenyiGenerator {
+public:
+	// Define the constructor to prepare the provided part of the graph
+	ErdosRenyiGenerator(const SeededRNGClass<unsigned long long>& rng, unsigned long long nodes, double probability, bool directed = false, size_t part = 0, size_t parts = 1)
+		: stream(rng.Substream(part)), nodes(nodes), directed(directed), finished(false) {
+		// unsigned long long nodes;	// The number of nodes. Passed
+		// double probability;			// The probability of every pair of nodes being an edge. Passed
+		// bool directed;				// Boolean for whether or not the graph is directed. Passed. False if omitted
+		// size_t part;					// The index of the part to generate. Passed. 0 if omitted
+		// size_t parts;				// The number of parts. Passed. 1 if omitted
+		unsigned long long pairs;		// The number of possible edges
+
+		// Ensure that the parameters are valid
+		assert(("The probability of an edge must be in the set [0, 1]", probability >= 0 && probability <= 1));
+		assert(("The part must be one of the parts", part < parts));
+
+		// Number the possible edges: (u, v) with u > v is v + u(u - 1) / 2 when undirected, and skips the diagonal when directed
+		pairs = (nodes < 2) ? 0 : (directed ? nodes * (nodes - 1) : (nodes % 2 == 0 ? (nodes / 2) * (nodes - 1) : nodes * ((nodes - 1) / 2)));
+		this->next = RNGPartStart(pairs, part, parts);
+		this->end = RNGPartStart(pairs, part + 1, parts);
+		this->always = probability >= 1;
+		this->log_miss = std::log1p(-probability);
+		if (probability <= 0 || this->next >= this->end) { this->finished = true; }
+	}
+
+	// **** Define non-const methods ****
+
+	// Define a method to generate the next batch of edges
+	size_t Generate(GraphEdge* edges, size_t capacity) {
+		// GraphEdge* edges;	// The buffer to fill. Passed
+		// size_t capacity;		// The maximum number of edges to write. Passed
+		size_t written = 0;		// The number of edges written
+
+		while (written < capacity && !this->finished) {
+			// Skip the pairs that are not edges. NOTE: The number of failures before a success is floor(log(u) / log(1 - p))
+			double skip = this->always ? 0 : std::floor(std::log(RNGBitsToOpenUnit<double>(this->stream())) / this->log_miss);
+			if (skip >= (double)(this->end - this->next)) {
+				this->finished = true;
+				break;
+			} // End if(skip >= (double)(this->end - this->next))
+			this->Advance((unsigned long long)skip);
+
+			// Write the edge, then move past it
+			edges[written++] = { this->row, this->Column() };
+			this->Advance(1);
+			if (this->next >= this->end) { this->finished = true; }
+		} // End while(written < capacity && !this->finished)
+
+		return written;
+	}
+	// End ErdosRenyiGenerator::Generate method
+
+	// **** Define const methods ****
+
+	// Define a method to return whether or not the part is finished
+	bool Finished() const { return this->finished; }
+
+protected:
+	// Define a method to move the current pair forward, keeping its row and offset within the row up to date
+	void Advance(unsigned long long count) {
+		// unsigned long long count; // The number of pairs to move forward. Passed
+
+		this->next += count;
+
+		// If the position hasn't been located yet (or the move is a long jump), locate it from scratch
+		if (!this->located || count > this->nodes) {
+			this->Locate();
+			return;
+		} // End if(!this->located || count > this->nodes)
+
+		// Otherwise, walk the offset across the rows it passes
+		this->offset += count;
+		while (this->offset >= this->Width(this->row) && this->row < this->nodes) {
+			this->offset -= this->Width(this->row);
+			this->row++;
+		} // End while(this->offset >= this->Width(this->row) && this->row < this->nodes)
+	}
+	// End ErdosRenyiGenerator::Advance method
+
+	// Define a method to calculate the row and offset of the current pair from its index
+	void Locate() {
+		this->located = true;
+		if (this->directed) {
+			this->row = this->next / (this->nodes - 1);
+			this->offset = this->next % (this->nodes - 1);
+			return;
+		} // End if(this->directed)
+
+		// Invert u(u - 1) / 2 ≤ index with a square root, then correct any rounding error
+		this->row = (unsigned long long)((1 + std::sqrt(1 + 8 * (double)this->next)) / 2);
+		while (this->row > 1 && this->Triangle(this->row) > this->next) { this->row--; }
+		while (this->Triangle(this->row + 1) <= this->next) { this->row++; }
+		this->offset = this->next - this->Triangle(this->row);
+	}
+	// End ErdosRenyiGenerator::Locate method
+
+	// Define a method to return the number of pairs in a row: every other node when directed, the u lower nodes when undirected
+	unsigned long long Width(unsigned long long row) const { return this->directed ? this->nodes - 1 : row; }
+
+	// Define a method to return the target node of the current pair. NOTE: Directed rows skip the diagonal
+	unsigned long long Column() const { return (this->directed && this->offset >= this->row) ? this->offset + 1 : this->offset; }
+
+	// Define a method to return the index of the first pair of a row of the undirected graph, u(u - 1) / 2
+	unsigned long long Triangle(unsigned long long row) const { return (row % 2 == 0) ? (row / 2) * (row - 1) : row * ((row - 1) / 2); }
+
+	SeededRNGClass<unsigned long long> stream;	// The stream of the part
+	unsigned long long nodes;					// The number of nodes
+	unsigned long long next;					// The index of the current pair
+	unsigned long long end;						// The index of the first pair after the part
+	unsigned long long row = 0;					// The source node of the current pair
+	unsigned long long offset = 0;				// The position of the current pair within its row
+	double log_miss;							// The logarithm of the probability of a pair not being an edge
+	bool directed;								// Boolean for whether or not the graph is directed
+	bool always;								// Boolean for whether or not every pair is an edge
+	bool finished;								// Boolean for whether or not the part is finished
+	bool located = false;						// Boolean for whether or not the row and offset match the current pair
+}; // End class ErdosRenyiGenerator
+
+class BarabasiAlbertGenerator {
+public:
+	// Define the constructor to prepare the provided part of the graph
+	BarabasiAlbertGenerator(const SeededRNGClass<unsigned long long>& rng, unsigned long long nodes, unsigned long long edges_per_node, size_t part = 0, size_t parts = 1)
+		: root(rng), edges_per_node(edges_per_node) {
+		// Ensure that the parameters are valid
+		assert(("Every node must add at least one edge", edges_per_node > 0));
+		assert(("The part must be one of the parts", part < parts));
+
+		this->next = RNGPartStart(nodes * edges_per_node, part, parts);
+		this->end = RNGPartStart(nodes * edges_per_node, part + 1, parts);
+	}
+
+	// **** Define non-const methods ****
+
+	// Define a method to generate the next batch of edges
+	size_t Generate(GraphEdge* edges, size_t capacity) {
+		// GraphEdge* edges;	// The buffer to fill. Passed
+		// size_t capacity;		// The maximum number of edges to write. Passed
+		size_t written = 0;		// The number of edges written
+
+		for (; written < capacity && this->next < this->end; written++, this->next++) {
+			edges[written] = { this->next / this->edges_per_node, this->Target(this->next) };
+		} // End for(; written < capacity && this->next < this->end; written++, this->next++)
+
+		return written;
+	}
+	// End BarabasiAlbertGenerator::Generate method
+
+	// **** Define const methods ****
+
+	// Define a method to return whether or not the part is finished
+	bool Finished() const { return this->next >= this->end; }
+
+protected:
+	// Define a method to resolve the target of an edge. Endpoint 2i of the edge list is the source of edge i (known), and endpoint
+	//		2i + 1 is its target, a copy of an endpoint chosen uniformly from the 2i endpoints of the earlier edges
+	unsigned long long Target(unsigned long long edge) const {
+		// unsigned long long edge; // The index of the edge. Passed
+
+		while (edge > 0) {
+			SeededRNGClass<unsigned long long> choice = this->root.Substream(edge); // The stream of the edge's choice
+			unsigned long long endpoint = RNGBoundedRand(choice, 2 * edge);			// The endpoint copied
+
+			// A source is known directly, a target has to be resolved from its own edge (which is earlier, so this ends)
+			if (endpoint % 2 == 0) { return (endpoint / 2) / this->edges_per_node; }
+			edge = endpoint / 2;
+		} // End while(edge > 0)
+
+		// The first edge has no earlier endpoints, so it's a self-loop of node 0
+		return 0;
+	}
+	// End BarabasiAlbertGenerator::Target method
+
+	SeededRNGClass<unsigned long long> root;	// The stream the choice of every edge is split off from
+	unsigned long long edges_per_node;			// The number of edges every node adds
+	unsigned long long next;					// The index of the next edge of the part
+	unsigned long long end;						// The index of the first edge after the part
+}; // End class BarabasiAlbertGenerator
+
+class RMATGenerator {
+public:
+	// Define the constructor to prepare the provided part of the graph
+	RMATGenerator(const SeededRNGClass<unsigned long long>& rng, unsigned int scale, unsigned long long edge_count, double a, double b, double c, size_t part = 0, size_t parts = 1)
+		: stream(rng.Substream(part)), scale(scale) {
+		// Ensure that the parameters are valid
+		assert(("The scale of an R-MAT graph must be in the set [1, 63]", scale >= 1 && scale <= 63));
+		assert(("The quadrant probabilities must be non-negative and sum to at most 1", a >= 0 && b >= 0 && c >= 0 && a + b + c <= 1));
+		assert(("The part must be one of the parts", part < parts));
+
+		// Convert the cumulative probabilities to 32-bit thresholds
+		this->thresholds[0] = RMATGenerator::Threshold(a);
+		this->thresholds[1] = RMATGenerator::Threshold(a + b);
+		this->thresholds[2] = RMATGenerator::Threshold(a + b + c);
+		this->remaining = RNGPartStart(edge_count, part + 1, parts) - RNGPartStart(edge_count, part, parts);
+	}
+
+	// **** Define non-const methods ****
+
+	// Define a method to generate the next batch of edges
+	size_t Generate(GraphEdge* edges, size_t capacity) {
+		// GraphEdge* edges;	// The buffer to fill. Passed
+		// size_t capacity;		// The maximum number of edges to write. Passed
+		unsigned int words = (this->scale + 1) / 2;					// The number of 64-bit words used per edge (two levels each)
+		size_t per_block = RNGBulkBlockSize / words;				// The number of edges generated per block of words
+		unsigned long long bits[RNGBulkBlockSize];					// The block of random bits currently being used
+		size_t total = (this->remaining < capacity) ? (size_t)this->remaining : capacity; // The number of edges to write
+		size_t block;												// The number of edges generated from the current block
+
+		for (size_t done = 0; done < total; done += block) {
+			block = (total - done < per_block) ? total - done : per_block;
+			this->stream.Fill(bits, block * words);
+
+			// Descend the levels of every edge, using 32 bits of randomness per level
+			for (size_t i = 0; i < block; i++) {
+				unsigned long long source = 0, target = 0; // The coordinates of the edge in the adjacency matrix
+				for (unsigned int level = 0; level < this->scale; level++) {
+					unsigned int lane = (unsigned int)(bits[i * words + level / 2] >> (32 * (level % 2))); // The level's 32 bits
+					unsigned int quadrant = (lane >= this->thresholds[0]) + (lane >= this->thresholds[1]) + (lane >= this->thresholds[2]);
+					source = (source << 1) | (quadrant >> 1);
+					target = (target << 1) | (quadrant & 1);
+				} // End for(level)
+				edges[done + i] = { source, target };
+			} // End for(i)
+		} // End for(done)
+
+		this->remaining -= total;
+		return total;
+	}
+	// End RMATGenerator::Generate method
+
+	// **** Define const methods ****
+
+	// Define a method to return whether or not the part is finished
+	bool Finished() const { return this->remaining == 0; }
+
+protected:
+	// Define a method to convert a cumulative probability to the 32-bit number below which it is reached
+	static unsigned long long Threshold(double probability) { return (probability >= 1) ? (1ULL << 32) : (unsigned long long)(probability * 4294967296.0); }
+
+	SeededRNGClass<unsigned long long> stream;	// The stream of the part
+	unsigned int scale;							// The base 2 logarithm of the number of nodes
+	unsigned long long thresholds[3];			// The 32-bit thresholds of the cumulative quadrant probabilities
+	unsigned long long remaining;				// The number of edges the part still has to generate
+}; // End class RMATGenerator
+
+// Define a templated function to generate every part of a graph in parallel, one thread per part, passing every batch to the sink
+template<typename generator_type, typename sink_type> void GenerateGraphParallel(std::vector<generator_type>& generators, sink_type sink, size_t batch = 65536) {
+	// std::vector<generator_type>& generators;	// One generator per part. Passed by reference
+	// sink_type sink;							// The callable receiving (part, edges, count) for every batch. Passed
+	// size_t batch;							// The number of edges per batch. Passed. 65536 if omitted
+	std::vector<std::thread> threads;			// The thread of every part
+
+	for (size_t part = 0; part < generators.size(); part++) {
+		threads.emplace_back([&generators, &sink, batch, part]() {
+			std::vector<GraphEdge> edges(batch); // The buffer of the part's current batch
+			size_t count; // The number of edges of the current batch
+			while ((count = generators[part].Generate(edges.data(), batch)) > 0) { sink(part, (const GraphEdge*)edges.data(), count); }
+		});
+	} // End for(part)
+
+	for (std::thread& thread : threads) { thread.join(); }
+}
+// End GenerateGraphParallel<generator_type, sink_type> function
+#endif
@@ -0,0 +1,250 @@
+﻿// RNGHalf.h - This header defines the conversions between single precision and the 16-bit floating-point formats (IEEE half
+//		precision and bfloat16), and the templated functions used to fill buffers of them with uniform and normal numbers
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- C++17 has no 16-bit floating-point types, so numbers are stored as their 16-bit patterns (unsigned short). Where the compiler
+	provides _Float16, std::float16_t or a bfloat16 type with the standard layout, the buffer can be reinterpreted as such.
+
+- Numbers are built from only the random bits they need instead of generating doubles and narrowing them: a uniform number uses
+	24 random bits (the upper 24 bits of a 32-bit lane, two lanes per 64-bit random word), the full precision of a float, and a
+	pair of normal numbers uses a single 64-bit random word (32 bits for the radius and 32 for the angle, so the tails reach 6.6
+	standard deviations).
+
+- The arithmetic is done in single precision and converted with round-to-nearest-even. A uniform number is then truncated onto
+	the 16-bit grid (stepped down to the next lower number if it rounded up), so every representable number of [floor, roof)
+	whose interval up to its successor is at least span * 2^-24 wide gets exactly the mass of that interval, as with
+	FillFloatingRand. Over [0, 1) that is every half precision number (subnormals included), but only the bfloat16 numbers of at
+	least 2^-17: below that, bfloat16 is finer than the 24 random bits, so only multiples of 2^-24 are produced. A floor that
+	isn't representable merges its partial interval into the next number. The conversions are branch-free (special cases are
+	handled with selects), so the fill loops vectorize.
+
+- The float to half precision conversion rounds subnormal results by adding 0.5f, which relies on the default rounding mode and
+	on the compiler not reassociating floating-point additions (i.e. no fast-math flags).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type
+
+To convert a float to half precision or bfloat16 (rounding to nearest even)
+ call RNGFloatToFloat16(number) or RNGFloatToBFloat16(number)
+	 number: float, the number to convert
+   RETURN: unsigned short, the 16-bit pattern
+
+To convert half precision or bfloat16 to a float (exactly)
+ call RNGFloat16ToFloat(bits) or RNGBFloat16ToFloat(bits)
+	 bits: unsigned short, the 16-bit pattern
+   RETURN: float
+
+To fill a buffer with uniform numbers in the set { number | floor ≤ number < roof }
+ call FillFloat16Rand(rng, numbers, count, floor, roof) or FillBFloat16Rand(rng, numbers, count, floor, roof)
+	 numbers: unsigned short*, the buffer to fill with 16-bit patterns
+	 count: size_t, the number of numbers to write
+	 floor: float, the minimum possible number. If omitted, it becomes 0
+	 roof: float, the upper bound of the numbers (excluded). If omitted, it becomes 1
+   RETURN: void
+
+To fill a buffer with normally distributed numbers
+ call FillFloat16NormalRand(rng, numbers, count, mean, deviation) or FillBFloat16NormalRand(rng, numbers, count, mean, deviation)
+	 numbers: unsigned short*, the buffer to fill with 16-bit patterns
+	 count: size_t, the number of numbers to write
+	 mean: float, the mean of the distribution. If omitted, it becomes 0
+	 deviation: float, the standard deviation of the distribution. If omitted, it becomes 1
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGHALF_H
+#define RNGHALF_H
+
+// If necessary, include the header to allow copying memory (used to reinterpret floats as bits)
+#ifndef _CSTRING_
+#include <cstring>
+#endif
+// Include the header defining the shared bulk primitives
+#include "RNGBulk.h"
+
+// Define a function to convert a float to the nearest half precision number (ties to even), returning its bits
+inline unsigned short RNGFloatToFloat16(float number) {
+	// float number; // The number to convert. Passed
+	unsigned int bits;			// The bits of the number
+	unsigned int magnitude;		// The bits of the absolute value
+	unsigned int normal;		// The result if it is a normal number
+	unsigned int subnormal;		// The result if it is subnormal (or zero)
+	float shifted;				// The absolute value plus 0.5, which rounds it to a multiple of 2^-24
+
+	std::memcpy(&bits, &number, sizeof(bits));
+	magnitude = bits & 0x7FFFFFFFu;
+
+	// Rebias the exponent from 127 to 15, rounding the 13 discarded mantissa bits to nearest even
+	normal = (magnitude - 0x38000000u + 0xFFFu + ((magnitude >> 13) & 1)) >> 13;
+
+	// Below 2^-14, let the addition round to the spacing of the subnormal numbers, which leaves their bits in the mantissa
+	shifted = std::fabs(number) + 0.5f;
+	std::memcpy(&subnormal, &shifted, sizeof(subnormal));
+	subnormal -= 0x3F000000u;
+
+	normal = (magnitude < 0x38800000u) ? subnormal : normal;
+	normal = (magnitude >= 0x477FF000u) ? 0x7C00u : normal;
+	normal = (magnitude > 0x7F800000u) ? 0x7E00u : normal;
+	return (unsigned short)(((bits >> 16) & 0x8000u) | normal);
+}
+// End RNGFloatToFloat16 function
+
+// Define a function to convert half precision bits to a float (exactly)
+inline float RNGFloat16ToFloat(unsigned short bits) {
+	// unsigned short bits; // The bits to convert. Passed
+	unsigned int magnitude = bits & 0x7FFFu;	// The bits of the absolute value
+	unsigned int result;						// The bits of the float
+	float subnormal = (float)magnitude * (1.0f / 16777216.0f); // The value if it is subnormal (or zero)
+	float number;								// The float to return
+
+	// Rebias the exponent from 15 to 127, moving infinities and NaNs to the maximum exponent
+	result = (magnitude << 13) + ((magnitude >= 0x7C00u) ? 0x70000000u : 0x38000000u);
+	std::memcpy(&number, &result, sizeof(number));
+	number = (magnitude < 0x400u) ? subnormal : number;
+	return (bits & 0x8000u) ? -number : number;
+}
+// End RNGFloat16ToFloat function
+
+// Define a function to convert a float to the nearest bfloat16 number (ties to even), returning its bits
+inline unsigned short RNGFloatToBFloat16(float number) {
+	// float number; // The number to convert. Passed
+	unsigned int bits; // The bits of the number
+
+	std::memcpy(&bits, &number, sizeof(bits));
+
+	// NOTE: NaNs are truncated and quietened instead of rounded, so their payload can't carry into the exponent
+	return (unsigned short)(((bits & 0x7FFFFFFFu) > 0x7F800000u) ? ((bits >> 16) | 0x40u) : ((bits + 0x7FFFu + ((bits >> 16) & 1)) >> 16));
+}
+// End RNGFloatToBFloat16 function
+
+// Define a function to convert bfloat16 bits to a float (exactly)
+inline float RNGBFloat16ToFloat(unsigned short bits) {
+	// unsigned short bits; // The bits to convert. Passed
+	unsigned int result = (unsigned int)bits << 16;	// The bits of the float
+	float number;										// The float to return
+
+	std::memcpy(&number, &result, sizeof(number));
+	return number;
+}
+// End RNGBFloat16ToFloat function
+
+// Define a templated function to convert a float to the nearest number of either 16-bit format (ties to even), returning its bits
+template<bool brain_float> inline unsigned short RNGHalfFromFloat(float number) {
+	if constexpr (brain_float) { return RNGFloatToBFloat16(number); }
+	else { return RNGFloatToFloat16(number); }
+}
+// End RNGHalfFromFloat<brain_float> function
+
+// Define a templated function to convert the bits of either 16-bit format to a float (exactly)
+template<bool brain_float> inline float RNGHalfToFloat(unsigned short bits) {
+	if constexpr (brain_float) { return RNGBFloat16ToFloat(bits); }
+	else { return RNGFloat16ToFloat(bits); }
+}
+// End RNGHalfToFloat<brain_float> function
+
+// Define a templated function to fill a buffer of either 16-bit format with uniform numbers in the set [floor, roof)
+template<bool brain_float, typename engine_type> void RNGFillHalfRand(engine_type& rng, unsigned short* numbers, size_t count, float floor, float roof) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// unsigned short* numbers;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to write. Passed
+	// float floor;					// The minimum possible number. Passed
+	// float roof;					// The upper bound of the numbers (excluded). Passed
+	unsigned long long bits[RNGBulkBlockSize];		// The block of random words currently being converted
+	unsigned int lanes[RNGBulkBlockSize * 2];		// The 32-bit lanes of the random words
+	float span = roof - floor;						// The width of the range
+	size_t block;									// The number of numbers converted from the current block
+
+	// Ensure that the provided generator and bounds are usable
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for the 16-bit fills must have a 64-bit result_type");
+	assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
+
+	while (count > 0) {
+		block = (count < RNGBulkBlockSize * 2) ? count : RNGBulkBlockSize * 2;
+		rng.Fill(bits, (block + 1) / 2);
+		std::memcpy(lanes, bits, block * sizeof(unsigned int));
+
+		for (size_t i = 0; i < block; i++) {
+			float number = floor + span * ((float)(lanes[i] >> 8) * (1.0f / 16777216.0f));	// The uniform number
+			unsigned int rounded = RNGHalfFromFloat<brain_float>(number);			// The bits of the rounded number
+			float value = RNGHalfToFloat<brain_float>((unsigned short)rounded);		// The value of the rounded number
+
+			// If the number rounded up (past itself or to the roof), step down to the next lower number: towards zero if positive,
+			//		away from zero if negative, and from +0 to the negative number closest to zero
+			unsigned int lower = (rounded & 0x8000u) ? rounded + 1 : ((rounded == 0) ? 0x8001u : rounded - 1);
+			rounded = (value > number || value >= roof) ? lower : rounded;
+			value = RNGHalfToFloat<brain_float>((unsigned short)rounded);
+
+			// If truncating went below a floor that isn't representable, step back up: away from zero if positive, towards zero
+			//		if negative, and from -0 to the positive number closest to zero
+			unsigned int upper = (rounded & 0x8000u) ? ((rounded == 0x8000u) ? 0x0001u : rounded - 1) : rounded + 1;
+			numbers[i] = (unsigned short)((value < floor) ? upper : rounded);
+		} // End for(i)
+
+		numbers += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End RNGFillHalfRand<brain_float, engine_type> function
+
+// Define a templated function to fill a buffer of either 16-bit format with normal numbers, using the Box-Muller transform on
+//		one random word per pair
+template<bool brain_float, typename engine_type> void RNGFillHalfNormalRand(engine_type& rng, unsigned short* numbers, size_t count, float mean, float deviation) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// unsigned short* numbers;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to write. Passed
+	// float mean;					// The mean of the distribution. Passed
+	// float deviation;				// The standard deviation of the distribution. Passed
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random words currently being converted
+	float pairs[RNGBulkBlockSize * 2];			// The normal numbers of the current block, before rounding
+	size_t block;								// The number of numbers converted from the current block
+
+	// Ensure that the provided generator is usable
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for the 16-bit fills must have a 64-bit result_type");
+
+	while (count > 0) {
+		block = (count < RNGBulkBlockSize * 2) ? count : RNGBulkBlockSize * 2;
+		rng.Fill(bits, (block + 1) / 2);
+
+		// The upper half gives the radius (never 0, so the logarithm is finite) and the lower half gives the angle. NOTE: An odd
+		//		final number uses the cosine of its pair and discards the sine
+		for (size_t i = 0; i < (block + 1) / 2; i++) {
+			float radius = deviation * std::sqrt(-2 * std::log((float)((bits[i] >> 32) + 1) * (1.0f / 4294967296.0f)));	// The radius of the pair
+			float angle = (float)RNGTwoPi * ((float)(bits[i] & 0xFFFFFFFFu) * (1.0f / 4294967296.0f));					// The angle of the pair
+			pairs[2 * i] = mean + radius * std::cos(angle);
+			pairs[2 * i + 1] = mean + radius * std::sin(angle);
+		} // End for(i)
+
+		if constexpr (brain_float) { for (size_t i = 0; i < block; i++) { numbers[i] = RNGFloatToBFloat16(pairs[i]); } }
+		else { for (size_t i = 0; i < block; i++) { numbers[i] = RNGFloatToFloat16(pairs[i]); } }
+
+		numbers += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End RNGFillHalfNormalRand<brain_float, engine_type> function
+
+// Define a templated function to fill a buffer with uniform half precision numbers in the set [floor, roof)
+template<typename engine_type> void FillFloat16Rand(engine_type& rng, unsigned short* numbers, size_t count, float floor = 0, float roof = 1) {
+	RNGFillHalfRand<false>(rng, numbers, count, floor, roof);
+}
+// End FillFloat16Rand<engine_type> function
+
+// Define a templated function to fill a buffer with uniform bfloat16 numbers in the set [floor, roof)
+template<typename engine_type> void FillBFloat16Rand(engine_type& rng, unsigned short* numbers, size_t count, float floor = 0, float roof = 1) {
+	RNGFillHalfRand<true>(rng, numbers, count, floor, roof);
+}
+// End FillBFloat16Rand<engine_type> function
+
+// Define a templated function to fill a buffer with normally distributed half precision numbers
+template<typename engine_type> void FillFloat16NormalRand(engine_type& rng, unsigned short* numbers, size_t count, float mean = 0, float deviation = 1) {
+	RNGFillHalfNormalRand<false>(rng, numbers, count, mean, deviation);
+}
+// End FillFloat16NormalRand<engine_type> function
+
+// Define a templated function to fill a buffer with normally distributed bfloat16 numbers
+template<typename engine_type> void FillBFloat16NormalRand(engine_type& rng, unsigned short* numbers, size_t count, float mean = 0, float deviation = 1) {
+	RNGFillHalfNormalRand<true>(rng, numbers, count, mean, deviation);
+}
+// End FillBFloat16NormalRand<engine_type> function
+#endif
@@ -0,0 +1,260 @@
+﻿// RNGHeavyTail.h - This header declares the ZipfDistribution, ParetoDistribution and LognormalDistribution classes, and (due to
+//		the latter two being class templates) implements them
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- These distributions are meant for driving synthetic workloads (key popularity, object sizes, think times). Like the std
+	distributions they hold only their parameters and are used with a generator: dist(rng) draws one number and
+	dist.Fill(rng, numbers, count) draws many, pulling bits from the generator in blocks. Any generator with a 64-bit result_type
+	and a "Fill" method (RNGClass or SeededRNGClass) can be used.
+
+- ZipfDistribution uses Hörmann and Derflinger's rejection-inversion method, which needs O(1) time and memory per number whatever
+	the number of elements (no table of N probabilities is built), and accepts over 90% of candidates for every exponent. Ranks
+	are generated in the set { rank ∈ unsigned long long | 1 ≤ rank ≤ elements }, rank 1 being the most popular.
+
+- Every instance is immutable once constructed, so one instance can be shared by all threads (each with its own generator).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type, and "dist" as the identifier for
+	the distribution instance
+
+To create a Zipf distribution, where rank k has a probability proportional to 1 / k^exponent
+  declare ZipfDistribution identifier(elements, exponent)
+	elements: unsigned long long, the number of ranks (e.g. keys). Must be at least 1
+	exponent: double, the exponent of the distribution. Must be positive
+
+To create a Pareto distribution, where P(number > x) = (scale / x)^shape for x ≥ scale
+  declare ParetoDistribution<floating_type> identifier(scale, shape)
+	scale: floating_type, the minimum possible number. Must be positive
+	shape: floating_type, the tail index of the distribution (lower is heavier). Must be positive
+
+To create a lognormal distribution, whose logarithm is normally distributed
+  declare LognormalDistribution<floating_type> identifier(location, spread)
+	location: floating_type, the mean of the logarithm
+	spread: floating_type, the standard deviation of the logarithm
+
+To draw a number from a distribution
+ Call dist(rng)
+   RETURN: unsigned long long for ZipfDistribution, floating_type otherwise
+
+To fill a buffer with numbers drawn from a distribution
+ Call dist.Fill(rng, numbers, count)
+	 numbers: unsigned long long* for ZipfDistribution, floating_type* otherwise, the buffer to fill
+	 count: size_t, the number of numbers to write
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGHEAVYTAIL_H
+#define RNGHEAVYTAIL_H
+
+// Include the header defining the shared bulk primitives and the bulk normal fill
+#include "RNGBulk.h"
+
+class ZipfDistribution {
+public:
+	// Define the constructor to precalculate the constants of the rejection-inversion method
+	ZipfDistribution(unsigned long long elements, double exponent) : elements(elements), exponent(exponent) {
+		// unsigned long long elements;	// The number of ranks. Passed
+		// double exponent;				// The exponent of the distribution. Passed
+
+		// Ensure that the parameters are valid
+		assert(("A Zipf distribution must have at least one element", elements >= 1));
+		assert(("The exponent of a Zipf distribution must be positive", exponent > 0));
+
+		this->integral_first = this->HIntegral(1.5) - 1;
+		this->integral_last = this->HIntegral((double)elements + 0.5);
+		this->squeeze = 2 - this->HIntegralInverse(this->HIntegral(2.5) - this->H(2));
+	}
+
+	// **** Define const methods ****
+
+	// Define the () operator to draw a rank from the distribution
+	template<typename engine_type> unsigned long long operator()(engine_type& rng) const {
+		// engine_type& rng;			// The generator to pull bits from. Passed by reference
+		unsigned long long rank;		// The candidate rank
+
+		// Invert the integral of the hat function at a uniform point, accepting the rounded result if it lies under the histogram
+		while (true) {
+			double area = this->integral_last + RNGBitsToUnit<double>(rng()) * (this->integral_first - this->integral_last); // The uniform point
+			double point = this->HIntegralInverse(area); // The continuous candidate
+			rank = this->Round(point);
+			if ((double)rank - point <= this->squeeze || area >= this->HIntegral((double)rank + 0.5) - this->H((double)rank)) { return rank; }
+		} // End while(true)
+	}
+	// End ZipfDistribution::operator() method
+
+	// Define a method to fill a buffer with ranks drawn from the distribution
+	template<typename engine_type> void Fill(engine_type& rng, unsigned long long* numbers, size_t count) const {
+		// engine_type& rng;			// The generator to pull bits from. Passed by reference
+		// unsigned long long* numbers;	// The buffer to fill. Passed
+		// size_t count;				// The number of numbers to write. Passed
+		unsigned long long bits[RNGBulkBlockSize];	// The block of random bits currently being converted
+		bool accepted[RNGBulkBlockSize];			// Whether or not every candidate of the block was accepted
+		size_t block;								// The number of candidates of the current block
+
+		// Ensure that the provided generator is usable
+		static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for ZipfDistribution::Fill must have a 64-bit result_type");
+
+		for (size_t done = 0; done < count; done += block) {
+			block = (count - done < RNGBulkBlockSize) ? count - done : RNGBulkBlockSize;
+			rng.Fill(bits, block);
+
+			// Generate and test every candidate of the block without branching
+			for (size_t i = 0; i < block; i++) {
+				double area = this->integral_last + RNGBitsToUnit<double>(bits[i]) * (this->integral_first - this->integral_last);
+				double point = this->HIntegralInverse(area);
+				numbers[done + i] = this->Round(point);
+				accepted[i] = ((double)numbers[done + i] - point <= this->squeeze) | (area >= this->HIntegral((double)numbers[done + i] + 0.5) - this->H((double)numbers[done + i]));
+			} // End for(i)
+
+			// Redraw the few rejected candidates one at a time
+			for (size_t i = 0; i < block; i++) {
+				if (!accepted[i]) { numbers[done + i] = this->operator()(rng); }
+			} // End for(i)
+		} // End for(done)
+	}
+	// End ZipfDistribution::Fill method
+
+	// Define methods to return the parameters of the distribution
+	unsigned long long GetElements() const { return this->elements; }
+	double GetExponent() const { return this->exponent; }
+
+protected:
+	// Define a method to round a continuous candidate to the nearest rank, clamped to the valid ranks
+	unsigned long long Round(double point) const {
+		double rounded = std::floor(point + 0.5); // The nearest whole number
+
+		if (rounded < 1) { return 1; }
+		if (rounded > (double)this->elements) { return this->elements; }
+		return (unsigned long long)rounded;
+	}
+	// End ZipfDistribution::Round method
+
+	// Define a method to evaluate the hat function h(x) = x^-exponent
+	double H(double x) const { return std::exp(-this->exponent * std::log(x)); }
+
+	// Define a method to evaluate the integral of the hat function, H(x) = (x^(1 - exponent) - 1) / (1 - exponent), which is
+	//		log(x) when the exponent is 1. NOTE: Written with expm1 so that it stays accurate for exponents close to 1
+	double HIntegral(double x) const {
+		double log_x = std::log(x); // The logarithm of the point
+		return ZipfDistribution::ExpM1Ratio((1 - this->exponent) * log_x) * log_x;
+	}
+	// End ZipfDistribution::HIntegral method
+
+	// Define a method to evaluate the inverse of the integral of the hat function
+	double HIntegralInverse(double x) const {
+		double t = x * (1 - this->exponent); // The argument of the logarithm, clamped to its domain
+
+		if (t < -1) { t = -1; }
+		return std::exp(ZipfDistribution::Log1pRatio(t) * x);
+	}
+	// End ZipfDistribution::HIntegralInverse method
+
+	// Define methods to evaluate log(1 + x) / x and (e^x - 1) / x, using their Taylor series close to 0
+	static double Log1pRatio(double x) { return (std::fabs(x) > 1e-8) ? std::log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x)); }
+	static double ExpM1Ratio(double x) { return (std::fabs(x) > 1e-8) ? std::expm1(x) / x : 1 + x * 0.5 * (1 + x / 3 * (1 + 0.25 * x)); }
+
+	unsigned long long elements;	// The number of ranks
+	double exponent;				// The exponent of the distribution
+	double integral_first;			// The integral of the hat function up to the start of the first rank's interval
+	double integral_last;			// The integral of the hat function up to the end of the last rank's interval
+	double squeeze;					// The distance from a rank below which a candidate is always accepted
+}; // End class ZipfDistribution
+
+// typename floating_type; // The type of the numbers. Must be floating-point
+template <typename floating_type>
+class ParetoDistribution {
+public:
+	// Ensure that the provided type is floating-point
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for ParetoDistribution must be floating-point");
+
+	// Define the constructor to store the parameters of the distribution
+	ParetoDistribution(floating_type scale, floating_type shape) : scale(scale), inverse_shape(1 / shape) {
+		// Ensure that the parameters are valid
+		assert(("The scale of a Pareto distribution must be positive", scale > 0));
+		assert(("The shape of a Pareto distribution must be positive", shape > 0));
+	}
+
+	// **** Define const methods ****
+
+	// Define the () operator to draw a number from the distribution by inversion: scale * u^(-1 / shape) for u in (0, 1]
+	template<typename engine_type> floating_type operator()(engine_type& rng) const {
+		return this->scale * std::pow(RNGBitsToOpenUnit<floating_type>(rng()), -this->inverse_shape);
+	}
+	// End ParetoDistribution<floating_type>::operator() method
+
+	// Define a method to fill a buffer with numbers drawn from the distribution
+	template<typename engine_type> void Fill(engine_type& rng, floating_type* numbers, size_t count) const {
+		// engine_type& rng;			// The generator to pull bits from. Passed by reference
+		// floating_type* numbers;		// The buffer to fill. Passed
+		// size_t count;				// The number of numbers to write. Passed
+		unsigned long long bits[RNGBulkBlockSize];	// The block of random bits currently being converted
+		size_t block;								// The number of numbers converted from the current block
+
+		// Ensure that the provided generator is usable
+		static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for ParetoDistribution::Fill must have a 64-bit result_type");
+
+		// NOTE: u^(-1 / shape) is calculated as e^(-log(u) / shape), which vectorizes better than pow
+		for (size_t done = 0; done < count; done += block) {
+			block = (count - done < RNGBulkBlockSize) ? count - done : RNGBulkBlockSize;
+			rng.Fill(bits, block);
+			for (size_t i = 0; i < block; i++) {
+				numbers[done + i] = this->scale * std::exp(-this->inverse_shape * std::log(RNGBitsToOpenUnit<floating_type>(bits[i])));
+			} // End for(i)
+		} // End for(done)
+	}
+	// End ParetoDistribution<floating_type>::Fill method
+
+	// Define methods to return the parameters of the distribution
+	floating_type GetScale() const { return this->scale; }
+	floating_type GetShape() const { return 1 / this->inverse_shape; }
+
+protected:
+	floating_type scale;			// The minimum possible number
+	floating_type inverse_shape;	// The reciprocal of the tail index
+}; // End class ParetoDistribution
+
+// typename floating_type; // The type of the numbers. Must be floating-point
+template <typename floating_type>
+class LognormalDistribution {
+public:
+	// Ensure that the provided type is floating-point
+	static_assert(std::is_floating_point_v<floating_type>, "The type provided for LognormalDistribution must be floating-point");
+
+	// Define the constructor to store the parameters of the distribution
+	LognormalDistribution(floating_type location, floating_type spread) : location(location), spread(spread) {
+		// Ensure that the parameters are valid
+		assert(("The spread of a lognormal distribution must not be negative", spread >= 0));
+	}
+
+	// **** Define const methods ****
+
+	// Define the () operator to draw a number from the distribution
+	template<typename engine_type> floating_type operator()(engine_type& rng) const {
+		floating_type radius = std::sqrt(-2 * std::log(RNGBitsToOpenUnit<floating_type>(rng()))); // The radius of the Box-Muller pair
+		return std::exp(this->location + this->spread * radius * std::cos((floating_type)RNGTwoPi * RNGBitsToUnit<floating_type>(rng())));
+	}
+	// End LognormalDistribution<floating_type>::operator() method
+
+	// Define a method to fill a buffer with numbers drawn from the distribution
+	template<typename engine_type> void Fill(engine_type& rng, floating_type* numbers, size_t count) const {
+		// engine_type& rng;			// The generator to pull bits from. Passed by reference
+		// floating_type* numbers;		// The buffer to fill. Passed
+		// size_t count;				// The number of numbers to write. Passed
+
+		// Generate the logarithms in bulk, then exponentiate them in a vectorizable pass
+		FillNormalRand(rng, numbers, count, this->location, this->spread);
+		for (size_t i = 0; i < count; i++) { numbers[i] = std::exp(numbers[i]); }
+	}
+	// End LognormalDistribution<floating_type>::Fill method
+
+	// Define methods to return the parameters of the distribution
+	floating_type GetLocation() const { return this->location; }
+	floating_type GetSpread() const { return this->spread; }
+
+protected:
+	floating_type location;		// The mean of the logarithm
+	floating_type spread;		// The standard deviation of the logarithm
+}; // End class LognormalDistribution
+#endif
@@ -0,0 +1,287 @@
+﻿// RNGLatency.h - This header declares the RNGHistogram class and the RNGLatency struct, and implements them, as well as defining
+//		the sampling timer of the generation methods and the dump of the histograms
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Latency instrumentation is opt-in: it is only compiled in when RNG_LATENCY is defined before the headers are included (e.g.
+	with /DRNG_LATENCY or -DRNG_LATENCY). Without it, RNG_TIME_CALL expands to nothing and RNGClass has no histograms, so the
+	instrumentation costs nothing at all.
+
+- With it, every RNGClass instance times one in RNG_LATENCY_SAMPLING calls (64 by default, must be a power of two) of each of
+	its generation methods (GetRand and the () operators, CustomRand, FloatingRand, Fill) with the time stamp counter, into one
+	histogram per method. The sampling counters are per thread and method, and start at the first call, so the first call of
+	every thread (which opens the OS algorithm on the first draw after startup) is always timed. Refills of BufferedRNGClass are
+	the Fill calls of its RNGClass instance.
+
+- The histograms are log-linear: values below 16 ticks have a bucket each, and every power of two above is split into 16
+	buckets, so a percentile is read within 1/16 (6%) of the real value. Recording is a relaxed atomic increment of one bucket
+	(lock-free, and rare since it is sampled), and values of 2^40 ticks or more share the last bucket.
+
+- A call that isn't sampled costs an increment and a predictable branch. A sampled call also costs two reads of the time stamp
+	counter and the increment of its bucket, on the order of 100 cycles (more under some hypervisors, which trap the reads), so
+	sampling every call (RNG_LATENCY_SAMPLING 1) is only worth it for short investigations.
+
+- Ticks are converted to nanoseconds in the dump, with a rate calibrated once against the steady clock (which takes about 10
+	milliseconds on the first dump). Where there is no time stamp counter, ticks already are nanoseconds.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Only available when RNG_LATENCY is defined. Examples use "latency" as the identifier for the RNGLatency instance (e.g.
+	rng.GetLatency() of an RNGClass or BufferedRNGClass instance)
+
+To get the histogram of a method
+ Use latency.histograms[method]
+	 method: RNGTimedMethod, RNG_TIMED_GETRAND, RNG_TIMED_CUSTOMRAND, RNG_TIMED_FLOATINGRAND or RNG_TIMED_FILL
+   TYPE: RNGHistogram
+
+To get a percentile of a histogram (e.g. 0.5, 0.99, 0.999)
+ Call histogram.Percentile(fraction)
+	 fraction: double, the fraction of the calls at or below the result
+   RETURN: unsigned long long, in ticks (the upper bound of the bucket holding the percentile, 0 if nothing was recorded)
+
+To get the number of calls timed, or the slowest one
+ Call histogram.GetCount() or histogram.GetMax()
+   RETURN: unsigned long long
+
+To dump every histogram of an instance (count, p50, p99, p999 and max of every method, in ticks and nanoseconds)
+ call RNGLatencyText(latency, name)
+	 latency: const RNGLatency&, the histograms
+	 name: const std::string&, the name of the instance at the start of every line
+   RETURN: std::string
+ ----------OR---------
+ call RNGWriteLatency(path, latency, name)
+	 path: const std::string&, the file to write
+   RETURN: void
+
+To time a block of code in a method (e.g. of a new generator class with an RNGLatency member)
+ use RNG_TIME_CALL(latency, method) at the start of the block
+*/
+
+// Include guard
+#ifndef RNGLATENCY_H
+#define RNGLATENCY_H
+
+#ifdef RNG_LATENCY
+// If necessary, include the header to allow atomic operations
+#ifndef _ATOMIC_
+#include <atomic>
+#endif
+// If necessary, include the header to allow strings
+#ifndef _STRING_
+#include <string>
+#endif
+// If necessary, include the header to allow writing files
+#ifndef _FSTREAM_
+#include <fstream>
+#endif
+// If necessary, include the header to allow formatting the dump
+#ifndef _SSTREAM_
+#include <sstream>
+#endif
+// If necessary, include the header to allow waiting during the calibration
+#ifndef _THREAD_
+#include <thread>
+#endif
+// If necessary, include the header to allow rounding the rank of a percentile
+#ifndef _CMATH_
+#include <cmath>
+#endif
+// Include the header defining the time stamp counter
+#include "RNGDispatch.h"
+// Include the header to allow run-time assertions. NOTE: assert.h does not contain an include guard, but due to only containing
+//		a forward declaration and a macro there are no side effects of multiple inclusions
+#include <assert.h>
+
+// Define the default sampling rate (one timed call in RNG_LATENCY_SAMPLING)
+#ifndef RNG_LATENCY_SAMPLING
+#define RNG_LATENCY_SAMPLING 64
+#endif
+static_assert((RNG_LATENCY_SAMPLING & (RNG_LATENCY_SAMPLING - 1)) == 0, "RNG_LATENCY_SAMPLING must be a power of two");
+
+// Define the macro timing the rest of the enclosing block into the histogram of a method
+#define RNG_TIME_CALL(latency, method) RNGLatencyTimer rng_latency_timer((latency), (method))
+
+// Define the number of buckets of a histogram: 16 for the values below 16, then 16 per power of two up to 2^40
+inline constexpr size_t RNGLatencyBuckets = 16 * 37;
+
+// Define the timed methods, which index the histograms of an RNGLatency instance
+enum RNGTimedMethod { RNG_TIMED_GETRAND, RNG_TIMED_CUSTOMRAND, RNG_TIMED_FLOATINGRAND, RNG_TIMED_FILL, RNG_TIMED_COUNT };
+
+// Define a function to return the bucket of a number of ticks
+inline size_t RNGLatencyBucket(unsigned long long ticks) {
+	// unsigned long long ticks; // The value to record. Passed
+	int exponent; // The position of the highest set bit
+
+	if (ticks < 16) { return (size_t)ticks; }
+#if defined(_MSC_VER)
+	unsigned long index; // The position of the highest set bit, as written by _BitScanReverse64
+	_BitScanReverse64(&index, ticks);
+	exponent = (int)index;
+#else
+	exponent = 63 - __builtin_clzll(ticks);
+#endif
+	if (exponent >= 40) { return RNGLatencyBuckets - 1; }
+	return (size_t)(exponent - 3) * 16 + (size_t)((ticks >> (exponent - 4)) & 15);
+}
+// End RNGLatencyBucket function
+
+// Define a function to return the largest number of ticks of a bucket
+inline unsigned long long RNGLatencyBucketTop(size_t bucket) {
+	// size_t bucket; // The bucket. Passed
+	int exponent = (int)(bucket / 16) + 3;	// The position of the highest set bit of the values of the bucket
+
+	if (bucket < 16) { return bucket; }
+	return ((16ULL + bucket % 16) << (exponent - 4)) + (1ULL << (exponent - 4)) - 1;
+}
+// End RNGLatencyBucketTop function
+
+// Define a function to return the number of ticks per nanosecond, calibrated on the first call
+inline double RNGTicksPerNanosecond() {
+	// NOTE: The initialization of a static local is thread-safe, and only happens once
+	static const double rate = []() -> double {
+#ifdef RNG_HAS_DISPATCH
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();	// The start of the calibration
+		unsigned long long ticks = RNGReadTimestamp();									// The counter at the start
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		ticks = RNGReadTimestamp() - ticks;
+		return (double)ticks / (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+#else
+		return 1.0;
+#endif
+	}();
+	return rate;
+}
+// End RNGTicksPerNanosecond function
+
+class RNGHistogram {
+public:
+	// Define the default constructor to start every bucket at 0
+	RNGHistogram() : buckets{}, max(0) {}
+
+	// Disallow copies, since the buckets are shared by all threads
+	RNGHistogram(const RNGHistogram&) = delete;
+	RNGHistogram& operator=(const RNGHistogram&) = delete;
+
+	// **** Define non-const methods ****
+
+	// Define a method to record a number of ticks. NOTE: Lock-free
+	void Record(unsigned long long ticks) {
+		// unsigned long long ticks; // The value to record. Passed
+		unsigned long long slowest = this->max.load(std::memory_order_relaxed); // The slowest value recorded so far
+
+		this->buckets[RNGLatencyBucket(ticks)].fetch_add(1, std::memory_order_relaxed);
+		while (ticks > slowest && !this->max.compare_exchange_weak(slowest, ticks, std::memory_order_relaxed)) {}
+	}
+	// End RNGHistogram::Record method
+
+	// **** Define const methods ****
+
+	// Define a method to return the number of values recorded
+	unsigned long long GetCount() const {
+		unsigned long long count = 0; // The number to return
+		for (size_t b = 0; b < RNGLatencyBuckets; b++) { count += this->buckets[b].load(std::memory_order_relaxed); }
+		return count;
+	}
+	// End RNGHistogram::GetCount method
+
+	// Define a method to return the largest value recorded
+	unsigned long long GetMax() const { return this->max.load(std::memory_order_relaxed); }
+
+	// Define a method to return the upper bound of the bucket holding a percentile, or 0 if nothing was recorded
+	unsigned long long Percentile(double fraction) const {
+		// double fraction;								// The fraction of the values at or below the result. Passed
+		unsigned long long counts[RNGLatencyBuckets];	// A copy of the buckets, so that every sum uses the same counts
+		unsigned long long total = 0;					// The number of values recorded
+		unsigned long long rank;						// The number of values at or below the percentile
+		unsigned long long seen = 0;					// The number of values in the buckets walked so far
+
+		assert(("The fraction must be in [0, 1]", fraction >= 0 && fraction <= 1));
+
+		for (size_t b = 0; b < RNGLatencyBuckets; b++) { total += counts[b] = this->buckets[b].load(std::memory_order_relaxed); }
+		if (total == 0) { return 0; }
+		rank = (unsigned long long)std::ceil(fraction * (double)total);
+		if (rank == 0) { rank = 1; }
+
+		for (size_t b = 0; b < RNGLatencyBuckets; b++) {
+			seen += counts[b];
+			if (seen >= rank) { return (RNGLatencyBucketTop(b) < this->GetMax()) ? RNGLatencyBucketTop(b) : this->GetMax(); }
+		} // End for(b)
+		return this->GetMax();
+	}
+	// End RNGHistogram::Percentile method
+
+protected:
+	std::atomic<unsigned long long> buckets[RNGLatencyBuckets];	// The number of values recorded in every bucket
+	std::atomic<unsigned long long> max;						// The largest value recorded
+}; // End class RNGHistogram
+
+// Define the histograms of an instance, one per timed method
+struct RNGLatency {
+	RNGHistogram histograms[RNG_TIMED_COUNT]; // The histograms, indexed by RNGTimedMethod
+}; // End struct RNGLatency
+
+class RNGLatencyTimer {
+public:
+	// Define the constructor to read the time stamp counter if the call is sampled
+	RNGLatencyTimer(RNGLatency& latency, RNGTimedMethod method) : histogram(latency.histograms[method]), start(RNGLatencyTimer::Sampled(method) ? RNGReadTimestamp() : 0) {}
+
+	// Define the destructor to record the duration of a sampled call
+	~RNGLatencyTimer() { if (this->start != 0) { this->histogram.Record(RNGReadTimestamp() - this->start); } }
+
+	// Disallow copies, since a call is only recorded once
+	RNGLatencyTimer(const RNGLatencyTimer&) = delete;
+	RNGLatencyTimer& operator=(const RNGLatencyTimer&) = delete;
+
+protected:
+	// Define a static method to return whether or not the current call is sampled, counting the calls of the current thread per
+	//		method (so that a loop calling several methods in turn doesn't always sample the same one)
+	static bool Sampled(RNGTimedMethod method) {
+		// RNGTimedMethod method;								// The timed method. Passed
+		thread_local unsigned int calls[RNG_TIMED_COUNT] = {};	// The number of calls of the current thread per method
+		return (calls[method]++ & (RNG_LATENCY_SAMPLING - 1)) == 0;
+	}
+	// End RNGLatencyTimer::Sampled method
+
+	RNGHistogram& histogram;	// The histogram of the timed method
+	unsigned long long start;	// The time stamp counter at the start of the call, 0 if the call isn't sampled
+}; // End class RNGLatencyTimer
+
+// Define a function to dump the histograms of an instance, one line per method
+inline std::string RNGLatencyText(const RNGLatency& latency, const std::string& name) {
+	// const RNGLatency& latency;	// The histograms. Passed by reference
+	// const std::string& name;		// The name of the instance. Passed by reference
+	std::ostringstream text;		// The text to return
+	const char* methods[RNG_TIMED_COUNT] = { "GetRand", "CustomRand", "FloatingRand", "Fill" }; // The names of the methods
+	double rate = RNGTicksPerNanosecond(); // The number of ticks per nanosecond
+
+	text.setf(std::ios::fixed);
+	text.precision(1);
+	for (int m = 0; m < RNG_TIMED_COUNT; m++) {
+		const RNGHistogram& histogram = latency.histograms[m]; // The histogram of the method
+		unsigned long long values[4] = { histogram.Percentile(0.5), histogram.Percentile(0.99), histogram.Percentile(0.999), histogram.GetMax() }; // The percentiles and the max
+		const char* labels[4] = { "p50", "p99", "p999", "max" }; // The names of the values
+
+		text << name << " " << methods[m] << ": count=" << histogram.GetCount();
+		for (int v = 0; v < 4; v++) { text << " " << labels[v] << "=" << values[v] << " ticks (" << values[v] / rate << " ns)"; }
+		text << "\n";
+	} // End for(m)
+	return text.str();
+}
+// End RNGLatencyText function
+
+// Define a function to write the dump of the histograms of an instance to a file
+inline void RNGWriteLatency(const std::string& path, const RNGLatency& latency, const std::string& name) {
+	// const std::string& path;		// The file to write. Passed by reference
+	// const RNGLatency& latency;	// The histograms. Passed by reference
+	// const std::string& name;		// The name of the instance. Passed by reference
+	std::ofstream file(path, std::ios::out | std::ios::trunc); // The file written
+
+	if (!file) { throw std::exception("RNGWriteLatency could not open the file"); }
+	file << RNGLatencyText(latency, name);
+	if (!file) { throw std::exception("RNGWriteLatency could not write the file"); }
+}
+// End RNGWriteLatency function
+#else
+// Define the macro to do nothing when the instrumentation isn't compiled in
+#define RNG_TIME_CALL(latency, method)
+#endif
+#endif
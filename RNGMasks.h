@@ -0,0 +1,81 @@
+﻿// RNGMasks.h - This header defines the templated function used to generate packed Bernoulli bitmasks (e.g. for dropout)
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Every bit of the mask is set independently with probability p. Bit j of the mask is bit (j % 64) of word j / 64.
+
+- The mask is built by combining whole random words with AND and OR, following the binary expansion of p = 0.b1 b2 ... bm: the
+	words are combined from the last digit to the first, ORing in a new word for a 1 digit and ANDing for a 0 digit. After the
+	digit b1, every bit is set with probability exactly 0.b1 b2 ... bm, so this is exact for p = k / 2^m, and each random word
+	yields 64 mask bits per digit instead of one comparison per bit. For example, p = 0.5 costs one random word per 64 bits, and
+	p = 0.75 costs two.
+
+- Other probabilities are rounded to the nearest multiple of 2^-32 (at most 32 digits). Comparing 32-bit random lanes against p
+	would use exactly as many random bits, and then still need to pack the comparison results into words, so combining is never
+	slower. Trailing zero digits are dropped, so coarse probabilities are cheap.
+
+- The inner loops run over whole blocks of words with only AND and OR, so the compiler vectorizes them to the widest registers
+	available.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type
+
+To fill a buffer with a packed Bernoulli mask
+ call FillBernoulliMask(rng, words, count, probability)
+	 words: unsigned long long*, the buffer to fill
+	 count: size_t, the number of 64-bit words to write (i.e. 64 * count mask bits)
+	 probability: double, the probability of every bit being set, in the set [0, 1]
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGMASKS_H
+#define RNGMASKS_H
+
+// Include the header defining the shared bulk primitives
+#include "RNGBulk.h"
+
+// Define a templated function to fill a buffer with a packed Bernoulli mask
+template<typename engine_type> void FillBernoulliMask(engine_type& rng, unsigned long long* words, size_t count, double probability) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// unsigned long long* words;	// The buffer to fill. Passed
+	// size_t count;				// The number of words to write. Passed
+	// double probability;			// The probability of every bit being set. Passed
+	unsigned long long bits[RNGBulkBlockSize];	// The block of random words currently being combined
+	unsigned long long digits;					// The probability in 32-bit fixed point
+	int lowest;									// The position of the last 1 digit (0 for 2^-32, 31 for 1/2)
+	size_t block;								// The number of words of the current block
+
+	// Ensure that the provided generator and probability are usable
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for FillBernoulliMask must have a 64-bit result_type");
+	assert(("The probability must be in the set [0, 1]", probability >= 0 && probability <= 1));
+
+	// Round the probability to 32 binary digits, handling the two constant masks directly
+	digits = (unsigned long long)(probability * 4294967296.0 + 0.5);
+	if (digits == 0 || digits >= (1ULL << 32)) {
+		for (size_t i = 0; i < count; i++) { words[i] = (digits == 0) ? 0 : ~0ULL; }
+		return;
+	} // End if(digits == 0 || digits >= (1ULL << 32))
+
+	// Find the last 1 digit, which starts the combination (so trailing 0 digits cost nothing)
+	for (lowest = 0; !((digits >> lowest) & 1); lowest++) {}
+
+	while (count > 0) {
+		block = (count < RNGBulkBlockSize) ? count : RNGBulkBlockSize;
+
+		// The last 1 digit ORs into an empty mask, which is just a copy of the random words
+		rng.Fill(words, block);
+
+		// Combine one more block of random words per remaining digit, from the last digit to the first
+		for (int digit = lowest + 1; digit < 32; digit++) {
+			rng.Fill(bits, block);
+			if ((digits >> digit) & 1) { for (size_t i = 0; i < block; i++) { words[i] |= bits[i]; } }
+			else { for (size_t i = 0; i < block; i++) { words[i] &= bits[i]; } }
+		} // End for(digit)
+
+		words += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End FillBernoulliMask<engine_type> function
+#endif
@@ -0,0 +1,274 @@
+﻿// RNGMetrics.h - This header declares the RNGMetrics class, and implements it, as well as defining the export of its counters
+//		in the Prometheus text format
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Every RNGClass instance counts its draws (by API), the calls it makes to the OS generator and the bytes they return, the extra
+	draws its ranged numbers needed because of rejections, and the time threads spent waiting for its lock. BufferedRNGClass
+	adds its refills and EntropyPool its collections (reseeds) to the counters of the RNGClass instance they draw from. The
+	process-wide counters (RNGProcessMetrics) are the sums over every live instance, plus the totals of the destroyed ones.
+
+- Counters are kept in RNGMetricShards shards, each on its own cache lines, and every thread adds to the shard it was assigned
+	when it first counted something, so threads never write to the same cache line unless there are more threads than shards.
+	Adding is a single relaxed atomic addition. Reading (Snapshot, RNGProcessMetrics) sums the shards, so it is the only expensive
+	operation, and a snapshot taken while other threads draw is only consistent per counter. Creating and destroying an instance
+	takes a process-wide lock, to register it for the process-wide counters.
+
+- Lock waits are only timed when the lock is already held (the uncontended path just tries the lock), with the steady clock.
+
+- The rejection retries of std::uniform_int_distribution aren't visible, so they are counted as the draws a ranged number took
+	beyond the fewest its range needs (e.g. a 32-bit range needs 1 draw of a 64-bit instance, or 4 of an 8-bit one).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "metrics" as the identifier for the RNGMetrics instance (e.g. rng.GetMetrics() of an RNGClass instance)
+
+To create a set of counters (e.g. for a generator of another kind)
+  declare RNGMetrics identifier
+
+To read the process-wide counters
+ call RNGProcessMetrics()
+   RETURN: RNGMetricsSnapshot, with one member per counter
+
+To add to a counter
+ Call metrics.Add(metric, value)
+	 metric: RNGMetric, the counter (e.g. RNG_METRIC_REFILLS)
+	 value: unsigned long long, the amount to add. If omitted, it becomes 1
+   RETURN: void
+
+To read every counter
+ Call metrics.Snapshot()
+   RETURN: RNGMetricsSnapshot, with one member per counter
+
+To export a snapshot in the Prometheus text format
+ call RNGMetricsText(snapshot, labels)
+	 snapshot: const RNGMetricsSnapshot&, the counters
+	 labels: const std::string&, labels added to every sample (e.g. "instance=\"tokens\""). If omitted, it becomes ""
+   RETURN: std::string
+
+To write a snapshot to a file in the Prometheus text format (e.g. for the textfile collector of the node exporter)
+ call RNGWriteMetrics(path, snapshot, labels)
+	 path: const std::string&, the file to write
+	 snapshot: const RNGMetricsSnapshot&, the counters
+	 labels: const std::string&, labels added to every sample. If omitted, it becomes ""
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGMETRICS_H
+#define RNGMETRICS_H
+
+// If necessary, include the header to allow atomic operations
+#ifndef _ATOMIC_
+#include <atomic>
+#endif
+// If necessary, include the header to allow strings
+#ifndef _STRING_
+#include <string>
+#endif
+// If necessary, include the header to allow writing files
+#ifndef _FSTREAM_
+#include <fstream>
+#endif
+// If necessary, include the header to allow formatting the lock wait time
+#ifndef _SSTREAM_
+#include <sstream>
+#endif
+// If necessary, include the header to allow vectors
+#ifndef _VECTOR_
+#include <vector>
+#endif
+// If necessary, include the header to allow the use of mutex to ensure thread-safety
+#ifndef _MUTEX_
+#include <mutex>
+#endif
+// If necessary, include the header to allow searching the registered instances
+#ifndef _ALGORITHM_
+#include <algorithm>
+#endif
+
+// Define the counters of an RNGMetrics instance
+enum RNGMetric {
+	RNG_METRIC_GETRAND,			// The numbers drawn with GetRand (or the () operators)
+	RNG_METRIC_CUSTOMRAND,		// The numbers drawn with CustomRand
+	RNG_METRIC_FLOATINGRAND,	// The numbers drawn with FloatingRand
+	RNG_METRIC_FILL,			// The numbers written by Fill
+	RNG_METRIC_BYTES,			// The bytes returned by the OS generator
+	RNG_METRIC_BACKEND_CALLS,	// The calls to the OS generator
+	RNG_METRIC_RETRIES,			// The draws ranged numbers took beyond the fewest their ranges need
+	RNG_METRIC_REFILLS,			// The refills of BufferedRNGClass buffers
+	RNG_METRIC_RESEEDS,			// The collections of EntropyPool instances
+	RNG_METRIC_LOCK_WAITS,		// The times a thread found the lock held by another one
+	RNG_METRIC_LOCK_WAIT_NS,	// The nanoseconds spent waiting for the lock
+	RNG_METRIC_COUNT			// The number of counters
+};
+
+// Define the number of shards of the counters
+inline constexpr size_t RNGMetricShards = 16;
+
+// Define a function to return the shard of the current thread, assigned in turn to every thread on its first call
+inline size_t RNGMetricShard() {
+	static std::atomic<size_t> next(0);				// The shard of the next thread
+	thread_local size_t shard = RNGMetricShards;	// The shard of the current thread. NOTE: Constant, so reading it needs no guard
+
+	if (shard == RNGMetricShards) { shard = next.fetch_add(1, std::memory_order_relaxed) % RNGMetricShards; }
+	return shard;
+}
+// End RNGMetricShard function
+
+// Define a snapshot of the counters of an RNGMetrics instance
+struct RNGMetricsSnapshot {
+	unsigned long long get_rand;		// The numbers drawn with GetRand (or the () operators)
+	unsigned long long custom_rand;		// The numbers drawn with CustomRand
+	unsigned long long floating_rand;	// The numbers drawn with FloatingRand
+	unsigned long long fill;			// The numbers written by Fill
+	unsigned long long bytes;			// The bytes returned by the OS generator
+	unsigned long long backend_calls;	// The calls to the OS generator
+	unsigned long long retries;			// The draws ranged numbers took beyond the fewest their ranges need
+	unsigned long long refills;			// The refills of BufferedRNGClass buffers
+	unsigned long long reseeds;			// The collections of EntropyPool instances
+	unsigned long long lock_waits;		// The times a thread found the lock held by another one
+	unsigned long long lock_wait_ns;	// The nanoseconds spent waiting for the lock
+}; // End struct RNGMetricsSnapshot
+
+class RNGMetrics {
+public:
+	// Define the default constructor to start every counter at 0, registering the instance for the process-wide counters
+	RNGMetrics() : shards{} {
+		Registry& registry = RNGMetrics::GetRegistry(); // The instances of the process
+		std::lock_guard<std::mutex> lock(registry.muter);
+		registry.live.push_back(this);
+	}
+
+	// Define the destructor to add the counters to the totals of the destroyed instances, and unregister the instance
+	~RNGMetrics() {
+		Registry& registry = RNGMetrics::GetRegistry(); // The instances of the process
+		std::lock_guard<std::mutex> lock(registry.muter);
+		this->Sum(registry.retired);
+		registry.live.erase(std::find(registry.live.begin(), registry.live.end(), this));
+	}
+
+	// Disallow copies, since the counters are shared by all threads
+	RNGMetrics(const RNGMetrics&) = delete;
+	RNGMetrics& operator=(const RNGMetrics&) = delete;
+
+	// **** Define non-const methods ****
+
+	// Define a method to add to a counter
+	void Add(RNGMetric metric, unsigned long long value = 1) {
+		// RNGMetric metric;			// The counter. Passed
+		// unsigned long long value;	// The amount to add. Passed. 1 if omitted
+		this->shards[RNGMetricShard()].values[metric].fetch_add(value, std::memory_order_relaxed);
+	}
+	// End RNGMetrics::Add method
+
+	// **** Define const methods ****
+
+	// Define a method to sum every counter over the shards
+	RNGMetricsSnapshot Snapshot() const {
+		unsigned long long totals[RNG_METRIC_COUNT] = {}; // The sums of the counters
+
+		this->Sum(totals);
+		return RNGMetrics::MakeSnapshot(totals);
+	}
+	// End RNGMetrics::Snapshot method
+
+	// Define a static method to sum every counter over every instance of the process, live or destroyed
+	static RNGMetricsSnapshot Process() {
+		Registry& registry = RNGMetrics::GetRegistry();		// The instances of the process
+		unsigned long long totals[RNG_METRIC_COUNT] = {};	// The sums of the counters
+		std::lock_guard<std::mutex> lock(registry.muter);
+
+		for (int m = 0; m < RNG_METRIC_COUNT; m++) { totals[m] = registry.retired[m]; }
+		for (const RNGMetrics* metrics : registry.live) { metrics->Sum(totals); }
+		return RNGMetrics::MakeSnapshot(totals);
+	}
+	// End RNGMetrics::Process method
+
+protected:
+	// Define a shard of the counters, aligned so that no two shards share a cache line
+	struct alignas(64) Shard {
+		std::atomic<unsigned long long> values[RNG_METRIC_COUNT]; // The counters of the shard
+	}; // End struct Shard
+
+	// Define the instances of the process
+	struct Registry {
+		std::mutex muter;								// The mutex used to block threads during modification of the registry
+		std::vector<const RNGMetrics*> live;			// The live instances
+		unsigned long long retired[RNG_METRIC_COUNT];	// The totals of the destroyed instances
+	}; // End struct Registry
+
+	// Define a static method to return the instances of the process. NOTE: The registry is created by the first instance, so it
+	//		is destroyed after every static instance
+	static Registry& GetRegistry() {
+		static Registry registry{}; // NOTE: The initialization of a static local is thread-safe, and only happens once
+		return registry;
+	}
+	// End RNGMetrics::GetRegistry method
+
+	// Define a method to add every counter of the instance to the provided totals
+	void Sum(unsigned long long* totals) const {
+		// unsigned long long* totals; // The sums to add to, one per counter. Passed
+		for (size_t s = 0; s < RNGMetricShards; s++) {
+			for (int m = 0; m < RNG_METRIC_COUNT; m++) { totals[m] += this->shards[s].values[m].load(std::memory_order_relaxed); }
+		} // End for(s)
+	}
+	// End RNGMetrics::Sum method
+
+	// Define a static method to name the sums of the counters
+	static RNGMetricsSnapshot MakeSnapshot(const unsigned long long* totals) {
+		// const unsigned long long* totals; // The sums of the counters. Passed
+		return { totals[RNG_METRIC_GETRAND], totals[RNG_METRIC_CUSTOMRAND], totals[RNG_METRIC_FLOATINGRAND], totals[RNG_METRIC_FILL], totals[RNG_METRIC_BYTES], totals[RNG_METRIC_BACKEND_CALLS], totals[RNG_METRIC_RETRIES], totals[RNG_METRIC_REFILLS], totals[RNG_METRIC_RESEEDS], totals[RNG_METRIC_LOCK_WAITS], totals[RNG_METRIC_LOCK_WAIT_NS] };
+	}
+	// End RNGMetrics::MakeSnapshot method
+
+	Shard shards[RNGMetricShards];	// The shards of the counters
+}; // End class RNGMetrics
+
+// Define a function to read the process-wide counters: the sums over every instance, live or destroyed
+inline RNGMetricsSnapshot RNGProcessMetrics() { return RNGMetrics::Process(); }
+
+// Define a function to export a snapshot in the Prometheus text format
+inline std::string RNGMetricsText(const RNGMetricsSnapshot& snapshot, const std::string& labels = "") {
+	// const RNGMetricsSnapshot& snapshot;	// The counters. Passed by reference
+	// const std::string& labels;			// The labels added to every sample. Passed by reference. "" if omitted
+	std::ostringstream text;								// The text to return
+	std::string braces = labels.empty() ? "" : "{" + labels + "}";	// The labels of the samples without other labels
+	std::string extra = labels.empty() ? "" : "," + labels;	// The labels appended to other labels
+	const char* apis[4] = { "GetRand", "CustomRand", "FloatingRand", "Fill" };	// The APIs, in the order of the snapshot
+	unsigned long long draws[4] = { snapshot.get_rand, snapshot.custom_rand, snapshot.floating_rand, snapshot.fill }; // The draws per API
+
+	// Write one counter per line, each with its help and type, keeping every digit of the lock wait time that matters
+	text.precision(15);
+	text << "# HELP rng_draws_total Numbers drawn, by API.\n# TYPE rng_draws_total counter\n";
+	for (int i = 0; i < 4; i++) { text << "rng_draws_total{api=\"" << apis[i] << "\"" << extra << "} " << draws[i] << "\n"; }
+	text << "# HELP rng_entropy_bytes_total Bytes returned by the OS generator.\n# TYPE rng_entropy_bytes_total counter\n";
+	text << "rng_entropy_bytes_total" << braces << " " << snapshot.bytes << "\n";
+	text << "# HELP rng_backend_calls_total Calls to the OS generator.\n# TYPE rng_backend_calls_total counter\n";
+	text << "rng_backend_calls_total" << braces << " " << snapshot.backend_calls << "\n";
+	text << "# HELP rng_rejection_retries_total Draws ranged numbers took beyond the fewest their ranges need.\n# TYPE rng_rejection_retries_total counter\n";
+	text << "rng_rejection_retries_total" << braces << " " << snapshot.retries << "\n";
+	text << "# HELP rng_refills_total Refills of buffered generators.\n# TYPE rng_refills_total counter\n";
+	text << "rng_refills_total" << braces << " " << snapshot.refills << "\n";
+	text << "# HELP rng_reseeds_total Collections of entropy pools.\n# TYPE rng_reseeds_total counter\n";
+	text << "rng_reseeds_total" << braces << " " << snapshot.reseeds << "\n";
+	text << "# HELP rng_lock_waits_total Times a thread found a generator's lock held.\n# TYPE rng_lock_waits_total counter\n";
+	text << "rng_lock_waits_total" << braces << " " << snapshot.lock_waits << "\n";
+	text << "# HELP rng_lock_wait_seconds_total Time spent waiting for generators' locks.\n# TYPE rng_lock_wait_seconds_total counter\n";
+	text << "rng_lock_wait_seconds_total" << braces << " " << snapshot.lock_wait_ns / 1e9 << "\n";
+	return text.str();
+}
+// End RNGMetricsText function
+
+// Define a function to write a snapshot to a file in the Prometheus text format
+inline void RNGWriteMetrics(const std::string& path, const RNGMetricsSnapshot& snapshot, const std::string& labels = "") {
+	// const std::string& path;				// The file to write. Passed by reference
+	// const RNGMetricsSnapshot& snapshot;	// The counters. Passed by reference
+	// const std::string& labels;			// The labels added to every sample. Passed by reference. "" if omitted
+	std::ofstream file(path, std::ios::out | std::ios::trunc); // The file written
+
+	if (!file) { throw std::exception("RNGWriteMetrics could not open the file"); }
+	file << RNGMetricsText(snapshot, labels);
+	if (!file) { throw std::exception("RNGWriteMetrics could not write the file"); }
+}
+// End RNGWriteMetrics function
+#endif
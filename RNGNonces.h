@@ -0,0 +1,148 @@
+﻿// RNGNonces.h - This header declares the NonceSource and NoncePartition classes, and implements them
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- A NonceSource provides 96-bit nonces (e.g. AES-GCM IVs) for one key. It is shared by all threads using the key, and every
+	thread takes its own NoncePartition from it, which emits nonces without any lock, atomic operation or OS call (except for the
+	buffer refills of the random mode).
+
+- In counter mode (the default), a nonce is a 32-bit random prefix chosen per key (per NonceSource) followed by a 64-bit
+	big-endian counter field: the partition's index in the upper 16 bits and the partition's own counter in the lower 48 bits
+	(the deterministic construction of NIST SP 800-38D, section 8.2.1). Partitions are handed out with a single atomic increment,
+	so nonces can never repeat under a key: a source has 65536 partitions of 2^48 nonces each, and running out of either throws
+	an exception rather than wrapping around.
+
+- In random mode, every nonce is 96 random bits from a BufferedRNGClass instance owned by the partition. Random nonces don't need
+	any coordination, but may collide: keep the number of nonces per key well below 2^32 (NIST SP 800-38D, section 8.3).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "source" as the identifier for the NonceSource instance, and "partition" for a NoncePartition instance
+
+To create a source of nonces for a key
+  declare NonceSource identifier(random)
+	random: bool, whether or not to generate fully random nonces instead of prefixed counters. If omitted, it becomes false
+
+To take a partition of the source for the current thread
+ Call source.Partition()
+   RETURN: NoncePartition
+   NOTE: Throws an exception if all partitions have been taken
+
+To generate nonces
+ Call partition.Generate(nonces, count)
+	 nonces: unsigned char*, the buffer to fill with 12 bytes per nonce
+	 count: size_t, the number of nonces to generate
+   RETURN: void
+   NOTE: Throws an exception (without writing any nonce) if the counter of the partition would run out
+*/
+
+// Include guard
+#ifndef RNGNONCES_H
+#define RNGNONCES_H
+
+// If necessary, include the header to allow atomic operations
+#ifndef _ATOMIC_
+#include <atomic>
+#endif
+// If necessary, include the header to allow smart pointers
+#ifndef _MEMORY_
+#include <memory>
+#endif
+// Include the header declaring BufferedRNGClass, which provides the prefixes and random nonces
+#include "BufferedRNGClass.h"
+
+// Define the number of bits of the counter field given to the index of the partition, and the number left for its counter
+inline constexpr unsigned int RNGNoncePartitionBits = 16;
+inline constexpr unsigned int RNGNonceCounterBits = 64 - RNGNoncePartitionBits;
+
+class NoncePartition {
+	friend class NonceSource;
+public:
+	// **** Define non-const methods ****
+
+	// Define a method to generate nonces, 12 bytes each
+	void Generate(unsigned char* nonces, size_t count) {
+		// unsigned char* nonces;	// The buffer to fill. Passed
+		// size_t count;			// The number of nonces to generate. Passed
+		unsigned long long bits[RNGBulkBlockSize];	// The random words of the current block (random mode)
+		size_t block;								// The number of nonces of the current block (random mode)
+
+		if (this->rng) {
+			// Fill whole blocks of random words and copy them out, 12 bytes per nonce (two nonces per three words)
+			while (count > 0) {
+				block = (count < RNGBulkBlockSize * 2 / 3) ? count : RNGBulkBlockSize * 2 / 3;
+				this->rng->Fill(bits, (block * 12 + 7) / 8);
+				std::memcpy(nonces, bits, block * 12);
+				SecureZeroMemory(bits, sizeof(bits));
+				nonces += block * 12;
+				count -= block;
+			} // End while(count > 0)
+			return;
+		} // End if(this->rng)
+
+		// Refuse to reuse a nonce, before writing any of them
+		if (count > this->GetRemaining()) { throw std::exception("NoncePartition counter exhausted - take a new partition"); }
+
+		// Write the prefix and the counter field, both big-endian
+		for (size_t i = 0; i < count; i++) {
+			unsigned long long field = (this->index << RNGNonceCounterBits) | (this->counter + i); // The 64-bit counter field
+			for (int b = 0; b < 4; b++) { nonces[12 * i + b] = (unsigned char)(this->prefix >> (24 - 8 * b)); }
+			for (int b = 0; b < 8; b++) { nonces[12 * i + 4 + b] = (unsigned char)(field >> (56 - 8 * b)); }
+		} // End for(i)
+		this->counter += count;
+	}
+	// End NoncePartition::Generate method
+
+	// **** Define const methods ****
+
+	// Define a method to return the index of the partition within its source
+	unsigned long long GetIndex() const { return this->index; }
+
+	// Define a method to return the number of nonces the partition can still generate (unlimited in random mode)
+	unsigned long long GetRemaining() const { return this->rng ? ~0ULL : (1ULL << RNGNonceCounterBits) - this->counter; }
+
+protected:
+	// Define the constructor, used by NonceSource
+	NoncePartition(unsigned int prefix, unsigned long long index, bool random) : prefix(prefix), index(index), counter(0) {
+		if (random) { this->rng = std::make_unique<BufferedRNGClass<unsigned long long>>(RNGBulkBlockSize * 8); }
+	}
+
+	unsigned int prefix;											// The random prefix of the source
+	unsigned long long index;										// The index of the partition
+	unsigned long long counter;										// The number of nonces generated in counter mode
+	std::unique_ptr<BufferedRNGClass<unsigned long long>> rng;		// The generator of random nonces (random mode only)
+}; // End class NoncePartition
+
+class NonceSource {
+public:
+	// Define the constructor to pick the random prefix of the key
+	explicit NonceSource(bool random = false) : random(random), next_partition(0) {
+		static RNGClass<unsigned int> seeder; // Random number generator used to pick prefixes across lifetime of the program
+		this->prefix = seeder();
+	}
+
+	// **** Define non-const methods ****
+
+	// Define a method to take a partition of the source. NOTE: Thread-safe and lock-free
+	NoncePartition Partition() {
+		unsigned long long index = this->next_partition.fetch_add(1, std::memory_order_relaxed); // The index of the new partition
+
+		// NOTE: In counter mode, the partition index is part of the nonce and can't be reused
+		if (!this->random && index >= (1ULL << RNGNoncePartitionBits)) { throw std::exception("NonceSource partitions exhausted - use a new key"); }
+		return NoncePartition(this->prefix, index, this->random);
+	}
+	// End NonceSource::Partition method
+
+	// **** Define const methods ****
+
+	// Define a method to return the prefix of the nonces (counter mode)
+	unsigned int GetPrefix() const { return this->prefix; }
+
+	// Define a method to return whether or not the nonces are fully random
+	bool IsRandom() const { return this->random; }
+
+protected:
+	unsigned int prefix;								// The random prefix of the nonces of the key
+	bool random;										// Whether or not the nonces are fully random
+	std::atomic<unsigned long long> next_partition;		// The index of the next partition to hand out
+}; // End class NonceSource
+#endif
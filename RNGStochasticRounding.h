@@ -0,0 +1,179 @@
+﻿// RNGStochasticRounding.h - This header defines the templated functions used to stochastically round single-precision numbers to
+//		bfloat16, IEEE half precision and 8-bit integers
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Stochastic rounding rounds a number up with probability equal to its distance from the lower representable neighbour (relative
+	to the gap between the two neighbours), and down otherwise, so the rounding error is zero on average.
+
+- Every number uses 16 random bits (four numbers per 64-bit random word), which is all bfloat16 needs (the 16 discarded bits) and
+	more than half precision (13 discarded bits) or 8-bit integers need for an unbiased result at practical precision.
+
+- The rounding is done on the bits: the random bits are added below the bits that are kept, and the result is truncated, so a
+	carry happens with exactly the right probability. Special values are kept: NaN stays NaN (quietened), infinities stay
+	infinite. Finite numbers that round past the largest representable number become infinite, as in IEEE arithmetic.
+
+- Half precision and bfloat16 results are written as their 16-bit patterns (unsigned short), since C++17 has no such types.
+
+- Every loop is branch-free (special cases are handled with selects), so the compiler vectorizes the rounding together with the
+	unpacking of the random words, and a whole block is processed while its random words are still in the cache.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a generator instance with a 64-bit result_type
+
+To stochastically round numbers to bfloat16
+ call StochasticRoundToBFloat16(rng, numbers, rounded, count)
+	 numbers: const float*, the numbers to round
+	 rounded: unsigned short*, the buffer to fill with the bfloat16 bit patterns
+	 count: size_t, the number of numbers to round
+   RETURN: void
+
+To stochastically round numbers to IEEE half precision
+ call StochasticRoundToFloat16(rng, numbers, rounded, count)
+	 numbers: const float*, the numbers to round
+	 rounded: unsigned short*, the buffer to fill with the half precision bit patterns
+	 count: size_t, the number of numbers to round
+   RETURN: void
+
+To stochastically round scaled numbers to 8-bit integers
+ call StochasticRoundToInt8(rng, numbers, rounded, count, scale)
+	 numbers: const float*, the numbers to round
+	 rounded: signed char*, the buffer to fill with round(number * scale), saturated to the set [-128, 127]. NaN becomes 0
+	 count: size_t, the number of numbers to round
+	 scale: float, the factor applied before rounding (e.g. 127 / the largest magnitude). If omitted, it becomes 1
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGSTOCHASTICROUNDING_H
+#define RNGSTOCHASTICROUNDING_H
+
+// If necessary, include the header to allow copying memory (used to reinterpret floats as bits)
+#ifndef _CSTRING_
+#include <cstring>
+#endif
+// Include the header defining the shared bulk primitives
+#include "RNGBulk.h"
+
+// Define the number of numbers rounded per block (four per random word)
+inline constexpr size_t RNGRoundingBlockSize = RNGBulkBlockSize * 4;
+
+// Define a templated function to stochastically round numbers to bfloat16 (the upper 16 bits of a float)
+template<typename engine_type> void StochasticRoundToBFloat16(engine_type& rng, const float* numbers, unsigned short* rounded, size_t count) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// const float* numbers;		// The numbers to round. Passed
+	// unsigned short* rounded;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to round. Passed
+	unsigned long long bits[RNGBulkBlockSize];		// The block of random words currently being used
+	unsigned int raw[RNGRoundingBlockSize];			// The bits of the numbers of the current block
+	unsigned short noise[RNGRoundingBlockSize];		// The 16 random bits of every number of the current block
+	size_t block;									// The number of numbers of the current block
+
+	// Ensure that the provided generator is usable
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for StochasticRoundToBFloat16 must have a 64-bit result_type");
+
+	while (count > 0) {
+		block = (count < RNGRoundingBlockSize) ? count : RNGRoundingBlockSize;
+		rng.Fill(bits, (block + 3) / 4);
+		std::memcpy(noise, bits, block * sizeof(unsigned short));
+		std::memcpy(raw, numbers, block * sizeof(float));
+
+		// Add the noise below the kept bits and truncate. NOTE: The carry never reaches the sign bit, and NaNs skip the noise so
+		//		their payload can't carry into the exponent
+		for (size_t i = 0; i < block; i++) {
+			bool nan = (raw[i] & 0x7FFFFFFFu) > 0x7F800000u; // Whether or not the number is NaN
+			rounded[i] = (unsigned short)(nan ? ((raw[i] >> 16) | 0x40u) : ((raw[i] + noise[i]) >> 16));
+		} // End for(i)
+
+		numbers += block;
+		rounded += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End StochasticRoundToBFloat16<engine_type> function
+
+// Define a templated function to stochastically round numbers to IEEE half precision
+template<typename engine_type> void StochasticRoundToFloat16(engine_type& rng, const float* numbers, unsigned short* rounded, size_t count) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// const float* numbers;		// The numbers to round. Passed
+	// unsigned short* rounded;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to round. Passed
+	unsigned long long bits[RNGBulkBlockSize];		// The block of random words currently being used
+	unsigned int raw[RNGRoundingBlockSize];			// The bits of the numbers of the current block
+	unsigned short noise[RNGRoundingBlockSize];		// The 16 random bits of every number of the current block
+	size_t block;									// The number of numbers of the current block
+
+	// Ensure that the provided generator is usable
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for StochasticRoundToFloat16 must have a 64-bit result_type");
+
+	while (count > 0) {
+		block = (count < RNGRoundingBlockSize) ? count : RNGRoundingBlockSize;
+		rng.Fill(bits, (block + 3) / 4);
+		std::memcpy(noise, bits, block * sizeof(unsigned short));
+		std::memcpy(raw, numbers, block * sizeof(float));
+
+		for (size_t i = 0; i < block; i++) {
+			unsigned int sign = (raw[i] >> 16) & 0x8000u;		// The sign bit, moved to its half precision position
+			unsigned int magnitude = raw[i] & 0x7FFFFFFFu;		// The bits of the absolute value
+			unsigned int fraction = noise[i] >> 3;				// 13 random bits, the width of the discarded mantissa
+
+			// Normal range (at least 2^-14): add the noise below the 10 kept mantissa bits, then rebias the exponent from 127 to
+			//		15. Anything carried to 2^16 or beyond (and infinity) becomes infinity
+			unsigned int noisy = magnitude + fraction;
+			unsigned int normal = (noisy >= 0x47800000u) ? 0x7C00u : ((noisy - 0x38000000u) >> 13);
+
+			// Subnormal range (below 2^-14): count units of 2^-24, adding a uniform fraction before truncating. NOTE: The result
+			//		can be 1024, which is the encoding of the smallest normal number, as it should be. Other numbers (including
+			//		infinities and NaNs) are zeroed first, since their count of units doesn't fit the conversion
+			float units; // The absolute value in units of 2^-24
+			std::memcpy(&units, &magnitude, sizeof(units));
+			units = (magnitude < 0x38800000u) ? units : 0.0f;
+			unsigned int subnormal = (unsigned int)(units * 16777216.0f + (float)fraction * (1.0f / 8192.0f));
+
+			unsigned int half = (magnitude >= 0x38800000u) ? normal : subnormal; // The rounded absolute value
+			half = (magnitude > 0x7F800000u) ? 0x7E00u : half;
+			rounded[i] = (unsigned short)(sign | half);
+		} // End for(i)
+
+		numbers += block;
+		rounded += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End StochasticRoundToFloat16<engine_type> function
+
+// Define a templated function to stochastically round scaled numbers to 8-bit integers
+template<typename engine_type> void StochasticRoundToInt8(engine_type& rng, const float* numbers, signed char* rounded, size_t count, float scale = 1) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// const float* numbers;		// The numbers to round. Passed
+	// signed char* rounded;		// The buffer to fill. Passed
+	// size_t count;				// The number of numbers to round. Passed
+	// float scale;					// The factor applied before rounding. Passed. 1 if omitted
+	unsigned long long bits[RNGBulkBlockSize];		// The block of random words currently being used
+	unsigned short noise[RNGRoundingBlockSize];		// The 16 random bits of every number of the current block
+	size_t block;									// The number of numbers of the current block
+
+	// Ensure that the provided generator is usable
+	static_assert(sizeof(typename engine_type::result_type) == 8, "The generator provided for StochasticRoundToInt8 must have a 64-bit result_type");
+
+	while (count > 0) {
+		block = (count < RNGRoundingBlockSize) ? count : RNGRoundingBlockSize;
+		rng.Fill(bits, (block + 3) / 4);
+		std::memcpy(noise, bits, block * sizeof(unsigned short));
+
+		// Add a uniform fraction and round down, saturating before the conversion. NOTE: The comparisons are false for NaN, which
+		//		the final select turns into 0
+		for (size_t i = 0; i < block; i++) {
+			float value = std::floor(numbers[i] * scale + (float)noise[i] * (1.0f / 65536.0f)); // The rounded number
+			value = (value < -128.0f) ? -128.0f : value;
+			value = (value > 127.0f) ? 127.0f : value;
+			rounded[i] = (signed char)((value == value) ? (int)value : 0);
+		} // End for(i)
+
+		numbers += block;
+		rounded += block;
+		count -= block;
+	} // End while(count > 0)
+}
+// End StochasticRoundToInt8<engine_type> function
+#endif
@@ -0,0 +1,203 @@
+﻿// RNGTokens.h - This header declares the TokenGenerator class, and implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- A TokenGenerator writes many fixed-length tokens (session tokens, API keys, passwords) per call into a caller-provided arena,
+	with no allocation per token. All random bits come from a BufferedRNGClass instance (the OS's secure generator), and every
+	character is uniformly distributed over the alphabet.
+
+- For alphabets whose size is a power of two (hex, Crockford base32, base64url, or a custom one), every random word is cut into as
+	many b-bit indices as fit (16 hexadecimal, 12 base32 or 10 base64url characters per word), so no bit is rejected. Indices are
+	mapped to hexadecimal and base64url characters arithmetically, in branch-free loops the compiler vectorizes, and through a
+	table otherwise.
+
+- For other alphabet sizes n, indices are extracted in batches: a random word x is multiplied by n repeatedly, every upper half
+	being an index and every lower half the x of the next index. That is Lemire's method applied to the k-digit number in base n,
+	so the k indices are unbiased unless the final lower half falls below 2^64 mod n^k, in which case the whole batch is redrawn.
+	k is chosen so that n^k ≤ 2^56, which keeps redraws below 1 in 256 words.
+
+- An instance is NOT thread-safe, so give every thread its own.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "tokens" as the identifier for the TokenGenerator instance
+
+To create a generator of lowercase hexadecimal, Crockford base32 or base64url (RFC 4648, section 5) tokens
+ call TokenGenerator::Hex(), TokenGenerator::Base32() or TokenGenerator::Base64URL()
+   RETURN: TokenGenerator
+
+To create a generator of tokens over a custom alphabet (e.g. for passwords)
+ call TokenGenerator::Custom(characters)
+	 characters: const std::string&, the alphabet. Must have between 2 and 256 characters, which should be distinct
+   RETURN: TokenGenerator
+
+To generate tokens into an arena
+ Call tokens.Generate(arena, length, count, terminate)
+	 arena: char*, the buffer to fill, with token i starting at i * length (or i * (length + 1) if terminated)
+	 length: size_t, the number of characters of every token
+	 count: size_t, the number of tokens to generate
+	 terminate: bool, whether or not to follow every token with a '\0'. If omitted, it becomes false
+   RETURN: void
+
+To fill a buffer with random characters of the alphabet
+ Call tokens.Fill(text, count)
+	 text: char*, the buffer to fill
+	 count: size_t, the number of characters to write
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGTOKENS_H
+#define RNGTOKENS_H
+
+// Include the header declaring BufferedRNGClass, which provides the random bits
+#include "BufferedRNGClass.h"
+
+// Define the maximum number of characters generated per block
+inline constexpr size_t RNGTokenBlockSize = RNGBulkBlockSize * 8;
+
+class TokenGenerator {
+public:
+	// **** Define static factory methods ****
+
+	// Define a method to create a generator of lowercase hexadecimal tokens
+	static TokenGenerator Hex() { return TokenGenerator("0123456789abcdef", KIND_HEX); }
+
+	// Define a method to create a generator of Crockford base32 tokens (no I, L, O or U)
+	static TokenGenerator Base32() { return TokenGenerator("0123456789ABCDEFGHJKMNPQRSTVWXYZ", KIND_TABLE); }
+
+	// Define a method to create a generator of base64url tokens
+	static TokenGenerator Base64URL() { return TokenGenerator("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_", KIND_BASE64URL); }
+
+	// Define a method to create a generator of tokens over a custom alphabet
+	static TokenGenerator Custom(const std::string& characters) { return TokenGenerator(characters, KIND_TABLE); }
+
+	// **** Define non-const methods ****
+
+	// Define a method to generate tokens into an arena
+	void Generate(char* arena, size_t length, size_t count, bool terminate = false) {
+		// char* arena;		// The buffer to fill. Passed
+		// size_t length;	// The number of characters of every token. Passed
+		// size_t count;	// The number of tokens to generate. Passed
+		// bool terminate;	// Whether or not to follow every token with a '\0'. Passed. False if omitted
+
+		// Generate all the characters contiguously, then (if necessary) spread the tokens out from the last one, making room for
+		//		the terminators without any temporary buffer
+		this->Fill(arena, length * count);
+		if (terminate) {
+			for (size_t i = count; i > 0; i--) {
+				std::memmove(arena + (i - 1) * (length + 1), arena + (i - 1) * length, length);
+				arena[(i - 1) * (length + 1) + length] = '\0';
+			} // End for(i)
+		} // End if(terminate)
+	}
+	// End TokenGenerator::Generate method
+
+	// Define a method to fill a buffer with random characters of the alphabet
+	void Fill(char* text, size_t count) {
+		// char* text;		// The buffer to fill. Passed
+		// size_t count;	// The number of characters to write. Passed
+		unsigned long long bits[RNGBulkBlockSize];	// The random words of the current block
+		unsigned char indices[RNGTokenBlockSize];	// The indices of the characters of the current block
+		size_t words;								// The number of random words of the current block
+		size_t block;								// The number of characters of the current block
+
+		while (count > 0) {
+			// NOTE: Alphabets with fewer than 8 characters per word would overflow bits before indices, so cap by both buffers
+			words = (count + this->per_word - 1) / this->per_word;
+			if (words > RNGTokenBlockSize / this->per_word) { words = RNGTokenBlockSize / this->per_word; }
+			if (words > RNGBulkBlockSize) { words = RNGBulkBlockSize; }
+			block = (count < words * this->per_word) ? count : words * this->per_word;
+			this->rng.Fill(bits, words);
+
+			if (this->bits_per_index > 0) {
+				// Cut every word into indices of the same width. NOTE: The inner loop has a fixed trip count per alphabet
+				unsigned long long mask = (1ULL << this->bits_per_index) - 1; // The bits of an index
+				for (size_t w = 0; w < words; w++) {
+					for (unsigned int k = 0; k < this->per_word; k++) { indices[w * this->per_word + k] = (unsigned char)((bits[w] >> (k * this->bits_per_index)) & mask); }
+				} // End for(w)
+			} // End if(this->bits_per_index > 0)
+			else {
+				// Extract the digits of every word in base n, redrawing any word whose digits would be biased
+				for (size_t w = 0; w < words; w++) {
+					while (!this->Digits(bits[w], indices + w * this->per_word)) { bits[w] = this->rng(); }
+				} // End for(w)
+			} // End else
+
+			// Map the indices to characters
+			if (this->kind == KIND_HEX) {
+				for (size_t i = 0; i < block; i++) { text[i] = (char)(indices[i] + '0' + (indices[i] >= 10) * ('a' - '0' - 10)); }
+			}
+			else if (this->kind == KIND_BASE64URL) {
+				for (size_t i = 0; i < block; i++) {
+					int index = indices[i]; // The index of the current character
+					text[i] = (char)(index + 'A' + (index >= 26) * ('a' - 'A' - 26) + (index >= 52) * ('0' - 'a' - 26) + (index >= 62) * ('-' - '0' - 10) + (index >= 63) * ('_' - '-' - 1));
+				} // End for(i)
+			} // End else if(this->kind == KIND_BASE64URL)
+			else { for (size_t i = 0; i < block; i++) { text[i] = this->characters[indices[i]]; } }
+
+			SecureZeroMemory(bits, words * sizeof(unsigned long long));
+			SecureZeroMemory(indices, words * this->per_word);
+			text += block;
+			count -= block;
+		} // End while(count > 0)
+	}
+	// End TokenGenerator::Fill method
+
+	// **** Define const methods ****
+
+	// Define a method to return the alphabet
+	const std::string& GetAlphabet() const { return this->characters; }
+
+	// Define a method to return the number of bits of entropy per character
+	double GetBitsPerCharacter() const { return std::log2((double)this->characters.size()); }
+
+protected:
+	enum Kind { KIND_TABLE, KIND_HEX, KIND_BASE64URL }; // How indices are mapped to characters
+
+	// Define the constructor to prepare the extraction of indices for the provided alphabet
+	TokenGenerator(const std::string& characters, Kind kind) : characters(characters), kind(kind), bits_per_index(0), per_word(0), product(1), threshold(0) {
+		// const std::string& characters;	// The alphabet. Passed
+		// Kind kind;						// How indices are mapped to characters. Passed
+		size_t size = characters.size();	// The number of characters of the alphabet
+
+		// Ensure that the alphabet is usable
+		assert(("An alphabet must have between 2 and 256 characters", size >= 2 && size <= 256));
+
+		// If the size is a power of two, cut words into indices of its width, otherwise batch as many digits as n^k ≤ 2^56 allows
+		if ((size & (size - 1)) == 0) {
+			while ((1ULL << this->bits_per_index) < size) { this->bits_per_index++; }
+			this->per_word = 64 / this->bits_per_index;
+		} // End if((size & (size - 1)) == 0)
+		else {
+			while (this->product <= (1ULL << 56) / size) {
+				this->product *= size;
+				this->per_word++;
+			} // End while(this->product <= (1ULL << 56) / size)
+			this->threshold = (0 - this->product) % this->product;
+		} // End else
+	}
+
+	// Define a method to extract the base n digits of a random word, returning whether or not they are unbiased
+	bool Digits(unsigned long long bits, unsigned char* indices) const {
+		// unsigned long long bits;		// The random word. Passed
+		// unsigned char* indices;		// The buffer to fill with the digits. Passed
+		unsigned long long low;			// The lower half of the current product
+
+		// NOTE: The final lower half is the lower half of bits * n^k, which is what Lemire's method checks
+		for (unsigned int k = 0; k < this->per_word; k++) {
+			indices[k] = (unsigned char)RNGMultiply128(bits, this->characters.size(), low);
+			bits = low;
+		} // End for(k)
+		return bits >= this->threshold;
+	}
+	// End TokenGenerator::Digits method
+
+	std::string characters;						// The alphabet
+	Kind kind;									// How indices are mapped to characters
+	unsigned int bits_per_index;				// The width of an index if the size of the alphabet is a power of two, otherwise 0
+	unsigned int per_word;						// The number of characters extracted per random word
+	unsigned long long product;					// n^k, where k is per_word (only for other sizes)
+	unsigned long long threshold;				// 2^64 mod n^k, below which a word's digits are biased (only for other sizes)
+	BufferedRNGClass<unsigned long long> rng;	// The secure generator of the random bits
+}; // End class TokenGenerator
+#endif
@@ -0,0 +1,223 @@
+﻿// RNGUUID.h - This header declares the UUIDGenerator class, and implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- UUIDs are generated in bulk into caller buffers, either as 16 binary bytes each (in the byte order of RFC 9562) or as
+	36-character strings (lowercase, with dashes, without terminators). All random bits come from a BufferedRNGClass instance, so
+	a whole block of UUIDs costs at most one OS call.
+
+- Version 4 UUIDs are 122 random bits. Version 7 UUIDs start with the Unix time in milliseconds, followed by a 12-bit counter and
+	62 random bits, so they sort by creation time. Within the same millisecond the counter is incremented (starting from a random
+	number below 2048 every millisecond), so the UUIDs of an instance are strictly increasing. If the counter runs out, or the
+	clock goes backwards, the timestamp is advanced past the last one used instead (RFC 9562, section 6.2).
+
+- The clock is read once per block of UUIDs, not once per UUID.
+
+- Strings are formatted with SSE2 (16 bytes to 32 hexadecimal digits in a handful of instructions) where it is available, which is
+	always the case on x64, and with a table otherwise.
+
+- An instance of UUIDGenerator is NOT thread-safe (and the ordering of version 7 UUIDs is per instance). Give every thread its own
+	instance.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "uuids" as the identifier for the UUIDGenerator instance
+
+To create a UUID generator
+  declare UUIDGenerator identifier
+
+To generate binary UUIDs
+ Call uuids.GenerateV4(bytes, count) or uuids.GenerateV7(bytes, count)
+	 bytes: unsigned char*, the buffer to fill with 16 bytes per UUID
+	 count: size_t, the number of UUIDs to generate
+   RETURN: void
+
+To generate UUIDs as strings
+ Call uuids.GenerateV4Strings(text, count) or uuids.GenerateV7Strings(text, count)
+	 text: char*, the buffer to fill with 36 characters per UUID (no terminators)
+	 count: size_t, the number of UUIDs to generate
+   RETURN: void
+
+To format binary UUIDs as strings
+ Call UUIDGenerator::Format(bytes, count, text)
+	 bytes: const unsigned char*, the UUIDs, 16 bytes each
+	 count: size_t, the number of UUIDs
+	 text: char*, the buffer to fill with 36 characters per UUID (no terminators)
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGUUID_H
+#define RNGUUID_H
+
+// If necessary, include the header to allow reading the system clock
+#ifndef _CHRONO_
+#include <chrono>
+#endif
+// If the target has SSE2, include the header declaring its intrinsics (used for formatting)
+#if (defined(_M_X64) || defined(__SSE2__)) && !defined(_INCLUDED_EMM)
+#include <emmintrin.h>
+#endif
+// Include the header declaring BufferedRNGClass, which provides the random bits
+#include "BufferedRNGClass.h"
+
+// Define the number of UUIDs generated per block (and per reading of the clock)
+inline constexpr size_t RNGUUIDBlockSize = RNGBulkBlockSize / 2;
+
+class UUIDGenerator {
+public:
+	// Define the default constructor
+	UUIDGenerator() : rng(RNGBulkBlockSize), last_time(0), counter(0) {}
+
+	// **** Define non-const methods ****
+
+	// Define a method to generate version 4 (random) UUIDs
+	void GenerateV4(unsigned char* bytes, size_t count) {
+		// unsigned char* bytes;	// The buffer to fill with 16 bytes per UUID. Passed
+		// size_t count;			// The number of UUIDs to generate. Passed
+		unsigned long long bits[RNGUUIDBlockSize * 2];	// The random bits of the current block
+		size_t block;									// The number of UUIDs of the current block
+
+		while (count > 0) {
+			block = (count < RNGUUIDBlockSize) ? count : RNGUUIDBlockSize;
+			this->rng.Fill(bits, block * 2);
+			std::memcpy(bytes, bits, block * 16);
+
+			// Set the version (4) and the variant (binary 10)
+			for (size_t i = 0; i < block; i++) {
+				bytes[16 * i + 6] = (unsigned char)((bytes[16 * i + 6] & 0x0F) | 0x40);
+				bytes[16 * i + 8] = (unsigned char)((bytes[16 * i + 8] & 0x3F) | 0x80);
+			} // End for(i)
+
+			SecureZeroMemory(bits, block * 16);
+			bytes += block * 16;
+			count -= block;
+		} // End while(count > 0)
+	}
+	// End UUIDGenerator::GenerateV4 method
+
+	// Define a method to generate version 7 (time-ordered) UUIDs, strictly increasing for this instance
+	void GenerateV7(unsigned char* bytes, size_t count) {
+		// unsigned char* bytes;	// The buffer to fill with 16 bytes per UUID. Passed
+		// size_t count;			// The number of UUIDs to generate. Passed
+		unsigned long long bits[RNGUUIDBlockSize];		// The random bits of the current block (62 per UUID)
+		unsigned long long now;							// The time of the current block, in milliseconds since 1970
+		size_t block;									// The number of UUIDs of the current block
+
+		while (count > 0) {
+			block = (count < RNGUUIDBlockSize) ? count : RNGUUIDBlockSize;
+			this->rng.Fill(bits, block);
+			now = (unsigned long long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+			for (size_t i = 0; i < block; i++) {
+				unsigned char* uuid = bytes + 16 * i; // The bytes of the current UUID
+
+				// Advance the timestamp and counter. NOTE: If the clock went backwards, the last timestamp is kept
+				if (now > this->last_time) {
+					this->last_time = now;
+					this->counter = (unsigned int)(this->rng() & 0x7FF);
+				}
+				else if (++this->counter > 0xFFF) {
+					this->last_time++;
+					this->counter = (unsigned int)(this->rng() & 0x7FF);
+				} // End else if(++this->counter > 0xFFF)
+
+				// Write the 48-bit timestamp (big-endian), the version (7) with the counter, the variant and the random bits
+				for (int b = 0; b < 6; b++) { uuid[b] = (unsigned char)(this->last_time >> (40 - 8 * b)); }
+				uuid[6] = (unsigned char)(0x70 | (this->counter >> 8));
+				uuid[7] = (unsigned char)this->counter;
+				std::memcpy(uuid + 8, &bits[i], 8);
+				uuid[8] = (unsigned char)((uuid[8] & 0x3F) | 0x80);
+			} // End for(i)
+
+			SecureZeroMemory(bits, block * 8);
+			bytes += block * 16;
+			count -= block;
+		} // End while(count > 0)
+	}
+	// End UUIDGenerator::GenerateV7 method
+
+	// Define a method to generate version 4 UUIDs as strings
+	void GenerateV4Strings(char* text, size_t count) {
+		// char* text;		// The buffer to fill with 36 characters per UUID. Passed
+		// size_t count;	// The number of UUIDs to generate. Passed
+		unsigned char bytes[RNGUUIDBlockSize * 16];	// The binary UUIDs of the current block
+		size_t block;								// The number of UUIDs of the current block
+
+		while (count > 0) {
+			block = (count < RNGUUIDBlockSize) ? count : RNGUUIDBlockSize;
+			this->GenerateV4(bytes, block);
+			UUIDGenerator::Format(bytes, block, text);
+			text += block * 36;
+			count -= block;
+		} // End while(count > 0)
+	}
+	// End UUIDGenerator::GenerateV4Strings method
+
+	// Define a method to generate version 7 UUIDs as strings
+	void GenerateV7Strings(char* text, size_t count) {
+		// char* text;		// The buffer to fill with 36 characters per UUID. Passed
+		// size_t count;	// The number of UUIDs to generate. Passed
+		unsigned char bytes[RNGUUIDBlockSize * 16];	// The binary UUIDs of the current block
+		size_t block;								// The number of UUIDs of the current block
+
+		while (count > 0) {
+			block = (count < RNGUUIDBlockSize) ? count : RNGUUIDBlockSize;
+			this->GenerateV7(bytes, block);
+			UUIDGenerator::Format(bytes, block, text);
+			text += block * 36;
+			count -= block;
+		} // End while(count > 0)
+	}
+	// End UUIDGenerator::GenerateV7Strings method
+
+	// Define a static method to format binary UUIDs as 36-character strings
+	static void Format(const unsigned char* bytes, size_t count, char* text) {
+		// const unsigned char* bytes;	// The UUIDs, 16 bytes each. Passed
+		// size_t count;				// The number of UUIDs. Passed
+		// char* text;					// The buffer to fill with 36 characters per UUID. Passed
+		char digits[32];				// The 32 hexadecimal digits of the current UUID
+
+		for (size_t i = 0; i < count; i++) {
+#if defined(_M_X64) || defined(__SSE2__)
+			// Split every byte into its two nibbles (upper first), then map 0-9 to '0'-'9' and 10-15 to 'a'-'f'
+			__m128i value = _mm_loadu_si128((const __m128i*)(bytes + 16 * i));		// The 16 bytes
+			__m128i nibble = _mm_set1_epi8(0x0F);									// The mask of a nibble
+			__m128i upper = _mm_and_si128(_mm_srli_epi16(value, 4), nibble);		// The upper nibbles
+			__m128i lower = _mm_and_si128(value, nibble);							// The lower nibbles
+			__m128i halves[2] = { _mm_unpacklo_epi8(upper, lower), _mm_unpackhi_epi8(upper, lower) }; // The nibbles, in order
+			for (int h = 0; h < 2; h++) {
+				__m128i letters = _mm_and_si128(_mm_cmpgt_epi8(halves[h], _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10)); // The offset of the letters
+				_mm_storeu_si128((__m128i*)(digits + 16 * h), _mm_add_epi8(_mm_add_epi8(halves[h], _mm_set1_epi8('0')), letters));
+			} // End for(h)
+#else
+			for (int b = 0; b < 16; b++) {
+				digits[2 * b] = "0123456789abcdef"[bytes[16 * i + b] >> 4];
+				digits[2 * b + 1] = "0123456789abcdef"[bytes[16 * i + b] & 0x0F];
+			} // End for(b)
+#endif
+			// Insert the dashes between the groups of 8, 4, 4, 4 and 12 digits
+			std::memcpy(text, digits, 8);
+			text[8] = '-';
+			std::memcpy(text + 9, digits + 8, 4);
+			text[13] = '-';
+			std::memcpy(text + 14, digits + 12, 4);
+			text[18] = '-';
+			std::memcpy(text + 19, digits + 16, 4);
+			text[23] = '-';
+			std::memcpy(text + 24, digits + 20, 12);
+			text += 36;
+		} // End for(i)
+	}
+	// End UUIDGenerator::Format method
+
+	// **** Define const methods ****
+
+	// Define a method to return the timestamp of the last version 7 UUID, in milliseconds since 1970
+	unsigned long long GetLastTime() const { return this->last_time; }
+
+protected:
+	BufferedRNGClass<unsigned long long> rng;	// The secure generator of the random bits
+	unsigned long long last_time;				// The timestamp of the last version 7 UUID
+	unsigned int counter;						// The counter of the last version 7 UUID
+}; // End class UUIDGenerator
+#endif
@@ -0,0 +1,206 @@
+﻿// RNGVarianceReduction.h - This header declares the AntitheticRNGClass and CommonRandomNumbers classes, and (due to the former
+//		being a class template) implements them, as well as defining the antithetic bulk fill functions
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- Antithetic variates: a Monte Carlo run is done twice, once with the numbers u of a stream and once with their mirror images
+	(1 - u for uniform numbers, -z for normal numbers). The mirrored run is negatively correlated with the original, so averaging
+	each pair reaches a given confidence interval with fewer samples whenever the simulated quantity is monotonic in its inputs.
+
+- Common random numbers: when comparing scenarios, every scenario is driven by the same numbers, so the difference between
+	scenarios is not drowned by sampling noise. CommonRandomNumbers hands out streams that depend only on the replication and the
+	purpose of the stream (e.g. "arrivals" = 0, "service times" = 1), never on the scenario, so the numbers stay aligned even when
+	one scenario consumes more numbers for one purpose than another.
+
+- AntitheticRNGClass mirrors whole streams, so existing simulation code that takes a generator can be run antithetically without
+	changes. A mirrored FloatingRand number lies in the set (floor, roof] rather than [floor, roof).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+To create a generator that replays a SeededRNGClass stream, optionally mirrored
+  declare AntitheticRNGClass<result_type> identifier(engine, antithetic)
+	engine: SeededRNGClass<result_type>, the stream to replay (copied, so the original is unaffected)
+	antithetic: bool, whether or not to mirror the stream. If omitted, it becomes true
+ NOTE: The instance offers everything a SeededRNGClass instance does (rng(), GetRand, CustomRand, FloatingRand, NormalRand, Fill)
+
+To fill two buffers with antithetic pairs of uniform floating-point numbers
+ call FillAntitheticFloatingRand(rng, numbers, mirrored, count, floor, roof)
+	 numbers: floating_type*, the buffer to fill with numbers in the set [floor, roof)
+	 mirrored: floating_type*, the buffer to fill with the mirror images (floor + roof - number)
+	 count: size_t, the number of pairs to write
+	 floor: floating_type, the minimum possible number. If omitted, it becomes 0
+	 roof: floating_type, the upper bound of the numbers. If omitted, it becomes 1
+   RETURN: void
+
+To fill two buffers with antithetic pairs of normally distributed floating-point numbers
+ call FillAntitheticNormalRand(rng, numbers, mirrored, count, mean, deviation)
+	 numbers: floating_type*, the buffer to fill
+	 mirrored: floating_type*, the buffer to fill with the mirror images (2 * mean - number)
+	 count: size_t, the number of pairs to write
+	 mean: floating_type, the mean of the distribution. If omitted, it becomes 0
+	 deviation: floating_type, the standard deviation of the distribution. If omitted, it becomes 1
+   RETURN: void
+
+To create a source of common random numbers shared by all scenarios of an experiment
+  declare CommonRandomNumbers identifier(seed)
+	seed: unsigned long long, the seed of the experiment
+
+To get the stream for a replication and purpose (identical for every scenario)
+ Call crn.Stream<result_type>(replication, purpose)
+	 result_type: the type of the stream's numbers. If omitted, it becomes unsigned long long
+	 replication: unsigned long long, the index of the replication
+	 purpose: unsigned long long, the index of what the stream is used for. If omitted, it becomes 0
+   RETURN: SeededRNGClass<result_type>
+
+To get the same stream, mirrored (or not) for an antithetic replication
+ Call crn.AntitheticStream<result_type>(replication, purpose, antithetic)
+	 antithetic: bool, whether or not to mirror the stream. If omitted, it becomes true
+   RETURN: AntitheticRNGClass<result_type>
+*/
+
+// Include guard
+#ifndef RNGVARIANCEREDUCTION_H
+#define RNGVARIANCEREDUCTION_H
+
+// Include the header declaring SeededRNGClass, which provides the reproducible streams
+#include "SeededRNGClass.h"
+
+// typename T; // The type of number to generate. Must be unsigned
+template <typename T>
+class AntitheticRNGClass { // NOTE: Like RNGClass, this class is compliant with §29.6.1.3 of the C++17 standard draft
+public:
+	// Create result_type as an alias for T (the provided type)
+	typedef T result_type;
+
+	// Define the constructor to replay the provided stream, optionally mirrored
+	explicit AntitheticRNGClass(const SeededRNGClass<T>& engine, bool antithetic = true) : engine(engine), antithetic(antithetic) {}
+
+	// **** Define non-const methods ****
+
+	// Define the () operator to return the next number of the stream, mirrored within { number ∈ result_type | min() ≤ number ≤ max() }
+	//		if necessary. NOTE: Complementing the bits mirrors every number derived from them, including FloatingRand ones
+	result_type operator()() { return this->antithetic ? (result_type)~this->engine() : this->engine(); }
+
+	// Define an overload of the () operator to return a number in the set { number ∈ result_type | floor ≤ number ≤ roof }
+	result_type operator()(result_type floor, result_type roof) { return this->CustomRand<result_type>(floor, roof); }
+
+	// Define a method to fill a buffer with the next numbers of the stream, mirrored if necessary
+	void Fill(result_type* numbers, size_t count) {
+		// result_type* numbers;	// The buffer to fill. Passed
+		// size_t count;			// The number of numbers to write to the buffer. Passed
+
+		this->engine.Fill(numbers, count);
+		if (this->antithetic) { for (size_t i = 0; i < count; i++) { numbers[i] = (result_type)~numbers[i]; } }
+	}
+	// End AntitheticRNGClass<T>::Fill method
+
+	// Define a method to choose whether or not the stream is mirrored from now on
+	void SetAntithetic(bool antithetic) { this->antithetic = antithetic; }
+
+	// Define a method to return a random number (since pointers can't access the "()" operator in an easily readable way)
+	result_type GetRand() { return this->operator()(); }
+
+	// Define an overload of GetRand to return a random number of the specified type in the specified range
+	result_type GetRand(result_type floor, result_type roof) { return this->operator()(floor, roof); }
+
+	// Define a templated method to generate a random number over the specified range, mirrored around its centre if necessary
+	template<typename cast_type> cast_type CustomRand(cast_type floor = RNGLowest<cast_type>(), cast_type roof = RNGHighest<cast_type>()) {
+		// cast_type floor; // The minimum number that can be returned. Passed. Minimum of the type if omitted
+		// cast_type roof;	// The maximum number that can be returned. Passed. Maximum of the type if omitted
+		typedef RNGUnsignedOfT<cast_type> unsigned_type; // The unsigned type used to mirror the number without overflow
+		cast_type number = this->engine.template CustomRand<cast_type>(floor, roof); // The number of the original stream
+
+		// Mirror the number: floor + roof - number, calculated with unsigned wraparound
+		if (this->antithetic) { number = (cast_type)((unsigned_type)floor + (unsigned_type)roof - (unsigned_type)number); }
+		return number;
+	}
+	// End AntitheticRNGClass<T>::CustomRand<cast_type> method
+
+	// Define a templated method to generate a random floating-point number over the specified range, mirrored if necessary
+	template<typename floating_type> floating_type FloatingRand(floating_type floor = 0, floating_type roof = 1) {
+		// floating_type floor;		// The minimum number that can be returned. Passed. 0 if omitted
+		// floating_type roof;		// The upper bound of the numbers. Passed. 1 if omitted
+		floating_type number = this->engine.template FloatingRand<floating_type>(floor, roof); // The number of the original stream
+
+		return this->antithetic ? floor + roof - number : number;
+	}
+	// End AntitheticRNGClass<T>::FloatingRand<floating_type> method
+
+	// Define a templated method to generate a normally distributed floating-point number, mirrored around the mean if necessary
+	template<typename floating_type> floating_type NormalRand(floating_type mean = 0, floating_type deviation = 1) {
+		// floating_type mean;		// The mean of the distribution. Passed. 0 if omitted
+		// floating_type deviation;	// The standard deviation of the distribution. Passed. 1 if omitted
+		floating_type number = this->engine.template NormalRand<floating_type>(0, deviation); // The deviation from the mean
+
+		return this->antithetic ? mean - number : mean + number;
+	}
+	// End AntitheticRNGClass<T>::NormalRand<floating_type> method
+
+	// **** Define const methods ****
+
+	// Define a method to return whether or not the stream is mirrored
+	bool IsAntithetic() const { return this->antithetic; }
+
+	// Define the methods "max" and "min" to return the limits of the provided type. NOTE: Names are wrapped in "()" to avoid the
+	//		compiler trying to replace them with the macros defined in Windows.h
+	static constexpr T(max)() { return (std::numeric_limits<T>::max)(); }
+	static constexpr T(min)() { return 0; }
+
+protected:
+	SeededRNGClass<T> engine;	// The stream being replayed
+	bool antithetic;			// Boolean for whether or not the stream is mirrored
+}; // End class AntitheticRNGClass
+
+class CommonRandomNumbers {
+public:
+	// Define the constructor to create the source from the seed of the experiment
+	explicit CommonRandomNumbers(unsigned long long seed) : root(seed) {}
+
+	// Define a templated method to return the stream of a replication and purpose, which does not depend on the scenario
+	template<typename T = unsigned long long> SeededRNGClass<T> Stream(unsigned long long replication, unsigned long long purpose = 0) const {
+		// unsigned long long replication;	// The index of the replication. Passed
+		// unsigned long long purpose;		// The index of what the stream is used for. Passed. 0 if omitted
+		SeededRNGClass<unsigned long long> stream = this->root.Substream(replication).Substream(purpose); // The derived stream
+
+		return SeededRNGClass<T>(stream.GetSeed(), stream.GetStream());
+	}
+	// End CommonRandomNumbers::Stream<T> method
+
+	// Define a templated method to return the stream of a replication and purpose, mirrored (or not) for antithetic replications
+	template<typename T = unsigned long long> AntitheticRNGClass<T> AntitheticStream(unsigned long long replication, unsigned long long purpose = 0, bool antithetic = true) const {
+		return AntitheticRNGClass<T>(this->Stream<T>(replication, purpose), antithetic);
+	}
+	// End CommonRandomNumbers::AntitheticStream<T> method
+
+protected:
+	SeededRNGClass<unsigned long long> root; // The stream of the experiment, from which every other stream is split off
+}; // End class CommonRandomNumbers
+
+// Define a templated function to fill two buffers with antithetic pairs of uniform floating-point numbers
+template<typename engine_type, typename floating_type> void FillAntitheticFloatingRand(engine_type& rng, floating_type* numbers, floating_type* mirrored, size_t count, floating_type floor = 0, floating_type roof = 1) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// floating_type* numbers;		// The buffer to fill with numbers in the set [floor, roof). Passed
+	// floating_type* mirrored;		// The buffer to fill with the mirror images of the numbers. Passed
+	// size_t count;				// The number of pairs to write. Passed
+	// floating_type floor;			// The minimum possible number. Passed. 0 if omitted
+	// floating_type roof;			// The upper bound of the numbers. Passed. 1 if omitted
+
+	// Only half of the numbers are random, so generate them and mirror them in a second vectorizable pass
+	FillFloatingRand(rng, numbers, count, floor, roof);
+	for (size_t i = 0; i < count; i++) { mirrored[i] = floor + roof - numbers[i]; }
+}
+// End FillAntitheticFloatingRand<engine_type, floating_type> function
+
+// Define a templated function to fill two buffers with antithetic pairs of normally distributed floating-point numbers
+template<typename engine_type, typename floating_type> void FillAntitheticNormalRand(engine_type& rng, floating_type* numbers, floating_type* mirrored, size_t count, floating_type mean = 0, floating_type deviation = 1) {
+	// engine_type& rng;			// The generator to pull bits from. Passed by reference
+	// floating_type* numbers;		// The buffer to fill. Passed
+	// floating_type* mirrored;		// The buffer to fill with the mirror images of the numbers. Passed
+	// size_t count;				// The number of pairs to write. Passed
+	// floating_type mean;			// The mean of the distribution. Passed. 0 if omitted
+	// floating_type deviation;		// The standard deviation of the distribution. Passed. 1 if omitted
+
+	FillNormalRand(rng, numbers, count, mean, deviation);
+	for (size_t i = 0; i < count; i++) { mirrored[i] = 2 * mean - numbers[i]; }
+}
+// End FillAntitheticNormalRand<engine_type, floating_type> function
+#endif
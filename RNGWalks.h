@@ -0,0 +1,254 @@
+﻿// RNGWalks.h - This header declares the RandomWalkEngine class, and (due to it being a class template) implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- The graph is passed in compressed sparse row (CSR) form: the neighbours of node u are targets[offsets[u]] to
+	targets[offsets[u + 1] - 1], with the matching (optional) weights at the same positions. The engine only keeps pointers to
+	these arrays, so they must outlive it and must not change.
+
+- For weighted graphs, an alias table (Vose's method) is built for every node when the engine is created, so every step of a
+	walk costs one random number and at most two memory reads whatever the degree. Unweighted graphs need no tables at all. The
+	tables use 32-bit fixed point, so degrees must be below 2^32.
+
+- Walks are first-order (DeepWalk) when both node2vec parameters are 1. Otherwise, every step is second-order (node2vec): a
+	neighbour x of the current node is proposed from the first-order distribution and accepted with probability proportional to
+	1 / return_parameter if x is the previous node, 1 if x is a neighbour of the previous node, and 1 / in_out_parameter otherwise.
+	This rejection sampling needs no per-edge tables. NOTE: Neighbour lists must be sorted for second-order walks, since the
+	neighbour check is a binary search.
+
+- Walk i of a batch is driven by substream (first_walk + i) of the provided SeededRNGClass instance, so walks are reproducible
+	however they are split between threads. GenerateParallel splits a batch into equal ranges, one thread per range.
+
+- Walks are written into a flat buffer, one row of "length" nodes per walk, starting with the start node. A walk reaching a node
+	without neighbours stops there, and the rest of its row is filled with RandomWalkEngine::END.
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for a SeededRNGClass<unsigned long long> instance, and "walker" as the identifier for
+	the RandomWalkEngine instance
+
+To create a random walk engine over a CSR graph
+  declare RandomWalkEngine<node_type> identifier(nodes, offsets, targets, weights, return_parameter, in_out_parameter)
+	node_type: An *UNSIGNED* integral type used for node indices (e.g. "unsigned int")
+	nodes: size_t, the number of nodes
+	offsets: const unsigned long long*, the nodes + 1 offsets of the neighbour lists
+	targets: const node_type*, the neighbour lists
+	weights: const float*, the weight of every edge, or nullptr if the graph is unweighted. If omitted, it becomes nullptr
+	return_parameter: double, node2vec's p. If omitted, it becomes 1
+	in_out_parameter: double, node2vec's q. If omitted, it becomes 1
+
+To generate a batch of walks
+ Call walker.Generate(rng, starts, walk_count, length, walks, first_walk)
+	 starts: const node_type*, the start node of every walk
+	 walk_count: size_t, the number of walks
+	 length: size_t, the number of nodes of every walk (including the start node)
+	 walks: node_type*, the buffer to fill, holding walk_count * length nodes
+	 first_walk: unsigned long long, the index of the first walk (selects the substreams used). If omitted, it becomes 0
+   RETURN: void
+
+To generate a batch of walks with multiple threads
+ Call walker.GenerateParallel(rng, starts, walk_count, length, walks, threads, first_walk)
+	 threads: size_t, the number of threads to use. If 0, it becomes the number of hardware threads
+   RETURN: void
+*/
+
+// Include guard
+#ifndef RNGWALKS_H
+#define RNGWALKS_H
+
+// If necessary, include the header to allow vectors
+#ifndef _VECTOR_
+#include <vector>
+#endif
+// If necessary, include the header to allow threads
+#ifndef _THREAD_
+#include <thread>
+#endif
+// If necessary, include the header to allow binary searches
+#ifndef _ALGORITHM_
+#include <algorithm>
+#endif
+// Include the header declaring SeededRNGClass, which provides the per-walk streams
+#include "SeededRNGClass.h"
+
+// typename node_type; // The type of node indices. Must be unsigned
+template <typename node_type>
+class RandomWalkEngine {
+public:
+	// Ensure that the provided type is numerical and unsigned
+	static_assert(std::is_unsigned_v<node_type>, "The type provided for RandomWalkEngine must be unsigned");
+
+	// Define the value filling the rest of a walk that reached a node without neighbours
+	static constexpr node_type END = (std::numeric_limits<node_type>::max)();
+
+	// Define the constructor to store the graph and build the alias tables of a weighted graph
+	RandomWalkEngine(size_t nodes, const unsigned long long* offsets, const node_type* targets, const float* weights = nullptr, double return_parameter = 1, double in_out_parameter = 1)
+		: nodes(nodes), offsets(offsets), targets(targets) {
+		// Ensure that the parameters are valid
+		assert(("The node2vec parameters must be positive", return_parameter > 0 && in_out_parameter > 0));
+
+		// Scale the node2vec biases so that the largest is 1, which makes them acceptance probabilities
+		this->second_order = return_parameter != 1 || in_out_parameter != 1;
+		double largest = (std::max)({ 1 / return_parameter, 1.0, 1 / in_out_parameter }); // The largest bias
+		this->return_acceptance = RandomWalkEngine::Threshold(1 / return_parameter / largest);
+		this->neighbour_acceptance = RandomWalkEngine::Threshold(1 / largest);
+		this->other_acceptance = RandomWalkEngine::Threshold(1 / in_out_parameter / largest);
+
+		if (weights) { this->BuildAliasTables(weights); }
+	}
+
+	// **** Define const methods ****
+
+	// Define a method to generate a batch of walks, each driven by its own substream
+	void Generate(const SeededRNGClass<unsigned long long>& rng, const node_type* starts, size_t walk_count, size_t length, node_type* walks, unsigned long long first_walk = 0) const {
+		// const SeededRNGClass<unsigned long long>& rng;	// The generator whose substreams drive the walks. Passed by reference
+		// const node_type* starts;							// The start node of every walk. Passed
+		// size_t walk_count;								// The number of walks. Passed
+		// size_t length;									// The number of nodes of every walk. Passed
+		// node_type* walks;								// The buffer to fill. Passed
+		// unsigned long long first_walk;					// The index of the first walk. Passed. 0 if omitted
+
+		for (size_t w = 0; w < walk_count; w++) {
+			SeededRNGClass<unsigned long long> stream = rng.Substream(first_walk + w); // The stream of the current walk
+			this->Walk(stream, starts[w], length, walks + w * length);
+		} // End for(w)
+	}
+	// End RandomWalkEngine<node_type>::Generate method
+
+	// Define a method to generate a batch of walks, split into equal ranges between multiple threads
+	void GenerateParallel(const SeededRNGClass<unsigned long long>& rng, const node_type* starts, size_t walk_count, size_t length, node_type* walks, size_t threads = 0, unsigned long long first_walk = 0) const {
+		// size_t threads;							// The number of threads to use. Passed. Hardware threads if 0 or omitted
+		std::vector<std::thread> workers;			// The threads generating the ranges
+
+		if (threads == 0) { threads = (std::max)(1u, std::thread::hardware_concurrency()); }
+		for (size_t t = 0; t < threads; t++) {
+			size_t begin = (size_t)RNGPartStart(walk_count, t, threads);		// The first walk of the range
+			size_t end = (size_t)RNGPartStart(walk_count, t + 1, threads);	// The first walk after the range
+			workers.emplace_back([=, &rng]() { this->Generate(rng, starts + begin, end - begin, length, walks + begin * length, first_walk + begin); });
+		} // End for(t)
+
+		for (std::thread& worker : workers) { worker.join(); }
+	}
+	// End RandomWalkEngine<node_type>::GenerateParallel method
+
+protected:
+	// Define a method to generate a single walk
+	void Walk(SeededRNGClass<unsigned long long>& stream, node_type start, size_t length, node_type* walk) const {
+		// SeededRNGClass<unsigned long long>& stream;	// The stream driving the walk. Passed by reference
+		// node_type start;								// The start node. Passed
+		// size_t length;								// The number of nodes of the walk. Passed
+		// node_type* walk;								// The buffer to fill. Passed
+		size_t step = 1;								// The index of the next node of the walk
+
+		if (length == 0) { return; }
+		walk[0] = start;
+
+		for (; step < length; step++) {
+			node_type current = walk[step - 1]; // The node the walk is at
+			if (this->offsets[current] == this->offsets[current + 1]) { break; }
+
+			// The first step (and every step of a first-order walk) is a plain draw from the neighbours
+			if (!this->second_order || step == 1) {
+				walk[step] = this->targets[this->offsets[current] + this->Neighbour(stream(), current)];
+				continue;
+			} // End if(!this->second_order || step == 1)
+
+			// Otherwise, propose neighbours until one is accepted according to its relation to the previous node
+			while (true) {
+				node_type candidate = this->targets[this->offsets[current] + this->Neighbour(stream(), current)]; // The proposed node
+				unsigned int coin = (unsigned int)(stream() >> 32);	// The 32-bit number deciding acceptance
+				if (coin < this->Acceptance(walk[step - 2], candidate)) {
+					walk[step] = candidate;
+					break;
+				} // End if(coin < this->Acceptance(walk[step - 2], candidate))
+			} // End while(true)
+		} // End for(; step < length; step++)
+
+		// Fill the rest of a walk stopped at a node without neighbours
+		for (; step < length; step++) { walk[step] = END; }
+	}
+	// End RandomWalkEngine<node_type>::Walk method
+
+	// Define a method to choose a neighbour of a node (by its position in the neighbour list) from 64 random bits. NOTE: The upper
+	//		32 bits choose the slot, and the lower 32 bits toss the alias coin
+	size_t Neighbour(unsigned long long bits, node_type node) const {
+		// unsigned long long bits;	// The random bits to use. Passed
+		// node_type node;			// The node whose neighbour is chosen. Passed
+		unsigned long long first = this->offsets[node];								// The position of the node's first neighbour
+		unsigned long long degree = this->offsets[node + 1] - first;				// The number of neighbours
+		size_t slot = (size_t)(((bits >> 32) * degree) >> 32);						// The slot of the alias table
+
+		if (this->alias_thresholds.empty()) { return slot; }
+		return ((unsigned int)bits < this->alias_thresholds[first + slot]) ? slot : this->alias_targets[first + slot];
+	}
+	// End RandomWalkEngine<node_type>::Neighbour method
+
+	// Define a method to return the 32-bit acceptance threshold of a node2vec candidate
+	unsigned long long Acceptance(node_type previous, node_type candidate) const {
+		// node_type previous;	// The node the walk was at before the current one. Passed
+		// node_type candidate;	// The proposed next node. Passed
+
+		if (candidate == previous) { return this->return_acceptance; }
+		if (std::binary_search(this->targets + this->offsets[previous], this->targets + this->offsets[previous + 1], candidate)) { return this->neighbour_acceptance; }
+		return this->other_acceptance;
+	}
+	// End RandomWalkEngine<node_type>::Acceptance method
+
+	// Define a method to build the alias table of every node with Vose's method
+	void BuildAliasTables(const float* weights) {
+		// const float* weights; // The weight of every edge. Passed
+		std::vector<double> scaled;			// The weights of the current node, scaled so that their mean is 1
+		std::vector<size_t> small;			// The slots of the current node with less than their share
+		std::vector<size_t> large;			// The slots of the current node with more than their share
+
+		this->alias_thresholds.assign(this->offsets[this->nodes], 0);
+		this->alias_targets.assign(this->offsets[this->nodes], 0);
+		for (size_t node = 0; node < this->nodes; node++) {
+			unsigned long long first = this->offsets[node];				// The position of the node's first neighbour
+			size_t degree = (size_t)(this->offsets[node + 1] - first);	// The number of neighbours
+			double total = 0;											// The total weight of the node's edges
+
+			for (size_t i = 0; i < degree; i++) { total += weights[first + i]; }
+			if (degree == 0) { continue; }
+			assert(("Every node with neighbours must have a positive total weight", total > 0));
+
+			// Sort the slots by whether they hold less or more than their share, then pair every small slot with a large one
+			scaled.resize(degree);
+			small.clear();
+			large.clear();
+			for (size_t i = 0; i < degree; i++) {
+				scaled[i] = weights[first + i] * degree / total;
+				(scaled[i] < 1 ? small : large).push_back(i);
+			} // End for(i)
+			while (!small.empty() && !large.empty()) {
+				size_t lower = small.back(), upper = large.back(); // The slots being paired
+				small.pop_back();
+				this->alias_thresholds[first + lower] = (unsigned int)RandomWalkEngine::Threshold(scaled[lower]);
+				this->alias_targets[first + lower] = (unsigned int)upper;
+				scaled[upper] -= 1 - scaled[lower];
+				if (scaled[upper] < 1) {
+					large.pop_back();
+					small.push_back(upper);
+				} // End if(scaled[upper] < 1)
+			} // End while(!small.empty() && !large.empty())
+
+			// The slots left over hold exactly their share (up to rounding), so they always keep their own neighbour
+			for (size_t i : small) { this->alias_thresholds[first + i] = 0xFFFFFFFFu; this->alias_targets[first + i] = (unsigned int)i; }
+			for (size_t i : large) { this->alias_thresholds[first + i] = 0xFFFFFFFFu; this->alias_targets[first + i] = (unsigned int)i; }
+		} // End for(node)
+	}
+	// End RandomWalkEngine<node_type>::BuildAliasTables method
+
+	// Define a method to convert a probability to the 32-bit number below which it is reached
+	static unsigned long long Threshold(double probability) { return (probability >= 1) ? (1ULL << 32) : (unsigned long long)(probability * 4294967296.0); }
+
+	size_t nodes;									// The number of nodes
+	const unsigned long long* offsets;				// The offsets of the neighbour lists
+	const node_type* targets;						// The neighbour lists
+	std::vector<unsigned int> alias_thresholds;		// The 32-bit probability of every alias slot keeping its own neighbour
+	std::vector<unsigned int> alias_targets;		// The slot every alias slot defers to otherwise
+	bool second_order;								// Boolean for whether or not the walks are second-order
+	unsigned long long return_acceptance;			// The acceptance threshold of returning to the previous node
+	unsigned long long neighbour_acceptance;		// The acceptance threshold of moving to a neighbour of the previous node
+	unsigned long long other_acceptance;			// The acceptance threshold of moving further away
+}; // End class RandomWalkEngine
+#endif
@@ -0,0 +1,247 @@
+﻿// SeedDeriver.h - This header declares the SeedDeriver and RNGSeedSequence classes, and implements them
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- A SeedDeriver expands a 256-bit master key and a label path (e.g. "job/42/worker/7") into any amount of seed material, so every
+	engine of a computation gets its own independent seed from a single key, without any bookkeeping. The same key and path always
+	give the same seeds, on every platform: all arithmetic is on 32-bit words and labels are read byte by byte.
+
+- The derivation uses the ChaCha20 block function (RFC 8439) as a pseudorandom function. Every component of the path is absorbed
+	12 bytes at a time, each block replacing the key with the first half of ChaCha20(key, chunk); the last block of a component
+	is marked with its length, so different paths never share a key. Seed material is then ChaCha20 in counter mode under the key
+	of the whole path. Knowing derived seeds reveals nothing about the master key or other paths.
+
+- A short path costs one ChaCha20 block per component plus one per 64 bytes of output (well under a microsecond), and Child
+	derives the key of a common prefix once, so millions of engines per second can be seeded. RNGSeedSequence offers the same
+	material through the interface of std::seed_seq, as a faster and better mixed replacement for std engines.
+
+- The default constructor draws the master key from RNGClass (record it with GetKey to reproduce a run).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "deriver" as the identifier for the SeedDeriver instance. Paths are components separated by '/'
+
+To create a seed deriver from a master key
+  declare SeedDeriver identifier(key)
+	key: const unsigned long long*, the 4 words of the master key. If omitted, a random key is taken from RNGClass
+
+To create the deriver of a path (so that paths below it are cheaper to derive)
+ Call deriver.Child(path)
+	 path: const std::string&, the path relative to the deriver
+   RETURN: SeedDeriver
+
+To fill a buffer with seed material for a path
+ Call deriver.Derive(path, words, count)
+	 path: const std::string&, the path of the seed
+	 words: unsigned long long*, the buffer to fill
+	 count: size_t, the number of 64-bit words to write
+   RETURN: void
+
+To derive a single 64-bit seed for a path
+ Call deriver.Seed(path)
+	 path: const std::string&, the path of the seed
+   RETURN: unsigned long long
+
+To derive a seeded generator for a path
+ Call deriver.Stream(path)
+	 path: const std::string&, the path of the generator
+   RETURN: SeededRNGClass<unsigned long long>, seeded with the first word of the material and using the second as its stream
+
+To derive a replacement for std::seed_seq for a path (e.g. std::mt19937 engine(sequence) or engine.seed(sequence))
+ Call deriver.Sequence(path)
+	 path: const std::string&, the path of the sequence
+   RETURN: RNGSeedSequence
+
+To get the master key (or the key of the path of a child)
+ Call deriver.GetKey(key)
+	 key: unsigned long long*, the buffer to fill with the 4 words of the key
+   RETURN: void
+*/
+
+// Include guard
+#ifndef SEEDDERIVER_H
+#define SEEDDERIVER_H
+
+// Include the header declaring SeededRNGClass (and RNGClass, which provides random master keys)
+#include "SeededRNGClass.h"
+
+// Define the counter field markers separating the blocks of labels and the blocks of seed material. NOTE: Inner chunks of a
+//		component use their index as counter, final chunks use the marker plus the length of the component
+inline constexpr unsigned int RNGSeedFinalChunk = 0x80000000u;
+inline constexpr unsigned int RNGSeedOutputBlock = 0xC0000000u;
+
+// Define a function to compute the ChaCha20 block function (RFC 8439, section 2.3) of a key, counter and nonce
+inline void RNGChaCha20Block(const unsigned int* key, unsigned int counter, const unsigned int* nonce, unsigned int* output) {
+	// const unsigned int* key;		// The 8 words of the key. Passed
+	// unsigned int counter;		// The block counter. Passed
+	// const unsigned int* nonce;	// The 3 words of the nonce. Passed
+	// unsigned int* output;		// The buffer to fill with the 16 words of the block. Passed
+	unsigned int input[16] = { 0x61707865u, 0x3320646Eu, 0x79622D32u, 0x6B206574u, key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7], counter, nonce[0], nonce[1], nonce[2] }; // The initial state
+	unsigned int* x = output;	// The working state (built in the output buffer)
+
+	for (int i = 0; i < 16; i++) { x[i] = input[i]; }
+
+	// Define the quarter round as a lambda, rotating with shifts so that compilers emit rotate instructions
+	auto quarter = [x](int a, int b, int c, int d) {
+		x[a] += x[b]; x[d] ^= x[a]; x[d] = (x[d] << 16) | (x[d] >> 16);
+		x[c] += x[d]; x[b] ^= x[c]; x[b] = (x[b] << 12) | (x[b] >> 20);
+		x[a] += x[b]; x[d] ^= x[a]; x[d] = (x[d] << 8) | (x[d] >> 24);
+		x[c] += x[d]; x[b] ^= x[c]; x[b] = (x[b] << 7) | (x[b] >> 25);
+	};
+
+	// Ten double rounds: columns, then diagonals
+	for (int round = 0; round < 10; round++) {
+		quarter(0, 4, 8, 12); quarter(1, 5, 9, 13); quarter(2, 6, 10, 14); quarter(3, 7, 11, 15);
+		quarter(0, 5, 10, 15); quarter(1, 6, 11, 12); quarter(2, 7, 8, 13); quarter(3, 4, 9, 14);
+	} // End for(round)
+
+	for (int i = 0; i < 16; i++) { x[i] += input[i]; }
+}
+// End RNGChaCha20Block function
+
+class RNGSeedSequence {
+public:
+	// Create result_type as required of seed sequences (§29.6.1.2 of the C++17 standard draft)
+	typedef unsigned int result_type;
+
+	// Define the constructor to generate the material of the provided key
+	explicit RNGSeedSequence(const unsigned int* key) { for (int i = 0; i < 8; i++) { this->key[i] = key[i]; } }
+
+	// **** Define const methods ****
+
+	// Define a templated method to fill a range with 32-bit seed material, as std::seed_seq::generate does
+	template<typename iterator_type> void generate(iterator_type begin, iterator_type end) const {
+		// iterator_type begin;	// The start of the range to fill. Passed
+		// iterator_type end;	// The end of the range to fill. Passed
+		const unsigned int nonce[3] = { 0, 0, 0 };	// The nonce of seed material
+		unsigned int block[16];						// The current block of material
+		unsigned int counter = 0;					// The index of the current block
+
+		while (begin != end) {
+			RNGChaCha20Block(this->key, RNGSeedOutputBlock | counter++, nonce, block);
+			for (int i = 0; i < 16 && begin != end; i++, ++begin) { *begin = block[i]; }
+		} // End while(begin != end)
+	}
+	// End RNGSeedSequence::generate<iterator_type> method
+
+	// Define the remaining methods of seed sequences. NOTE: The sequence has no stored values, so it has no parameters
+	size_t size() const { return 0; }
+	template<typename iterator_type> void param(iterator_type) const {}
+
+protected:
+	unsigned int key[8]; // The key of the path the sequence was derived for
+}; // End class RNGSeedSequence
+
+class SeedDeriver {
+public:
+	// Define the default constructor to draw a random master key from the OS generator
+	SeedDeriver() {
+		static RNGClass<unsigned int> seeder; // Random number generator used to draw master keys across lifetime of the program
+		seeder.Fill(this->key, 8);
+	}
+
+	// Define the constructor to use the provided master key
+	explicit SeedDeriver(const unsigned long long* key) {
+		// const unsigned long long* key; // The 4 words of the master key. Passed
+		for (int i = 0; i < 4; i++) {
+			this->key[2 * i] = (unsigned int)key[i];
+			this->key[2 * i + 1] = (unsigned int)(key[i] >> 32);
+		} // End for(i)
+	}
+
+	// **** Define const methods ****
+
+	// Define a method to return the deriver of a path, whose own paths are relative to it
+	SeedDeriver Child(const std::string& path) const {
+		SeedDeriver child(*this); // The deriver to return
+		SeedDeriver::Absorb(path, child.key);
+		return child;
+	}
+	// End SeedDeriver::Child method
+
+	// Define a method to fill a buffer with seed material for a path
+	void Derive(const std::string& path, unsigned long long* words, size_t count) const {
+		// const std::string& path;		// The path of the seed. Passed
+		// unsigned long long* words;	// The buffer to fill. Passed
+		// size_t count;				// The number of words to write. Passed
+		const unsigned int nonce[3] = { 0, 0, 0 };	// The nonce of seed material
+		unsigned int path_key[8];					// The key of the path
+		unsigned int block[16];						// The current block of material
+		unsigned int counter = 0;					// The index of the current block
+
+		for (int i = 0; i < 8; i++) { path_key[i] = this->key[i]; }
+		SeedDeriver::Absorb(path, path_key);
+
+		// Combine the 32-bit words of the blocks into 64-bit words, least significant first
+		while (count > 0) {
+			RNGChaCha20Block(path_key, RNGSeedOutputBlock | counter++, nonce, block);
+			for (int i = 0; i < 8 && count > 0; i++, count--) { *words++ = (unsigned long long)block[2 * i] | ((unsigned long long)block[2 * i + 1] << 32); }
+		} // End while(count > 0)
+	}
+	// End SeedDeriver::Derive method
+
+	// Define a method to derive a single 64-bit seed for a path
+	unsigned long long Seed(const std::string& path) const {
+		unsigned long long seed; // The seed to return
+		this->Derive(path, &seed, 1);
+		return seed;
+	}
+	// End SeedDeriver::Seed method
+
+	// Define a method to derive a seeded generator for a path
+	SeededRNGClass<unsigned long long> Stream(const std::string& path) const {
+		unsigned long long words[2]; // The seed and stream of the generator
+		this->Derive(path, words, 2);
+		return SeededRNGClass<unsigned long long>(words[0], words[1]);
+	}
+	// End SeedDeriver::Stream method
+
+	// Define a method to derive a replacement for std::seed_seq for a path
+	RNGSeedSequence Sequence(const std::string& path) const {
+		unsigned int path_key[8]; // The key of the path
+		for (int i = 0; i < 8; i++) { path_key[i] = this->key[i]; }
+		SeedDeriver::Absorb(path, path_key);
+		return RNGSeedSequence(path_key);
+	}
+	// End SeedDeriver::Sequence method
+
+	// Define a method to return the key of the deriver (the master key, or the key of the path of a child)
+	void GetKey(unsigned long long* key) const {
+		for (int i = 0; i < 4; i++) { key[i] = (unsigned long long)this->key[2 * i] | ((unsigned long long)this->key[2 * i + 1] << 32); }
+	}
+	// End SeedDeriver::GetKey method
+
+protected:
+	// Define a static method to absorb every component of a path into a key
+	static void Absorb(const std::string& path, unsigned int* key) {
+		// const std::string& path;		// The path to absorb. Passed
+		// unsigned int* key;			// The key to update. Passed
+		unsigned int block[16];			// The output of the current ChaCha20 block
+		size_t start = 0;				// The position of the current component in the path
+
+		// An empty path is the deriver itself
+		if (path.empty()) { return; }
+
+		while (true) {
+			size_t end = path.find('/', start); // The end of the current component
+			if (end == std::string::npos) { end = path.size(); }
+			size_t length = end - start;		// The length of the current component
+
+			assert(("A path component must be shorter than 2^30 bytes", length < (1u << 30)));
+
+			// Absorb the component 12 bytes at a time (the last chunk zero-padded, and marked with the length)
+			for (size_t chunk = 0; chunk == 0 || chunk * 12 < length; chunk++) {
+				unsigned int nonce[3] = { 0, 0, 0 }; // The current chunk, as little-endian words
+				for (size_t b = chunk * 12; b < length && b < chunk * 12 + 12; b++) { nonce[(b % 12) / 4] |= (unsigned int)(unsigned char)path[start + b] << (8 * (b % 4)); }
+				RNGChaCha20Block(key, ((chunk + 1) * 12 >= length) ? (RNGSeedFinalChunk | (unsigned int)length) : (unsigned int)chunk, nonce, block);
+				for (int i = 0; i < 8; i++) { key[i] = block[i]; }
+			} // End for(chunk)
+
+			if (end == path.size()) { break; }
+			start = end + 1;
+		} // End while(true)
+	}
+	// End SeedDeriver::Absorb method
+
+	unsigned int key[8]; // The key of the deriver
+}; // End class SeedDeriver
+#endif
@@ -0,0 +1,239 @@
+﻿// SeededRNGClass.h - This header declares the SeededRNGClass class, and (due to it being a class template) implements it
+
+/* -*-*-*-*-*-*-*-*-*-*-*-*-*- NOTES -*-*-*-*-*-*-*-*-*-*-*-*-*-
+- SeededRNGClass is a deterministic counterpart to RNGClass: the same seed and stream always produce the same numbers, which is
+	what simulations need to be reproducible or to share random numbers between runs. It is NOT suitable for cryptographic use.
+
+- The generator is counter-based: number i of a stream is a keyed scramble of i, where the key is derived from the seed and the
+	stream. Because of this, any number of independent substreams can be split off a generator without any coordination, and
+	skipping ahead (Discard) costs nothing.
+
+- Unlike RNGClass, an instance of SeededRNGClass is NOT thread-safe. Give every thread its own instance (e.g. a substream).
+
+- All range and floating-point generation is done without std distributions, so the output is identical across compilers and
+	standard libraries. FloatingRand generates numbers in the half-open set [floor, roof).
+
+- Everything but the default constructor and NormalRand is constexpr, so seeded numbers can be generated at compile time (see
+	RNGConstexpr.h).
+*/
+
+/* -*-*-*-*-*-*-*-*-*-*-*- DOCUMENTATION -*-*-*-*-*-*-*-*-*-*-*-
+NOTE: Examples use "rng" as the identifier for the SeededRNGClass instance, and result_type as the type specified at identifier
+	declaration. Everything available on an RNGClass instance (rng(), rng(floor, roof), GetRand, CustomRand, FloatingRand, Fill)
+	is available with the same parameters
+
+To create a seeded instance of the random number generation class
+  declare SeededRNGClass<result_type> identifier(seed, stream)
+	result_type: An *UNSIGNED* integral type to generate numbers in (e.g. "unsigned int", "unsigned long long")
+	seed: unsigned long long, the seed of the generator. If omitted (along with stream), a seed is taken from RNGClass
+	stream: unsigned long long, the index of the stream of the seed to generate. If omitted, it becomes 0
+
+To reseed the instance, restarting it at the first number of the stream
+ Call rng.Seed(seed, stream)
+	 seed: unsigned long long, the seed of the generator
+	 stream: unsigned long long, the index of the stream of the seed to generate. If omitted, it becomes 0
+   RETURN: void
+
+To split off an independent substream of the instance
+ Call rng.Substream(index)
+	 index: unsigned long long, the index of the substream. The same index always gives the same substream
+   RETURN: SeededRNGClass<result_type>, starting at the first number of the substream
+
+To skip numbers without generating them
+ Call rng.Discard(count)
+	 count: unsigned long long, the number of numbers to skip
+   RETURN: void
+
+To generate a normally distributed floating-point number
+ Call rng.NormalRand<floating_type>(mean, deviation)
+	 floating_type: the type of the result (e.g. float, double)
+	 mean: floating_type, the mean of the distribution. If omitted, it becomes 0
+	 deviation: floating_type, the standard deviation of the distribution. If omitted, it becomes 1
+   RETURN: floating_type
+*/
+
+// Include guard
+#ifndef SEEDEDRNGCLASS_H
+#define SEEDEDRNGCLASS_H
+
+// Include the header declaring RNGClass, used to seed instances when no seed is provided
+#include "RNGClass.h"
+// Include the header defining the shared bit conversion primitives
+#include "RNGBulk.h"
+
+// typename T; // The type of number to generate. Must be unsigned
+template <typename T>
+class SeededRNGClass { // NOTE: Like RNGClass, this class is compliant with §29.6.1.3 of the C++17 standard draft so that it can
+					   //		be used with the std distributions and std::shuffle
+public:
+	// Ensure that the provided type is numerical and unsigned
+	static_assert(std::is_unsigned_v<T>, "The type provided for SeededRNGClass must be unsigned");
+	static_assert(std::numeric_limits<T>::digits <= 64, "The type provided for SeededRNGClass must be at most 64 bits wide");
+
+	// Create result_type as an alias for T (the provided type)
+	typedef T result_type;
+
+	// Define the default constructor to seed the instance from the OS generator
+	SeededRNGClass() {
+		static RNGClass<unsigned long long> seeder; // Random number generator used to seed instances across lifetime of the program
+		this->Seed(seeder());
+	}
+
+	// Define the constructor to seed the instance with the provided seed and stream
+	constexpr explicit SeededRNGClass(unsigned long long seed, unsigned long long stream = 0) : seed(0), stream(0), key_low(0), key_high(0), position(0) { this->Seed(seed, stream); }
+
+	// **** Define non-const methods ****
+
+	// Define the () operator to return a random number of the provided type in the set
+	//		{ number ∈ result_type | min() ≤ number ≤ max() }, as required by §29.6.1.3 of the C++17 standard draft
+	constexpr result_type operator()() { return (result_type)(this->Generate(this->position++) >> (64 - std::numeric_limits<T>::digits)); }
+	// End SeededRNGClass<T>::operator() [overload: void] method
+
+	// Define an overload of the () operator to return a random number of in the set
+	//		{ number ∈ result_type | floor ≤ number ≤ roof }
+	constexpr result_type operator()(result_type floor, result_type roof) { return this->CustomRand<result_type>(floor, roof); }
+	// End SeededRNGClass<T>::operator() [overload: result_type, result_type] method
+
+	// Define a method to fill a buffer with random numbers of the provided type
+	constexpr void Fill(result_type* numbers, size_t count) {
+		// result_type* numbers;	// The buffer to fill. Passed
+		// size_t count;			// The number of numbers to write to the buffer. Passed
+
+		// Every number only depends on its position, so the loop has no dependency between iterations and can be vectorized
+		for (size_t i = 0; i < count; i++) {
+			numbers[i] = (result_type)(this->Generate(this->position + i) >> (64 - std::numeric_limits<T>::digits));
+		} // End for(i)
+		this->position += count;
+	}
+	// End SeededRNGClass<T>::Fill method
+
+	// Define a method to reseed the instance, restarting it at the first number of the provided stream
+	constexpr void Seed(unsigned long long seed, unsigned long long stream = 0) {
+		// unsigned long long seed;		// The seed of the generator. Passed
+		// unsigned long long stream;	// The index of the stream of the seed to generate. Passed. 0 if omitted
+
+		this->seed = seed;
+		this->stream = stream;
+		this->position = 0;
+
+		// Derive the two halves of the key from the seed and stream. NOTE: The stream is scrambled before being combined so that
+		//		consecutive streams of consecutive seeds do not collide
+		this->key_low = RNGMix64(seed ^ RNGMix64(stream + 0x9E3779B97F4A7C15ULL));
+		this->key_high = RNGMix64(this->key_low + 0xD1B54A32D192ED03ULL);
+	}
+	// End SeededRNGClass<T>::Seed method
+
+	// Define a method to skip numbers without generating them
+	constexpr void Discard(unsigned long long count) { this->position += count; }
+
+	// Define a method to return a random number (since pointers can't access the "()" operator in an easily readable way)
+	constexpr result_type GetRand() { return this->operator()(); }
+
+	// Define an overload of GetRand to return a random number of the specified type in the specified range
+	constexpr result_type GetRand(result_type floor, result_type roof) { return this->operator()(floor, roof); }
+
+	// Define a templated method to generate a random number of the specified type over the specified range
+	//		{ number ∈ cast_type | floor ≤ number ≤ roof }
+	template<typename cast_type> constexpr cast_type CustomRand(cast_type floor = RNGLowest<cast_type>(), cast_type roof = RNGHighest<cast_type>()) {
+		// cast_type floor; // The minimum number that can be returned. Passed. Minimum of the type if omitted
+		// cast_type roof;	// The maximum number that can be returned. Passed. Maximum of the type if omitted
+		typedef RNGUnsignedOfT<cast_type> unsigned_type;       // The unsigned type used to calculate the range without overflow
+		WideView wide{ *this };								   // A 64-bit view of this instance, sharing its position
+
+		// Ensure that the provided type is numerical, but not necessarily and unsigned
+		static_assert(RNGIsIntegral<cast_type>, "The type provided for SeededRNGClass::CustomRand must be integral");
+
+		// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
+		assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
+
+#ifdef RNG_HAS_INT128
+		// A 128-bit range takes two positions per attempt
+		if constexpr (RNGIsWide<cast_type>) { return (cast_type)((unsigned_type)floor + RNGBoundedRand128(wide, (unsigned_type)roof - (unsigned_type)floor + 1)); }
+#endif
+		// Generate an offset from the floor. NOTE: If the range covers the whole 64-bit type, its size overflows to 0, which
+		//		RNGBoundedRand treats as the full range
+		unsigned long long offset = RNGBoundedRand(wide, (unsigned long long)(unsigned_type)((unsigned_type)roof - (unsigned_type)floor) + 1);
+		return (cast_type)((unsigned_type)floor + (unsigned_type)offset);
+	}
+	// End SeededRNGClass<T>::CustomRand<cast_type> method
+
+	// Define a templated method to generate a random floating-point number of the specified type over the specified range
+	template<typename floating_type> constexpr floating_type FloatingRand(floating_type floor = 0, floating_type roof = 1) {
+		// floating_type floor;		// The minimum number that can be returned. Passed. 0 if omitted
+		// floating_type roof;		// The upper bound of the numbers (excluded). Passed. 1 if omitted
+
+		// Ensure that the provided type is floating-point
+		static_assert(std::is_floating_point_v<floating_type>, "The type provided for SeededRNGClass::FloatingRand must be floating-point");
+
+		// Ensure that the floor is lower than the roof, embedding an error message for if the assertion fails using the comma operator
+		assert(("Lower bound is greater than upper bound. Check for implicit casting?", floor < roof));
+
+		return floor + (roof - floor) * RNGBitsToUnit<floating_type>(this->Generate(this->position++));
+	}
+	// End SeededRNGClass<T>::FloatingRand<floating_type> method
+
+	// Define a templated method to generate a normally distributed floating-point number using the Box-Muller transform
+	template<typename floating_type> floating_type NormalRand(floating_type mean = 0, floating_type deviation = 1) {
+		// floating_type mean;		// The mean of the distribution. Passed. 0 if omitted
+		// floating_type deviation;	// The standard deviation of the distribution. Passed. 1 if omitted
+		floating_type radius;		// The radius of the Box-Muller pair
+		floating_type angle;		// The angle of the Box-Muller pair
+
+		// Ensure that the provided type is floating-point
+		static_assert(std::is_floating_point_v<floating_type>, "The type provided for SeededRNGClass::NormalRand must be floating-point");
+
+		// NOTE: Only the cosine half of the pair is used, so that every call consumes exactly two numbers of the stream
+		radius = std::sqrt(-2 * std::log(RNGBitsToOpenUnit<floating_type>(this->Generate(this->position))));
+		angle = (floating_type)RNGTwoPi * RNGBitsToUnit<floating_type>(this->Generate(this->position + 1));
+		this->position += 2;
+		return mean + deviation * radius * std::cos(angle);
+	}
+	// End SeededRNGClass<T>::NormalRand<floating_type> method
+
+	// **** Define const methods ****
+
+	// Define a method to split off an independent substream, which starts at its own first number
+	constexpr SeededRNGClass Substream(unsigned long long index) const {
+		// unsigned long long index; // The index of the substream. Passed
+
+		// NOTE: The substream's seed is derived from this stream's key, so substreams of substreams are also independent
+		return SeededRNGClass(this->key_high ^ RNGMix64(this->key_low + index), index);
+	}
+	// End SeededRNGClass<T>::Substream method
+
+	// Define methods to return the seed, the stream, and the number of numbers generated since seeding
+	constexpr unsigned long long GetSeed() const { return this->seed; }
+	constexpr unsigned long long GetStream() const { return this->stream; }
+	constexpr unsigned long long GetPosition() const { return this->position; }
+
+	// Define the method "max" to return the maximum number the provided type can contain. NOTE: Name is wrapped in "()" to
+	//		avoid the compiler trying to replace "max" with the macro defined in Windows.h
+	static constexpr T(max)() { return (std::numeric_limits<T>::max)(); }
+
+	// Define the method "min" to return the minimum number the provided type can contain (0 because the types must be unsigned)
+	static constexpr T(min)() { return 0; }
+
+protected:
+	// Define a method to generate the 64 random bits at the provided position of the stream
+	constexpr unsigned long long Generate(unsigned long long index) const {
+		// unsigned long long index; // The position of the number in the stream. Passed
+
+		// Two keyed scrambling rounds, so that neither shifted counters nor related keys give correlated streams
+		return RNGMix64(RNGMix64(index * 0x9E3779B97F4A7C15ULL + this->key_low) ^ this->key_high);
+	}
+	// End SeededRNGClass<T>::Generate method
+
+	// Define a view of the instance that generates full 64-bit numbers from its stream, for use with the 64-bit primitives
+	struct WideView {
+		typedef unsigned long long result_type;
+		SeededRNGClass& parent; // The instance whose stream is used
+		constexpr result_type operator()() { return parent.Generate(parent.position++); }
+	}; // End struct WideView
+
+	unsigned long long seed;		// The seed the instance was created with
+	unsigned long long stream;		// The index of the stream the instance generates
+	unsigned long long key_low;		// The first half of the key derived from the seed and stream
+	unsigned long long key_high;	// The second half of the key derived from the seed and stream
+	unsigned long long position;	// The position of the next number in the stream
+}; // End class SeededRNGClass
+#endif
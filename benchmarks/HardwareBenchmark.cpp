@@ -0,0 +1,49 @@
+// HardwareBenchmark.cpp - This program compares HardwareRNGClass with RNGClass (one OS call per draw), for single draws, bounded
+//		draws and bulk fills, printing the nanoseconds per number of each. Build it with optimizations, e.g.
+//		cl /std:c++17 /O2 /EHsc benchmarks\HardwareBenchmark.cpp
+
+// Include the headers declaring the two generators and the clock
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "../HardwareRNGClass.h"
+
+// Define a templated function to time a callable over a number of iterations, returning the nanoseconds per iteration
+template<typename callable_type> double TimePerCall(callable_type&& call, size_t iterations) {
+	// callable_type&& call;	// The work of one iteration. Passed
+	// size_t iterations;		// The number of iterations. Passed
+	auto start = std::chrono::steady_clock::now(); // The time before the first iteration
+
+	for (size_t i = 0; i < iterations; i++) { call(); }
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (double)iterations;
+}
+// End TimePerCall<callable_type> function
+
+int main() {
+	const size_t draws = 1000000;					// The number of single draws timed per generator
+	const size_t words = (size_t)1 << 20;			// The number of words per bulk fill
+	std::vector<unsigned long long> buffer(words);	// The buffer of the bulk fills
+	RNGClass<unsigned long long> os;				// The OS generator, one call per draw
+	HardwareRNGClass<unsigned long long> hardware;	// The hardware generator
+	volatile unsigned long long sink = 0;			// Keeps the draws from being optimized away
+
+	std::printf("RDRAND %s, RDSEED %s, kernel %s\n", hardware.IsHardware() ? "used" : "unavailable (OS fallback)", RNGHasRDSEED() ? "present" : "absent", RNGKernelReport().c_str());
+	std::printf("%-24s %14s %14s\n", "ns per number", "RNGClass", "HardwareRNG");
+
+	// Warm both generators up (first OS call, first refill of the buffer)
+	sink = sink + os() + hardware();
+
+	std::printf("%-24s %14.1f %14.1f\n", "operator()",
+		TimePerCall([&]() { sink = sink + os(); }, draws),
+		TimePerCall([&]() { sink = sink + hardware(); }, draws));
+	std::printf("%-24s %14.1f %14.1f\n", "CustomRand(1, 6)",
+		TimePerCall([&]() { sink = sink + os.CustomRand<int>(1, 6); }, draws),
+		TimePerCall([&]() { sink = sink + hardware.CustomRand<int>(1, 6); }, draws));
+	std::printf("%-24s %14.1f %14.1f\n", "Fill (1M words)",
+		TimePerCall([&]() { os.Fill(buffer.data(), words); }, 8) / (double)words,
+		TimePerCall([&]() { hardware.Fill(buffer.data(), words); }, 8) / (double)words);
+	std::printf("%-24s %14s %14.1f\n", "FillSeed (1M words)", "-",
+		TimePerCall([&]() { hardware.FillSeed(buffer.data(), words); }, 1) / (double)words);
+	std::printf("fallback blocks: %llu\n", hardware.GetFallbackCount());
+	return 0;
+}
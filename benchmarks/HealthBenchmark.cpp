@@ -0,0 +1,57 @@
+// HealthBenchmark.cpp - This program measures the cost of the continuous health tests of HealthMonitor.h on 4KB blocks against
+//		the OS fill of the same block (RNGClass::Fill, which includes the tests), in time stamp counter ticks. Every run tests a
+//		freshly filled block, as Fill does, so the few blocks needing the further repetition checks count at their natural rate,
+//		and the ticks of reading the counter around an empty region are taken off the tests.
+//		The variant is the one selected for the bulk kernels, so run it with RNG_KERNEL=sse4.2, avx2 or avx512 to compare them.
+//		Build it with optimizations, e.g. cl /std:c++17 /O2 /EHsc benchmarks\HealthBenchmark.cpp
+
+// Include the headers declaring the generator and the monitor
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "../RNGClass.h"
+
+// Define a function to return the median of a list of ticks
+unsigned long long MedianTicks(std::vector<unsigned long long> ticks) {
+	// std::vector<unsigned long long> ticks; // The ticks of every run. Passed
+	std::nth_element(ticks.begin(), ticks.begin() + ticks.size() / 2, ticks.end());
+	return ticks[ticks.size() / 2];
+}
+// End MedianTicks function
+
+int main() {
+	const size_t runs = 20000;							// The number of runs of every measurement
+	unsigned long long block[RNGBulkBlockSize];			// The 4KB block
+	std::vector<unsigned long long> tests(runs);		// The ticks of the tests of every run
+	std::vector<unsigned long long> fills(runs);		// The ticks of the fill of every run
+	std::vector<unsigned long long> empties(runs);		// The ticks of an empty region of every run
+	unsigned long long total = 0;						// The ticks of all the tests
+	RNGClass<unsigned long long> rng;					// The OS generator
+	HealthMonitor monitor;								// A separate monitor, so the tests can be timed on their own
+	volatile int sink = 0;								// Keeps the tests from being optimized away
+
+	for (size_t r = 0; r < runs; r++) {
+		unsigned long long start = RNGReadTimestamp(); // The timestamp before the fill
+		rng.Fill(block, RNGBulkBlockSize);
+		fills[r] = RNGReadTimestamp() - start;
+
+		start = RNGReadTimestamp();
+		sink = sink + 1;
+		empties[r] = RNGReadTimestamp() - start;
+
+		start = RNGReadTimestamp();
+		sink = sink + (int)monitor.Test(block, sizeof(block));
+		tests[r] = RNGReadTimestamp() - start;
+		total += tests[r];
+	} // End for(r)
+
+	unsigned long long fill = MedianTicks(fills);		// The median ticks of the fill
+	unsigned long long empty = MedianTicks(empties);	// The median ticks of an empty region
+	unsigned long long test = MedianTicks(tests);		// The median ticks of the tests
+	test = (test > empty) ? test - empty : 0;
+	std::printf("kernel: %s\n", RNGKernelReport().c_str());
+	std::printf("Fill (4KB): %llu ticks (median)\n", fill);
+	std::printf("Test (4KB): %llu ticks (median), %.0f ticks (mean), overhead: %.2f%%\n", test, (double)total / (double)runs - (double)empty,
+		100.0 * (double)test / (double)fill);
+	return 0;
+}
@@ -0,0 +1,56 @@
+// LatencyBenchmark.cpp - This program times GetRand, CustomRand and Fill of RNGClass, printing the nanoseconds per call, to show
+//		the cost of the latency instrumentation of RNGLatency.h. Build it three times with optimizations and compare the outputs:
+//			compiled out:		cl /std:c++17 /O2 /EHsc benchmarks\LatencyBenchmark.cpp
+//			sampling 1/64:		cl /std:c++17 /O2 /EHsc /DRNG_LATENCY benchmarks\LatencyBenchmark.cpp
+//			sampling every call:	cl /std:c++17 /O2 /EHsc /DRNG_LATENCY /DRNG_LATENCY_SAMPLING=1 benchmarks\LatencyBenchmark.cpp
+//		Every figure is the median of several rounds, and the histograms are dumped when the instrumentation is compiled in
+
+// Include the headers declaring the generator and the clock
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "../RNGClass.h"
+
+// Define a templated function to time a callable over a number of iterations, returning the median nanoseconds per iteration of
+//		several rounds
+template<typename callable_type> double TimePerCall(callable_type&& call, size_t iterations) {
+	// callable_type&& call;	// The work of one iteration. Passed
+	// size_t iterations;		// The number of iterations per round. Passed
+	const size_t rounds = 7;	// The number of rounds
+	double times[rounds];		// The nanoseconds per iteration of every round
+
+	for (size_t r = 0; r < rounds; r++) {
+		auto start = std::chrono::steady_clock::now(); // The time before the first iteration
+		for (size_t i = 0; i < iterations; i++) { call(); }
+		times[r] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (double)iterations;
+	} // End for(r)
+	std::nth_element(times, times + rounds / 2, times + rounds);
+	return times[rounds / 2];
+}
+// End TimePerCall<callable_type> function
+
+int main() {
+	const size_t draws = 200000;					// The number of single draws per round
+	const size_t words = RNGBulkBlockSize;			// The number of words per fill (one 4KB block)
+	std::vector<unsigned long long> buffer(words);	// The buffer of the fills
+	RNGClass<unsigned long long> rng;				// The OS generator
+	volatile unsigned long long sink = 0;			// Keeps the draws from being optimized away
+
+#ifdef RNG_LATENCY
+	std::printf("build: instrumented, sampling 1 in %d calls\n", RNG_LATENCY_SAMPLING);
+#else
+	std::printf("build: instrumentation compiled out\n");
+#endif
+
+	// Warm the generator up (first OS call)
+	sink = sink + rng();
+
+	std::printf("%-24s %10.1f ns\n", "GetRand", TimePerCall([&]() { sink = sink + rng.GetRand(); }, draws));
+	std::printf("%-24s %10.1f ns\n", "CustomRand(1, 6)", TimePerCall([&]() { sink = sink + rng.CustomRand<int>(1, 6); }, draws));
+	std::printf("%-24s %10.1f ns\n", "Fill (4KB)", TimePerCall([&]() { rng.Fill(buffer.data(), words); }, draws / 100));
+#ifdef RNG_LATENCY
+	std::printf("%s", RNGLatencyText(rng.GetLatency(), "rng").c_str());
+#endif
+	return 0;
+}
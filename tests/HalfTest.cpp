@@ -0,0 +1,55 @@
+// HalfTest.cpp - This program feeds every 24-bit lane through the uniform 16-bit fills of RNGHalf.h and checks that every number
+//		of [0, 1) gets exactly the mass of its interval, returning 0 if every check passes. It only needs the portable headers, e.g.
+//		g++ -std=c++17 -O2 tests/HalfTest.cpp
+
+// Include the headers declaring the fills
+#include <cstdio>
+#include <vector>
+#include "../RNGHalf.h"
+
+// Define a counter of the failed checks, and a macro reporting a failed check
+static int failures = 0;
+#define CHECK(condition) do { if (!(condition)) { std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while (0)
+
+// Define an engine returning every 24-bit lane once, in order, two lanes per word
+struct SequenceEngine {
+	typedef unsigned long long result_type;
+	unsigned long long next = 0; // The next lane
+	void Fill(unsigned long long* words, size_t count) {
+		for (size_t i = 0; i < count; i++, this->next += 2) { words[i] = (this->next << 8) | ((this->next + 1) << 40); }
+	}
+};
+
+// Define a templated function to check the fill of either 16-bit format over [0, 1)
+template<bool brain_float> void CheckFormat() {
+	const size_t lanes = (size_t)1 << 24;		// The number of distinct lanes
+	std::vector<unsigned short> numbers(lanes);	// The numbers produced from every lane
+	std::vector<size_t> hits(65536);				// The number of lanes producing every bit pattern
+	SequenceEngine engine;						// The generator of the lanes
+	size_t reached = 0;							// The number of positive numbers below 1 produced at least once
+
+	if constexpr (brain_float) { FillBFloat16Rand(engine, numbers.data(), lanes); }
+	else { FillFloat16Rand(engine, numbers.data(), lanes); }
+	for (unsigned short number : numbers) { hits[number]++; }
+
+	// Every number whose interval covers at least one lane gets exactly that many lanes, and nothing reaches 1 or negatives
+	for (unsigned int bits = 0; bits < 0x8000u; bits++) {
+		float value = RNGHalfToFloat<brain_float>((unsigned short)bits);				// The current number
+		float successor = RNGHalfToFloat<brain_float>((unsigned short)(bits + 1));	// The next higher number
+		if (!(value < 1.0f)) { CHECK(hits[bits] == 0); continue; }
+		reached += hits[bits] > 0;
+		if (successor - value >= 1.0f / 16777216.0f) { CHECK(hits[bits] == (size_t)((successor - value) * 16777216.0f)); }
+	} // End for(bits)
+	for (unsigned int bits = 0x8000u; bits < 0x10000u; bits++) { CHECK(hits[bits] == 0); }
+
+	// Half precision reaches all 15360 numbers of [0, 1), bfloat16 those of at least 2^-17 and the multiples of 2^-24 below
+	CHECK(reached == (brain_float ? 2304u : 15360u));
+}
+
+int main() {
+	CheckFormat<false>();
+	CheckFormat<true>();
+
+	std::printf("%s\n", (failures == 0) ? "HalfTest passed" : "HalfTest FAILED");
+	return failures != 0;
+}
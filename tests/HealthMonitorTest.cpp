@@ -0,0 +1,88 @@
+// HealthMonitorTest.cpp - This program checks every variant of the single-pass scan of HealthMonitor.h against a direct reading
+//		of the two tests, on random blocks and on blocks with planted runs and biased windows, returning 0 if every check passes
+
+// Include the headers declaring the monitor and the engine used to build the blocks
+#include <cstdio>
+#include <vector>
+#include "../HealthMonitor.h"
+#include "../MersenneTwisterClass.h"
+
+// Define a counter of the failed checks, and a macro reporting a failed check
+static int failures = 0;
+#define CHECK(condition) do { if (!(condition)) { std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while (0)
+
+// Define a function to scan a block directly, one position and one window at a time
+RNGHealthScan ReferenceScan(const unsigned char* block, size_t count, unsigned int cutoff) {
+	RNGHealthScan scan = { false, false }; // The results of the scan
+
+	for (size_t p = 0; p + 2 < count; p += 2) { scan.triple |= block[p] == block[p + 1] && block[p] == block[p + 2]; }
+	for (size_t window = 0; window + RNGHealthWindow <= count; window += RNGHealthWindow) {
+		unsigned int matches = 0; // The samples of the window equal to the first one
+		for (size_t i = window; i < window + RNGHealthWindow; i++) { matches += block[i] == block[window]; }
+		scan.proportion |= matches >= cutoff;
+	} // End for(window)
+	return scan;
+}
+
+// Define a function to check every variant the machine supports on a block
+void CheckBlock(const unsigned char* block, size_t count, unsigned int cutoff) {
+	RNGHealthScan expected = ReferenceScan(block, count, cutoff); // The results of the direct reading
+	bool quad = false; // Whether or not the block has 4 equal samples at an even position
+	RNGHealthScan scans[4] = { RNGScanLoop(block, count, cutoff) }; // The results of every variant
+	int variants = 1;	// The number of variants run
+
+	for (size_t p = 0; p + 3 < count; p += 2) { quad |= block[p] == block[p + 1] && block[p] == block[p + 2] && block[p] == block[p + 3]; }
+	CHECK(RNGQuadLoop(block, 0, count) == quad);
+#ifdef RNG_HAS_DISPATCH
+	scans[variants++] = RNGScanSSE2(block, count, cutoff);
+	CHECK(RNGQuadSSE2(block, count) == quad);
+	if (RNGDetectKernel() >= RNG_KERNEL_AVX2) { CHECK(RNGQuadAVX2(block, count) == quad); }
+	if (RNGDetectKernel() >= RNG_KERNEL_AVX2) { scans[variants++] = RNGScanAVX2(block, count, cutoff); }
+	if (RNGDetectKernel() >= RNG_KERNEL_AVX512) { scans[variants++] = RNGScanAVX512(block, count, cutoff); }
+#endif
+	for (int v = 0; v < variants; v++) {
+		CHECK(scans[v].triple == expected.triple);
+		CHECK(scans[v].proportion == expected.proportion);
+	} // End for(v)
+}
+
+int main() {
+	MersenneTwisterClass<unsigned long long> rng(73);	// The generator of the blocks
+	std::vector<unsigned char> block(4096 + 64);			// The block being checked
+	HealthMonitor monitor;								// The monitor of the end-to-end checks
+
+	// Random blocks of every length up to a few windows, with and without a planted run of 3 or 4 at every kind of position
+	for (size_t count = 0; count <= 1600; count++) {
+		rng.Fill((unsigned long long*)block.data(), block.size() / 8);
+		CheckBlock(block.data(), count, monitor.GetProportionCutoff());
+		for (size_t length = 3; length <= 4 && length <= count; length++) {
+			size_t p = rng() % (count - length + 1); // The start of the planted run
+			for (size_t k = 0; k < length; k++) { block[p + k] = 0xA5; }
+			CheckBlock(block.data(), count, monitor.GetProportionCutoff());
+		} // End for(length)
+	} // End for(count)
+
+	// Windows holding the cutoff of matches (or one fewer) planted up to their last sample, which can be the last of the block
+	for (unsigned int offset = 0; offset < 2; offset++) {
+		for (size_t count : { (size_t)512, (size_t)513, (size_t)1024, (size_t)4096 }) {
+			rng.Fill((unsigned long long*)block.data(), block.size() / 8);
+			size_t window = (count / RNGHealthWindow - 1) * RNGHealthWindow; // The last full window
+			for (size_t i = window + 1; i < window + RNGHealthWindow; i++) { block[i] ^= (unsigned char)(block[i] == block[window]); }
+			for (unsigned int m = 0; m + 1 + offset < monitor.GetProportionCutoff(); m++) { block[window + RNGHealthWindow - 1 - 3 * m] = block[window]; }
+			CheckBlock(block.data(), count, monitor.GetProportionCutoff());
+		} // End for(count)
+	} // End for(offset)
+
+	// End to end: random blocks pass, a stuck block fails, and the counters add up
+	for (int b = 0; b < 100; b++) {
+		rng.Fill((unsigned long long*)block.data(), 512);
+		CHECK(monitor.Test(block.data(), 4096) == RNG_HEALTH_OK);
+	} // End for(b)
+	std::fill(block.begin(), block.end(), (unsigned char)7);
+	CHECK(monitor.Test(block.data(), 4096) != RNG_HEALTH_OK);
+	CHECK(monitor.GetCounters().blocks == 101 && monitor.GetCounters().samples == 101 * 4096);
+	CHECK(monitor.GetCounters().repetition_failures == 1 && monitor.GetCounters().proportion_failures == 1);
+
+	std::printf("%s\n", (failures == 0) ? "HealthMonitorTest passed" : "HealthMonitorTest FAILED");
+	return failures != 0;
+}
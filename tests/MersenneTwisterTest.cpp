@@ -0,0 +1,66 @@
+// MersenneTwisterTest.cpp - This program checks MersenneTwisterClass against std::mt19937 and std::mt19937_64 for several seeds:
+//		single draws, fills across the boundaries of the state, draws after Discard, and draws through std::uniform_int_distribution,
+//		returning 0 if every check passes. It only needs the portable headers, e.g. g++ -std=c++17 -O2 tests/MersenneTwisterTest.cpp
+
+// Include the headers declaring the engines
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../MersenneTwisterClass.h"
+
+// Define a counter of the failed checks, and a macro reporting a failed check
+static int failures = 0;
+#define CHECK(condition) do { if (!(condition)) { std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while (0)
+
+// The 10000th number of a default-seeded engine is checked at compile time
+static_assert(MersenneTwisterClass<unsigned int>::Verify(), "MersenneTwisterClass<unsigned int> doesn't match std::mt19937");
+static_assert(MersenneTwisterClass<unsigned long long>::Verify(), "MersenneTwisterClass<unsigned long long> doesn't match std::mt19937_64");
+
+// Define a templated function to check an engine against its std counterpart for a seed
+template<typename result_type, typename std_engine> void CheckSeed(result_type seed) {
+	const size_t draws = 5000;						// The numbers compared per check
+	const size_t state_size = sizeof(result_type) == 8 ? 312 : 624; // The numbers per state, where Fill twists
+	std::vector<result_type> numbers(draws);		// The numbers filled
+	MersenneTwisterClass<result_type> engine(seed);	// The engine checked
+	std_engine reference(seed);						// The std engine
+	size_t mismatches = 0;							// The numbers differing from the std engine
+
+	// Single draws
+	for (size_t i = 0; i < draws; i++) { mismatches += engine() != reference(); }
+	CHECK(mismatches == 0);
+
+	// Fills of every length around the state size, starting at every kind of position in the state
+	for (size_t length : { (size_t)1, (size_t)7, state_size - 1, state_size, state_size + 1, 2 * state_size + 3, draws }) {
+		engine.Fill(numbers.data(), length);
+		mismatches = 0;
+		for (size_t i = 0; i < length; i++) { mismatches += numbers[i] != reference(); }
+		CHECK(mismatches == 0);
+	} // End for(length)
+
+	// Draws after skipping less than, exactly and more than a state
+	for (unsigned long long skip : { 0ULL, 5ULL, (unsigned long long)state_size, 3ULL * state_size + 11, 100000ULL }) {
+		engine.Discard(skip);
+		reference.discard(skip);
+		mismatches = 0;
+		for (size_t i = 0; i < 100; i++) { mismatches += engine() != reference(); }
+		CHECK(mismatches == 0);
+	} // End for(skip)
+
+	// Draws through a distribution, which only sees min(), max() and the numbers
+	std::uniform_int_distribution<int> distribution(-1000, 1000);	// A distribution over a range that isn't a power of 2
+	std::uniform_int_distribution<int> same(-1000, 1000);			// The same distribution, for the std engine
+	mismatches = 0;
+	for (size_t i = 0; i < draws; i++) { mismatches += distribution(engine) != same(reference); }
+	CHECK(mismatches == 0);
+}
+
+int main() {
+	for (unsigned long long seed : { 5489ULL, 0ULL, 1ULL, 42ULL, 20240601ULL, 0xFFFFFFFFULL, 0x123456789ABCDEFULL }) {
+		CheckSeed<unsigned int, std::mt19937>((unsigned int)seed);
+		CheckSeed<unsigned long long, std::mt19937_64>(seed);
+	} // End for(seed)
+	CHECK(MersenneTwisterClass<unsigned int>::Verify() && MersenneTwisterClass<unsigned long long>::Verify());
+
+	std::printf("%s\n", (failures == 0) ? "MersenneTwisterTest passed" : "MersenneTwisterTest FAILED");
+	return failures != 0;
+}
@@ -0,0 +1,49 @@
+// StochasticRoundingTest.cpp - This program checks the stochastic rounding kernels of RNGStochasticRounding.h on special and
+//		out-of-range inputs, returning 0 if every check passes. It only needs the portable headers, e.g.
+//		g++ -std=c++17 -fsanitize=undefined tests/StochasticRoundingTest.cpp
+
+// Include the headers declaring the kernels and the engine used to drive them
+#include <cstdio>
+#include <limits>
+#include "../RNGStochasticRounding.h"
+#include "../MersenneTwisterClass.h"
+
+// Define a counter of the failed checks, and a macro reporting a failed check
+static int failures = 0;
+#define CHECK(condition) do { if (!(condition)) { std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while (0)
+
+int main() {
+	MersenneTwisterClass<unsigned long long> rng(20240601);	// The generator driving the rounding
+	const float infinity = std::numeric_limits<float>::infinity();	// Positive infinity
+	const float nan = std::numeric_limits<float>::quiet_NaN();		// A quiet NaN
+	float numbers[] = { 300.0f, -300.0f, 65504.0f, 1.0e6f, -1.0e30f, 3.0e38f, infinity, -infinity, nan, 0.0f, -0.0f, 1.0e-7f }; // The inputs
+	const size_t count = sizeof(numbers) / sizeof(numbers[0]);		// The number of inputs
+	unsigned short half[sizeof(numbers) / sizeof(numbers[0])];		// The half precision results
+	unsigned short brain[sizeof(numbers) / sizeof(numbers[0])];		// The bfloat16 results
+	signed char bytes[sizeof(numbers) / sizeof(numbers[0])];		// The 8-bit results
+
+	// Round the inputs many times, so every random lane meets every input
+	for (int repeat = 0; repeat < 1000; repeat++) {
+		StochasticRoundToFloat16(rng, numbers, half, count);
+		StochasticRoundToBFloat16(rng, numbers, brain, count);
+		StochasticRoundToInt8(rng, numbers, bytes, count);
+
+		// 300 and 65504 are representable, so they never move, and anything beyond 65504 carries to infinity
+		CHECK(half[0] == 0x5CB0u);
+		CHECK(half[1] == 0xDCB0u);
+		CHECK(half[2] == 0x7BFFu);
+		CHECK(half[3] == 0x7C00u && half[4] == 0xFC00u && half[5] == 0x7C00u);
+		CHECK(half[6] == 0x7C00u && half[7] == 0xFC00u);
+		CHECK((half[8] & 0x7C00u) == 0x7C00u && (half[8] & 0x3FFu) != 0);
+		CHECK(half[9] == 0x0000u && half[10] == 0x8000u);
+		CHECK(half[11] == 0x0001u || half[11] == 0x0002u);
+
+		CHECK(brain[6] == 0x7F80u && brain[7] == 0xFF80u);
+		CHECK((brain[8] & 0x7F80u) == 0x7F80u && (brain[8] & 0x7Fu) != 0);
+
+		CHECK(bytes[0] == 127 && bytes[1] == -128 && bytes[6] == 127 && bytes[7] == -128 && bytes[8] == 0);
+	} // End for(repeat)
+
+	std::printf("%s\n", (failures == 0) ? "StochasticRoundingTest passed" : "StochasticRoundingTest FAILED");
+	return failures != 0;
+}